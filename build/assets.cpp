@@ -0,0 +1,263 @@
+// Generated by http-bundle, do not edit
+
+#include <iterator>
+
+#include "bundle.hpp"
+
+namespace {
+
+constexpr http::bundled_asset bundledAssets[] = {
+	{"/favicon.ico",
+	static_cast<http::content_type>(20), // image/png
+	{"\042005b3ac1247a1e61\042", 18}, {
+	"\211PNG\015\012\032\012\000\000\000\015IHDR\000\000\000\310\000\000\000\310\010\006\000\000\000\255X"
+	"\256\236\000\000\000\001sRGB\000\256\316\034\351\000\000\021\353IDATx^\355\235gT\325W\026\305y#\326\000"
+	"\022cEcMp\354\032K\000{\215\242\250!\032b\013\002&\204\330\025,3*V\214\212#(\026\304\022\273F\261D\243"
+	"F1\366\212\304\202\032\261$\006\333\330%\212\275\314z\357\363>k\355Y\371\272\375\274\327\375\303\217"
+	"\267=\347\354\373\376\367:v\271\025(\347F\374\253]\245\322 B\346\266\346\352\221K\214\256\363\222\246"
+	"y\031\235\317\254\214y\214\356\310\260\365E\031]\367B\221\273\031]\337+/\3672\272\353\215c\3633\272z"
+	"G\373\014ft\336\313\30362\272]C'\364`t\3377n_\202\321EN\215\212`t\205~-\035\307\350f6Y\363\214\321\245"
+	"%\337]\304\350\276\231~k:\243\013w\357\230\304\350rs\302F2:\207\014\2021\311 \230\213\014b\330J\025\004"
+	"\203Q\005\301\134TA\014#\251\305\302`\324ba.j\261\014#i\006\301`4\203`.\232A\014#iH\307`4\244c.\032\322"
+	"\015#)\305\302`\224ba.J\261\014#)\346\305`\024\363b.\212y\015#)\346U\314\353$ \203\310 .\002\252 F\005"
+	")\1348\3528\263\2438\346\363e/\031\335\333\224\350 F7\264n\042\265^h\315\012\324zK\357f\254g\236\333"
+	"\042:\3640\243;U\264\357AF\347\031\340^\231\321\271\373\375\321\224\321\225z\262&\200\321\215\0179<\205"
+	"\321\015\235\034;\201\321M\213zI\355\340\257\374\354\037\324\016\376\220I\323\251o6\004\224*\037\313"
+	"\374|\3336\276\3673\243K[\266z>\243\253\177!k\011\243s\310 \030\223\014\202\271\310 \206\255TA0\030U"
+	"\020\314E\025\3040\222Z,\014F-\026\346\242\026\3130\222f\020\014F3\010\346\242\031\3040\222\206t\014"
+	"FC:\346\242!\3350\222R,\014F)\026\346\242\024\3130\222b^\014F1/\346\242\230\3270\222b^\305\274N\0022"
+	"\210\014\342\042\240\012bT\220f\351W\251w\221\203#jQ;\231A\211\003\3562;\224\367\042\367x0\2721\027\277"
+	"8\303\350\2364=R\236\321\255\3741\363\042\243\0330\240F/F\267\316\077\363\030\243\033^\356\321UF\027"
+	"\034^-\017\243\253\036\374yUF\267\340\343Q\333\030\335\300\313\253B\031\335\370\260W5\031\235W\334\324"
+	"0F70yC+F\267rX\273N\214.f\323\366\327\214\316\077\305\215zg\336!\203`\2342\010\346\042\203\030\366S\005"
+	"\301`TA0\027U\020\303Hj\2610\030\265X\230\213Z,\303H\232A0\030\315 \230\213f\020\303H\032\3221\030\015"
+	"\351\230\213\206t\303HJ\2610\030\245X\230\213R,\303H\212y\215Y@1/\004\243\230\3270\222b^\305\274N\002"
+	"2\210\014\342\042\240\215B\374Ap\304\247>\245Nw\317\327\267\371yf\207\262\315\206\271\324\316h`\340k"
+	"j\207<|w\316\357\314s\363\244oH`t-\263\333P\357\256\027\275\377\341\014f\275\254\314\310G\214n\200g\237"
+	"\002\214\356~\207\226\324\351\370e\0023\251w\257{\077\276\267\217ynR\211\363'\031\335\250\235[\0362\272"
+	"\361\233K\015at\017C|\3130\272\230yYk\031]M\337\030j\007\077\273\377\222I\314z2\210AI\006\301`d\020\343"
+	"\003\243\012\202\301\250\202\030\263\212*\010\006\243\026\013sQ\213\205\271\250\3052*\222f\020\014F3"
+	"\010\346\242\031\3040\222\206t\014FC:\346\242!\3350\222R,\014F)\026\346\242\024\3130\222b^\014F1/\346"
+	"\242\230W1\257\213\200\014\042\203\270\010\250\202\250\2028\011\320-Vr\271\257\2072;\212\356'w\365gt"
+	"YU\356\316ft7\032V\274\306\350\302~/\036\305\3502\367\037\353\307\350\336\361\366\245\356\015o\223\340"
+	"_\201Yo{\337\236\213\031]J\336:S\031\335\206orn1\272\264g\005\251\323\347\237Tzt\223Y\357}\317o\251o"
+	"\016T\217\362\256\317\254\347\226Z\276#\243\273\2702\2476\243\353t=\226\272\015 \350A\003_f=\357m\217"
+	"\2273:\207\014\2021\311 \230\213\014b\330J\025\004\203Q\0051>0\252 \030\214Z,\314E-\026\346\242\026\313"
+	"\370\017F3\010\006\243\031\004s\321\014b\030IC:\006\243!\035s\321\220n\030I)\026\006\243\024\013sQ\212"
+	"e\030I1/\006\243\230\027sQ\314k\030I1\257b^'\001\031D\006q\021P\0051*H\257\332\227\003\231\035\305\341"
+	"y\237\3731\272\231\001\376\324;\332O\012\217\247\336\321^U\255\027\2653\032\234\273\212Zo\333\200\301"
+	"c\231\337\343\352\020\037j\247\265\317\221\3605\314z\251q\255\277dt\363\003\363\015ftO\026n\244\276\021"
+	"P>8\207:->\264M\373\321\314s+\206\344\241\276)\341\361e\302\077\230\365<=o\364dt\015\017\217\243\336"
+	"\301\017X\347A\375=z\364v\247\276\211\340\220A\360\237G\006\301\134d\020\303\316\252 \030\214*\010\346"
+	"\242\012b\030I-\026\006\243\026\013sQ\213e\030I3\010\006\243\031\004s\321\014b\030IC:\006\243!\035s\321"
+	"\220n\030I)\026\006\243\024\013sQ\212e\030I1/\006\243\230W\373 .\0022\210\014\342$\240\012\242\012\342"
+	"\042\240\026\353o\266Xu\335\336\346ev2\327\275>\275\204\321\235\011\271\340\311\350\012\234\3770\227"
+	"\321=h\360\240\001\243;\352\337u'\243\313\270\343C\235f\357x>\234:\025\375\335\251\307\250\235\357\343"
+	"\207s\251{\271\263;\015\235\313\374\036\213{\374F\335k>\374\306I\352]\375\362\011M\276f\236\333\373\317"
+	"W-\030]N\271\023m\030]\2757\313\2513\021\216\025L\246\276\311\321\274_}\352\236\364\350\343\361\227\231"
+	"\237\317!\203\030\275\247\014\002\301\310 \206\255TA0\030U\020\314E\025\3040\222Z,\014F-\026\346\242"
+	"\026\3130\222f\020\014F3\010\346\242\031\3040\222\206t\014FC:\346\242!\3350\222R,\014F)\026\346\242\024"
+	"\3130\222b^\014F1\257\221f*\346U\314\353$ \203\310 .\002\252 \252 N\002t\2135\372\223%\347\230\035\305"
+	"\244\021\365\342\030\335\220\266G\251\323\272\207\034\360\037\300\254\027\356_l:\243\013\236\233B\355"
+	"\270\177\265s\305&f\275/\326\234\241v\264\367.*J\275\013\177\263d\231{\314sg\004l\242v\334[\267(\024"
+	"\311\254\327\345\361Nj\247zG\347f\324;\337\267\177\012\240N\333\177\373\350\032\365\316|\276I\033\251"
+	"{\315W\254\351Q\227\371}SO\337\370\236\321\035\314r\224et\016\031\004c\222A0\027\031\304\260\225*\010"
+	"\006\243\012\202\271\250\202\030FR\213\205\301\250\305\302\134\324bYF\322\014\002\311h\006\301\037\030"
+	"\315 \206\2214\244c0\032\3221\027\015\351\206\221\224ba0J\2610\027\245X\206\221\024\363b0\212y1\027\305"
+	"\274\206\221\024\363*\346u\022\220Ad\020\027\001U\020\243\202\274\370\356\203E\314\216b\222_R5F\367\366"
+	"r9oFW\244\342\224Z\214n\363\2303\334\016\352\222\302\227\230\365\316\373xQ\357\232\257\252\342\361'\263"
+	"^\235y}\262\031]\203e\376\324i\342\236k\272Q\357|{\177\234\233\316<\367e\3541\352\276\367\351\363\333"
+	"Q\367\263\007\3348\267\224yn\376\323\275\2573\272\332+~\245\270\224\275\271/\203Y\357\226\2377\365\371"
+	"\013\373\341\320\030f=\207\014\2021\311 \230\213\014b\330J\025\004\203Q\005\301\134TA\014#\251\305\302"
+	"`\324ba.j\261\014#i\006\301`4\203`.\232A\014#iH\307`4\244c.\032\322\015#\245*\305\202d\224b\341\017\214"
+	"R,\303H\212y1\030\305\274\332\007q\021\220Ad\020'\001U\020U\020\027\001\265X\177\263\305*}\347\217,f"
+	"Gq\333\211\270\373\214.\245\340\324U\214\356\307\210\007\036\214n\244_\311N\214n\357\340C\243\030\335"
+	"\253\332\311\2770\272\322[\256^at\011\177\215\352\314\350^y<\245\336\301\277_\263\036u\237z\343%{\366"
+	"3\317}\030\373\021u\012|\211\005\263\203\230\365V\256\2369\231\321e-tPg\011\224\351p\372\015\263\236"
+	"Wf\374iFWnB\223n\214.\346E\276B\214\316!\203`L2\010\346\042\203\030\266R\005\301`TA0\027U\020\303Hj\261"
+	"0\030\265X\230\213Z,\303H\232A0\030\315 \230\213f\020\303H\032\3221\030\015\351\230\213\206t\303HJ\261"
+	"0\030\245X\230\213R,\303H\212y1\030\305\274\230\213b^\303H\212y\025\363:\011\310 2\210\213\200*\210Q"
+	"A\332\375\347\374UfG\261\352\355>\324\216q\322\355\236!\314z\261\321\335\3533\272\007\213\353R\367\220"
+	"\277\031Rl\027\263\336\202T\337\077\030]\332\274\317\250\373\324\253\214\254\363\222Y\257W`{\352\276"
+	"\362u\337\017\243N\307OM\352@\275\033>\346\253\201U\230\237\257^\340\260\025\214\316\335kT\002\243\213"
+	"s\077\232\207\321\015\311\0301\233\321E]\350\363OF\3274\246 \365M\211Ji[\376b\326s\310 \030\223\014\202"
+	"\271\310 \206\255TA0\030U\020\314E\025\3040\222Z,\014F-\026\346\242\026\3130\222f\020\014F3\010\346\242"
+	"\031\3040\222\206t\014FC:\346\242!\3350\222R,\014F)\026\346\242\024\3130\222b^\014F1/\346\242\230\327"
+	"0\222b^\305\274N\0022\210\014\342\042\240\012bT\220\037\272\276\245v<\027%\026Lcv\036#O\025_\310\350"
+	"\012\024l\034\310\350\216\3776z\001\243\013\231S\241!\243k\2756{\004\243{46>\077\243\353\262\347\316"
+	"YF\347\033W\243\010\243\313h\027\335\226\321\365>\223\217:\245\336\353\307\310y\314z\275f$\234`t/\337"
+	"}R\207\3215\255^\264\025\243;\344W\077\234\321}\372e u\077\373\247\027KR\357\256'\225\360\271\313<\327"
+	"!\203`L2\010\346\042\203\030\266R\005\301`TA0\027U\020\303Hj\2610\030\265X\230\213Z,\303H\232A0\030\315"
+	" \230\213f\020\303H\032\3221\030\015\351\206\2214\244c0J\2610\027\245X\230\213R,\243\042)\346\305`\024"
+	"\363b.\212y\015#)\346U\314\353$ \203\310 .\002\252 F\005\031\236\234\134\230\331Q\354\0333\230\272\317"
+	"\372\331\202\316=\231\365Z\264\011i\315\350\042O6/\306\350\212\007\025\245N\201\077\364~\255\355\314"
+	"z#\317\226\242N\213\377\327\235Gk\231\365\0066\313K\355T/z\346N\235\002_\372\325\006\346\261ne\216\275"
+	"n\311\010\2032\256Q\317\355\026\357\367\214Y\357\356\251DOFW\376\341N_FW\246P\035j\347\373\134\344\262"
+	"#\314z\277\354\217\370\204\3219d\020\214I\006\301\134d\020\303V\252 \030\214*\010\346\242\012b\030I-"
+	"\026\006\243\026\013sQ\213e\030I3\010\006\243\031\004s\321\014b\030IC:\006\243!\035s\321\220n\030I)\226"
+	"\361\077\257R,\010F)\226a$\305\274\030\214b^\314E1\257a$\305\274\212y\235\004d\020\031\304E@\025\304"
+	"\250 {\372\373Q\367c\277\334~\357\022\263\363Xi\304\276LF\327e\344\012\352]\356[\365\346te\326\033\351"
+	"s\243\031\243\273\330ci\027F\327\261\341\316\232\214.\265\212\367\317\214\256\325\235\302\245\030]N\332"
+	"3\352\214\200\312a\351\024\227\263\307\273P\337\224xwD\326F\346\347+9y\313VF\2278n\026\365\334\012A\265"
+	"'2\353\015\235Z\3545\243K+\233K\335\343\236\032\361-uv\202C\006\301\330e\020\314E\0061l\252\012\202\301"
+	"\250\202`.\252 \206\221\324ba0j\2610\027\265X\206\2214\203`0\232A0\027\315 \206\2214\244c0\032\3221\027"
+	"\015\351V,\253\024\013\222Q\212e\314\216J\2610\030\305\274\230\213b^\355\203\270\010\310 2\210\223\200"
+	"\366A\214VL\006\221A\376/\203\034o\273\3430\263C\3511+\232\272\227\273x\350pf9\267\224\016\215\3560\302"
+	"\353=wQ\367\220w\337}\211\272\377\374q\327\032\0771\317\015\3750\301\237\321\235\014\031>\227\321\305"
+	"W\236D\275\253\337\340\320\353\352\314z/*\314\242N\251o\033Q\362\026\263^\345\226\267\250{\310\253\372"
+	"4\244Nm\217\273vb\020\363\334\211-\352\227at\021\007\323\251\337\343\233\255\011a\314z>YU63:\207\014"
+	"\2021\311 \230\213\014b\330J\025\004\203Q\005\301\134TA\014#\251\305\302`\324ba.j\261\014#i\006\301`"
+	"4\203`.\232A\014#iH\307`4\244c.\032\322\015#)\305\302`\224ba.J\261\014#)\346\305`\024\363b.\212y\015"
+	"#)\346U\314\353$ \203\310 .\002\252 F\005I\357q\353\000\263\243X\377E\277\246\214nT\223&e\031\335\314"
+	"\335+\3171\272\350\267\301\324\326|\346\303\017\250S\307\347\274\370j\025\363\334-\271\223\250{\310k"
+	"e\372\335`\326;\324\217\273O}v\267:\353\231\365\212T*\220\315\350bVw\331\313\350\246%\016\274\306\350"
+	"z\235\0773\233\321m.\336\340\021\243\313\177\177\013\365.\274\373\206mq\314z\011\035\016P\267\006\004"
+	"\365\215\241N\275w\310 \030\273\014\202\271\310 \206MUA0\030U\020\314E\025\3040\222Z,\014F-\026\346\242"
+	"\026\3130\222f\020\014F3\010\346\242\031\3040\222\206t\014FC:\346\242!\3350\222R,\014F)\026\346\242\024"
+	"\3130\222b^\014F1/\346\242\230\3270\222b^\305\274N\0022\210\014\342\042\240\012bT\220\006nA\025\230\035"
+	"J\257KK\250w\240\317-\0778\230Y\257\365\205\354n\214\256\302;\007\3072\272\263\265s\251\035\336\337\277"
+	"\035=\235Y\257\322\326\234\1773\272\217\0264\242\356\077\077\220\371\374\015\263\336\363\340\3172\030"
+	"\335\025\207o\014\243\013oT\222\332\351_\330gS]f\275\234\211SN2\272\225\277L\244N\307_\354}\223\372{"
+	"\214\317\355\260\210y\356\236\307\376\035\031]\316\300_\251w\346\0352\010\306)\203`.2\210a\077U\020\014"
+	"F\025\004sQ\0051\214\244\026\013\203Q\213\205\271\250\3052\214\244\031\004\203\321\014\202\271h\0061"
+	"\214\244!\035\203\321\220\216\271hH7\214\244\024\013\203Q\212e\204\015J\2610\030\305\274\230\213b^\314"
+	"E1\257Q\221\024\363*\346u\022\220Ad\020\027\001U\020\243\202ln\273\343\042\263\363\370^\342\350b\214"
+	"nm\360\272\212\214nW\230\243\005\243\3532s\354\327\214nt|N;F\267a[T\012\243\233\362\335\177G2\272\364"
+	"\327\253&1\272\375\017\247L`ts\275\242z0\272\002\241\277Q\367|\237wkN\335W\236\355\373\306\223y\356\214"
+	"\303s#\030\335\240\247I\324\375\347G\232V\355\317\254\32709w\034\243{\023\277\225:\275\077\262^\031\352"
+	"\276w\207\014\202\261\313 \230\213\014b\330T\025\004\203Q\005\301\134TA\014#\251\305\302`\324ba.j\261"
+	"\014#i\006\301`4\203`.\232A\014#iH\307`4\244c.\032\322\015#)\305\302`\224ba.J\261\014#)\346\305`\024"
+	"\363b.\212y\015#)\346U\314\353$ \203\310 .\002\252 F\005\211~p\233\272Wz\312\301\234\002\314NfT\354\264"
+	"\225\214\256\335\314\232k\031\335\220V\013}\031\335\262\247Wk0\272\201n\223\250S\340\017MKLf\326\253"
+	"\260\274\305\317\214\316\177G\313\042\214\256\304\270\325~\214nv\370\352>\214\356\312\244\374C\031\335"
+	"l\217\267\324\251\350\0375\011\355\316\254\367h\354\326DF\027y\275C/Fw\361Hh\010\243\213\030\326m\016"
+	"\243K\2772\206\372\346\205C\006\3018e\020\314E\006\261Z\016U\020HF\025\004\177`TA\014#\251\305\302`\324"
+	"ba.j\261\014#i\006\301`4\203`.\232A\014#iH\307`4\244c.\032\322\015#)\305\302`\224ba.J\261\014#)\3465"
+	"*\222b^\010F1\257a$\305\274\212y\235\004d\020\031\304E@\033\205\370\203\340h8\265\321df\347\361\344\322"
+	";\324\375\342\335\042\275\2462\353\265\351\237\336\236\321\335\236\331\363\012\243\363\013\030D\275\013"
+	"\277\376\360~\352\224\372\336\031\331}\231\347\276\215\036K\275k\276\257\346\003\352\364\364\331o\312"
+	"\315d\236\333y\363\270\013\214.\355\257\027\361\214nV\261j\363\031\335\265=O\2663\272\301\033NQ\247\343"
+	"\017\337z\363\011\263^\203b\323\251o\004$LNY\312\254\027\326\253\330\036F'\203\030\224d\020\014F\006"
+	"1>0\252 \030\214*\010\346\242\012b\030I-\026\006\243\026\013sQ\213e\030I3\210\021\267j\006\201`4\203"
+	"\030F\322\220\216\301hH\307\1344\244\033FR\212\205\301(\305\302\134\224b\031FR\314\213\301(\346\305\134"
+	"\024\363*\346u\021\220Ad\020\027\001U\020U\020'\001\266\305\372\037lDN*\3658\006\331\000\000\000\000"
+	"IEND\256B`\202", 4657}, {
+	"ETag: \042005b3ac1247a1e61\042\015\012Vary: Accept-Encoding\015\012Content-Type: image/png\015\012Co"
+	"ntent-Length: 4657\015\012\015\012", 98},
+	{"\042005b3ac1247a1e61-gzip\042", 23}, {
+	"\037\213\010\000\000\000\000\000\002\003\275W\1774T\373\372\2264\371\031\316\215\231!%*\24503J\042\034"
+	"a#5\042L*C\023\223\250Q\231hF(s\042l\021\312(F\331\204\2104I\206\341L\231(\2239S\016\225\006\245;\306"
+	"\370\225&\221_\335\355t\356\272\353\334\373]\337\365\275\367~\357\335k\355\275\337\365\256\367\217\375"
+	"\354\367y\237\347\375$\357\301\273j\250\352\251*((h\270\2739{\303\357\326\205[\031\001\077\357\354\253"
+	"d\301\257E\221\336\256;\024*\333W\014*(h\017\271;;\372\234!\216\344\037\361\371\225\240\313\247\031w"
+	"*\374p\330\345\360\356\023\303z\036\0121i\205\245\253\365Hj\212\353~z\245\263\311\322\324\017L1^\257"
+	"\333\374C=P\355\014\001\330/)\315\011z\325k\020\335\257\326\246p\005\3641\271}\370\210\377W\316\134C"
+	"\327\334\343\364Z\273\201\341\231\371I\233\250:\235\365\003\300ly@\361\013\303\035\222\007\022\331e\017"
+	"\260R\236y\213\206\316\027V\2004p\264\365\356\204\013:`r\307\345zt@\357F\213I\034g(\355\260\334\222C"
+	"w\235Q'S{\332\036[\3418\001N&\237\203\250\275[)\201\011\042\027|ZJ\020\365B\234\231A\213\224l\345/\007"
+	"E\305k{\003\232\245\215\271q\3416\220Z\364\030\263Yz*\362\021\200\263IRO\300>5d\246\252\223^\355\324"
+	"Qbx-\341\035\364qT7.\343\077\012\352 \0352\017\253V7>\212\340\005mf\004\231_\203\363G\335Z\2026\027\035"
+	"6\327{\241a\274\001\256\311\206kv\3025\033$\374\240\345r\222y\012\015\316K|\005Ck\014\031\255\206\346"
+	"\212\267\015\201%\033\016Z\313\254\331\220\265D\036b\201\026wgK\015\201\255\367)F5\304\320\347\252\035"
+	"t\2171r\305\021V\267\221\315g\014d\353{\177\314\021\030@\367\021sEu3s\242l\321\025\372\275u\347Di\232"
+	"\333\266_\020i\344\257\260=/\332\235Jw\037\351\253\232\035^\325\261l>\303\375eY\204\225R\266\351\252"
+	"\266\331\263\335V\215\223\226\220\307\201\007t{\250<~u\270\012\024\331j\210\312RO\250k5L\274\343\343"
+	"\210A\371j\011\134t\2321\231\3737\251\003f\272\222B\3356L&YK\035\260T\226\024\242\341|\042U\035p\262"
+	"\221\024\256\026c2\275\341\232\015p\315r\270\206DT\007\260\026\222Bf\327B\314o\300+\342.\252\2777\272"
+	"\241J\362\311 \017\022\312\242/3\214\303\274ls\035\223\027\217\342l\263'\215&\317`8Xd\223\365c)k\263"
+	"\2357Ktg\026+7\202\36417\000\013\240\266\335A\216\202\364\211\243\042_\000\271\202h\246\011\225\257\234"
+	"\245\371\002\265}\375^\335(\361\317m\345;\320\342\251\273\204-\350|\302\333\016\014\260\025Cs\332\010"
+	"\324\236\332W\217\007\315\311/\277t\201\355\016\3744\372\221\236\325\214\240<\234\262\304\210\201\372"
+	"\262w\011/\010\006\210\364\325z\354\026V\215A\325\354c\246\356\337\364\330\355\032\014\3729\334]2\234"
+	"\327{\201Ei\0142S\023\251\217\335v\3025\305p\2157\134\223BK\363\377\021k\241\004\375=\272\264\035\263"
+	"\216'\232K\354\213\361\321\302\256\332\2574r\322\275\347\211u\035\355\241A}\341aI\333\317F\267\217\011"
+	"\042\345E\021nAT3v\367\236\261J$\367\333;u2\267B\320\352\012R\316\035)P\004G\343\222\256v\014N\205(Z"
+	"\226EW\30584\326\246\323(\336\311r\023\264\2704\377\300J\034g\374\272\207\306!\252\246\323\3316\014\207"
+	"I\363\017G\007\354\356E\205-u\250\377\226\351.\240\343.:\272\303\334\013\326\352_\014\251&\360J\023P"
+	"\354\024Se\004\244\253\026\351\225z\241\256\224\2173\375\347\332G\300V\245\236S7b<T.M(M\260V\371\305"
+	"\314\357T]U\022\3166e\324$z\342\010\325\337w\264\235L\335\252\347\327\360D\372(\316b%_\212\233\1345\324"
+	"\042\355\031\377R<\252\021\221\325\027x\336\077\042\246\227\225\212\016\330\331c\263\027-N\2148E\301"
+	"r\356\037YR\366r\240\300\207N\315\362\037\213\025F\224E,\363I\377T)\254\030\270\272\277\321\030\252\177"
+	"\210+\261\202\206\250vW9\032\206R\307\305\201d\273\261\343\3519\226\3778{X{\314mC\024\270\177\223\300"
+	"\345;=\2474ap\010\010\255\024)R'\241\334\235l\020\320j\203HQ\006\005\345\276A\027\001-\207\177DJ\010"
+	"\312\035k\201\200\230\310H/A8\034W\221\210&\213\320\316\210\223\332{\226`M\335\252\336\344,\3165\340"
+	"\277\243\025\314`9\271\213\346;l\337x\252\246\227\364\210\210\276w\2205\226zy\365)\373#\272\317\361\016"
+	"\347\366\366\313\264V\205\225\324\010/\177\334\042\240\227\235\274\323\024L\225/\226k\220\251\236\272"
+	"\224\242F\355=\366\326I6f\366\367w\317\210\004\221\033\023\077\334l\334\360n<\344\221\003sb\273]\304"
+	"\347`\252\206f:\324\303\323\3347\3408gG\377\034U\322\230\334\227\341\370\261\300\025\301;\030\254\365"
+	"\270}\001\231)\334)U\030\210\231\356\357]\204\077\376\377\014\2200\003\013\312\0025\327\334P-T\205\011"
+	"\252;\024\361`\337iq\217$$\012\327\305\265\347\376$\312W\251\353{*U\315\373\206\311\021\331\205~\274"
+	"\261\010\262\225\365\2366\201\332\036\366;\345\223\307\316\330\347\331\350\314\211\313ZJ\363\307\372"
+	"\223\042\313b\352\330\266\032\371m\263+Scf\001q\270\375\354\023wY\300\334'\225\335\215dV\367\214\220"
+	"`\206\012\300\327\375\3518*\200\273\265\255\314R\373\222\316\256[\215OE\015\201\2612\326gi\377xNn\201"
+	"p5\003\305-QW\344\375\277HL\325e\262\351\037\304\363\266!^\221\232\272e:k\355\000\323\200_\244=\361\036"
+	"%\316x\340Z\366\222\223\264\342\343\252\237+\220\243\201\307`=g]\3371\3620\276&\222\277\216\314\265\350"
+	"\314\273\031u\177\322\334t'W-\236\035\234\033#\210<\242t\2540\352\355\201\332\365\313\237Vt\375y\034"
+	"\037VBw\035 w\330\366\326\306\253\336\300w\307\317H\365&\332\3176\272\353\227\305<'T\014z\345|\215\335"
+	"\353\331;\305\022\031\010Ne\207P\227\241\225\016g\302\342\202n\276{ea\374T\023\352\340Q\004\274S/\360"
+	"J\371\217\016v\220\374\201\027\352\212OC\021\274U\260\330$^\206\375\001\003\213\015Rc0\3612\354\017\030"
+	"Xl\220\305\373\022/\303\376\200I\241a\221\374\206\205\330Tr\372\207\014\307`-\344\042_-(\241aj\224\341"
+	"\042\270D\312\014\364\336\002L~9\265-\002 \024\275\317\336\017R\344L\313\267\313d\231\217r\230\023\355"
+	"3g\274\306\256U\335~\077n\302&\346\323b\357\241\003\030!\363\035G\337\263\3029^cgc\342\363\256\267o\237"
+	"\014\031\306\312\032'\007\345\335^\223\354\245o\255k\263i\224\371\227\334*K\316\233\215q\305\017\263"
+	"\271u\026\014\377\261\253\005['\276\252\315\274\373\005E\266\3737,\260\330\224\237\020\234Mz\247\011"
+	"~WR,\212\337\360f\351I\355\005`&00_\030^\315\276x6\3374v }\023\331\365dw\362\303\031\320\274\270\257"
+	"\303\027\034m\271\270t%H)\012|\212\007)c}N\020J\134\376\346i\023\206\363\342@%\361\020U%>M&\220\022i"
+	"\333\213{xM\201\354\225\247\013\350\375kc\276X\012cQ3\332\247U\317&/a3\230\023~\225\254m\271\242\020"
+	"3\352\236#*\331\203'\2465\330,\002y\366(@\240\354\310\242\200\346\022\227\306\035`;l\024\273\276\033"
+	"\305\003\357\177\313(\026\3401SI\304\205XGn\243\322j\210\273\230z\316\364\242\227\343\233\271\201Y_\262"
+	"k\265l\304\276\343\322\311\027#\254\325\002z\265H<d\311Y\232:\344=\231\321\204\366>\206d\367$\370\364"
+	":\240\002\3364\010Kg:\312\301\012y\246\177\025!(F\326\370\351t\257&\204o\361\334-\373\221\253o/)\077"
+	"\357\313,\250\042\366\335\325\001\333\305\341>\212Pj\244\303\265$\221\306S\024\366\272\310%@*\367\004"
+	"\2726\3372\234\330\235\274\363\350\201yR\347\177\303\347Wq\032\213\243\266#\327\352\356:\034\265\322"
+	"\330S'\260U\252\272\374\330\212V\351\245oV\364E\220Z\356\336\233\253\241p\256U\214\022\024\263\331\312"
+	"\336\001\032\2727\320\356\017\014\350\023 e\250-\024)\276*\232\260\317J\267)\356\031ji\245\011\350\134"
+	"\362\232\274 \252Eo\254w\222h\313\035\342}\035\310\366\003\301!O\024;\035bx\332a\246\004\351\341=Vir"
+	"\345c]\333\366\256\177\251\201\337\007\361\373\360-4\0202\372\337\22644+\357 \363\265\327\260\276%\223"
+	"#\234~\235\320n\227;\261\377\276\312\321\347R#O+\213'\322\224\245:\305\370\363\016\237\343\356\214\010"
+	"\350\306\302\253\205\370\324o]\371\256\341\271\023\010\2536\217\021\037\013\272\004\237\257\0308\375"
+	"+BRM\011\271\304\245<Uf\340*\275\204#\272c\223\240\377\330h\231\263'@\230\177\207\017\004\010\267\366"
+	"\030\204\015\314\034\374p\317X@o\032N\237\372I\264-X\013t\377n\023~\377\264M\134\035w\250\362\336\244"
+	"\014l\270zh\015\277\001\005\222\210\002\027l\325B\234B\313W\012\326B7\273\374\250\323\134j\0303=\343"
+	"5y\270\351m\334\330\017l\371\276\243\315\215\273\200\256\220\017\252\262\200\321\003\023\022jH\247\376"
+	"`$\204\206\352_\035>\212\004\272\252\337\265_\003\315kR&\205`\345\257\371\217\212a#xc)\003\317=;4\270"
+	"<\207\335R\277\2477\373L\264s' \031\330\270\215\326\346\007\344XSt'\336\252:\326\230\340\2064\362\367"
+	"\017o\201<6^\367\020\367\263\364\306\315NG%8!x\257B`R\042\260\307n\377\266\311\004\231\337\206\225\022"
+	"\226\027\014\334Dd\015\254\216\260\274`\340&\042\377\250\240~\233\312\227\253e\302\036(\270\2640\212"
+	"\337\307o\004^`\026F/\353\334\027G\320o\027\342\262\343\274\005cED}\077\206\3554\210\335x\215\223S\177"
+	"Fz\202\274\2556{Y\332(\346\321\220]\264\327dFtol2\347\333\354\311.=\007\254Pc\016\303+\020\345\253\243"
+	"\355sD|\002\313\231[\336\333\367\313\220L@\2670\025\024\342\313\042\364\275>\351\262\211\177\276Z[\032"
+	"\323Z>\275\271\010\177<\275>\212\244%\177\233l&\3139D\325^\372\262\254\267\377\372\035\225C\002\272\275"
+	"\277\257\225\345\177\343\030\341>vrH\201\015\355\373\346\322t\013\244\370d\255\013A\213\005\342\215B"
+	",GZ\313\353\350<+y\254Y\272\267e\240a*LG\376\326\254.\013\376\364\360\220iqP\247mGz\275glT\255\315P\356"
+	"D\212\217i\306s)\311/\372u\233\364\326\332e\360\236G\317w\260\274.:n\336\323\247\015\265\305\307\253"
+	"M\2307\314$\036\077)\240\253\030,\333S\213P\232H\273\211\347F\303\002S\377]`v\373\376\207\004\006Aq\324"
+	"a\032\354\254\362\360(\215\276!4s\260f\372WM\134\030\246\200\225\217l\227\266\3408\354\232\3102\203\236"
+	"\336&\003\273|\377\252\027\235y\361\226\234t\335\315\205\243\016\016\031_g5\330=\362>!\016%\326I\212"
+	"P\207\324\042|2\337\014\006\276:\2627\200\314\315K\336\213\307q\2564\355*\302\267\004\016\307fM\307\200"
+	"\302\221\273\027i\243\254\226y\003t@\373\317\201e\321\022\003\234\362\223\015psp\027\0179\370\302@t\224"
+	"\042\341u\024,\322Uc\374\276j\203Eh%\206\010\376\007\241\0108\277\332\200!\312\270T\027\352\266\025,"
+	"Z\016\327\244\204\374\244\3617\202.\014\240\327\077x\3741J}\277\021[>E|/%\201\224\343\0379) \205\300"
+	"\204\226@C\270\310\341.\220B=\213\267\005j\017\035\360Q\205\256\177\022\307\273\3428\237\273\312\327"
+	"a9s\232%\273\202\250\221\334B:\206\243x\263\311k\362lAt8^L`\215\314<\311\242\215\202\217#\215Q\342\033"
+	"%\356\035s\003\256\327\374F\204\025]\230m\321+\240\230\0775]\261\341:\334#\242e\215\3210\077\253\333"
+	"\276\363\323\347\077\304\317\344\270\023\3279\004\3723^\236\242\000O\366\031\276\177\005\254\024\013"
+	"\256\205\243\305\031~j\261h\361\275\022B8\206s\236\222U\272\267Os\267\307.rg\371\335\006\276\020l\217"
+	"wm3\002+\233\037\376\032\007R\242\246d\366\340\350\263\242Y'\264\370XzmG\231t\325\026\225\221\366\212"
+	"\311\320\341Ng\000I\343:Y\000\321\343n\241\312P*\252\363\3702\310\243\011\2278-\271\000\353\213\365o"
+	"\372R\275\177\231\257\226\033\334\276\370\240\177\015\337\026S\230\230\312\300\337\013\250\376\205)F"
+	"_\250u\215(\230<0\376\341\205m\307\334{\261\021\367\026n\250f\260\240\207%\022\263^\313U!\271\032\312"
+	"\231\253\3264\3771N\226=\335\203~\035\233;\320\230\266\322\203\033\336X%Y,\373\374\371u\304\263\347\301"
+	"\254n\232\374\241\032h>R\205\034\007)~\325ar\264\270\306\316\363\201%\207\247\217\367*\351\327\354\245"
+	"\313U\330D\006\011>\331+\255\331\205\367\177V\201\354,\177\265\0220a\240\262\203aj\042~\077%\375\217"
+	"&qQ\2736\014q\036\306\211\002^d\134\342\205\272\265\034\334\134\244\017x\247\134\340\255\207w\325l\022"
+	"\032\360\026\244\362\326K\370\007\177\243\247\366_\351\351\013\357k\017\370\323\253\2169\343M'\254\021"
+	"\257\025\340\313\335\005\357\134\271#(\341/\012\250 51\022\000\000", 3694}, {
+	"ETag: \042005b3ac1247a1e61-gzip\042\015\012Content-Encoding: gzip\015\012Vary: Accept-Encoding\015\012"
+	"Content-Type: image/png\015\012Content-Length: 3694\015\012\015\012", 127}},
+};
+
+} // namespace
+
+extern const http::asset_bundle assets;
+const http::asset_bundle assets(bundledAssets, std::size(bundledAssets));
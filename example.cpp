@@ -6,9 +6,11 @@
 
 using namespace std::string_literals;
 
+extern const http::asset_bundle assets; // bundled by the Makefile, see ASSETS
+
 bool requestListener(http::request &req) {
-	if (req.url.path.size() == 1 && req.url.path[0] == "favicon.ico") {
-		return req.response().sendFile("favicon.ico", "favicon.ico");
+	if (const http::bundled_asset *asset = assets.find(req.url.pathname)) {
+		return assets.send(req, *asset);
 	}
 
 	req.response().setStatus(200);
@@ -16,7 +18,7 @@ bool requestListener(http::request &req) {
 
 	std::string response;
 
-	response += "User-Agent: '"s + req.getHeader("User-Agent") + "'\n"s;
+	response += "User-Agent: '"s + std::string(req.getHeader(http::header::USER_AGENT)) + "'\n"s;
 
 	response += "req.url.href: '"s + req.url.href + "'\n"s;
 	response += "req.url.protocol: '"s + req.url.protocol + "'\n"s;
@@ -70,6 +72,9 @@ int main(int argc, char const *argv[]) {
 	for (const auto &sig : {SIGINT, SIGTERM, SIGQUIT, SIGILL, SIGABRT, SIGFPE, SIGSEGV, SIGBUS, SIGSYS, SIGPIPE})
 		std::signal(sig, http::server::stopAllInstances);
 
+	if (argc > 2) // worker processes, restarted if they crash
+		server.setWorkers(atoi(argv[2]));
+
 	server.listen(
 		host, port,
 		[&]() {
@@ -0,0 +1,127 @@
+#include "access_log.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+
+// OS-SPECIFIC INCLUDES TODO: CHANGE WHEN IMPLEMENTING CROSS-PLATFORM SUPPORT
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "io.hpp"
+#include "log.hpp"
+
+using namespace std::string_literals;
+
+namespace http {
+
+access_log::access_log(const std::string &path, size_t bufferSize)
+	: _fd(::open(path.c_str(), O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0644)),
+	  _bufferSize(std::max(bufferSize, stringSlots(maxStringLength) * slotSize * 8)) {
+	if (_fd < 0)
+		throw "Failed to open the access log "s + path + ": "s + std::strerror(errno);
+
+	_buffer.reserve(_bufferSize);
+	beginBlock();
+}
+
+access_log::~access_log() {
+	flush();
+	close(_fd);
+}
+
+void access_log::beginBlock() {
+	_buffer.clear();
+	_strings.clear();
+	_flushed = std::chrono::steady_clock::now();
+
+	block_slot block = {};
+	block.type = slot_type::BLOCK;
+	std::memcpy(block.magic, magic, sizeof(magic));
+	_blockPid = getpid();
+	block.pid = _blockPid;
+	_buffer.append(reinterpret_cast<const char *>(&block), sizeof(block));
+}
+
+void access_log::writeBlock() {
+	const bool forked = _blockPid != getpid(); // the parent writes what it buffered itself
+	if (!forked && _buffer.length() > slotSize && !writeAll(_fd, _buffer)) // a single write, appended as a whole
+		::http::warn("Failed to write the access log: ", std::strerror(errno));
+	beginBlock();
+}
+
+void access_log::flush() {
+	std::lock_guard lock(_mutex);
+	writeBlock();
+}
+
+uint32_t access_log::intern(std::string_view string) {
+	if (string.empty())
+		return 0;
+	string = string.substr(0, maxStringLength);
+
+	if (auto it = _strings.find(string); it != _strings.end())
+		return it->second;
+
+	string_slot definition = {};
+	definition.type = slot_type::STRING;
+	definition.id = static_cast<uint32_t>(_strings.size() + 1);
+	definition.length = static_cast<uint32_t>(string.length());
+
+	// the header, then the bytes padded to whole slots; the buffer never reallocates, the key views into it
+	const size_t offset = _buffer.length();
+	_buffer.append(reinterpret_cast<const char *>(&definition), offsetof(string_slot, data));
+	_buffer.append(string);
+	_buffer.append(stringSlots(string.length()) * slotSize - offsetof(string_slot, data) - string.length(), '\0');
+
+	_strings.emplace(std::string_view(_buffer).substr(offset + offsetof(string_slot, data), string.length()),
+					 definition.id);
+	return definition.id;
+}
+
+void access_log::append(const entry &entry) {
+	std::lock_guard lock(_mutex);
+
+	// room for the request, its usage and every one of its strings, so interning never reallocates the buffer
+	const size_t worstCase = (2 + 7 * stringSlots(maxStringLength)) * slotSize;
+	if (_blockPid != getpid()) // constructed before the process was forked, eg. by a prefork worker
+		beginBlock();
+	if (_buffer.length() + worstCase > _bufferSize ||
+		std::chrono::steady_clock::now() - _flushed > std::chrono::seconds(1))
+		writeBlock();
+
+	request_slot request = {};
+	request.type = slot_type::REQUEST;
+	request.status = static_cast<uint16_t>(entry.status);
+	request.method = intern(entry.method);
+	request.host = intern(entry.host);
+	request.target = intern(entry.target);
+	request.userAgent = intern(entry.userAgent);
+	request.client = intern(entry.client);
+	request.country = intern(entry.country);
+	request.error = intern(entry.error);
+	request.start = std::chrono::duration_cast<std::chrono::nanoseconds>(entry.start.time_since_epoch()).count();
+	request.duration = entry.duration.count();
+	request.requestBytes = entry.requestBytes;
+	request.responseBytes = entry.responseBytes;
+
+	_buffer.append(reinterpret_cast<const char *>(&request), sizeof(request));
+
+	if (entry.usage) {
+		const resource_usage &usage = *entry.usage;
+
+		usage_slot slot = {};
+		slot.type = slot_type::USAGE;
+		slot.recvCalls = static_cast<uint32_t>(usage.recvCalls);
+		slot.writeCalls = static_cast<uint32_t>(usage.writeCalls);
+		slot.allocations = static_cast<uint32_t>(usage.allocations);
+		slot.allocatedBytes = usage.allocatedBytes;
+		slot.recvBytes = usage.recvBytes;
+		slot.writeBytes = usage.writeBytes;
+		slot.copiedBytes = usage.copiedBytes;
+		_buffer.append(reinterpret_cast<const char *>(&slot), sizeof(slot));
+	}
+}
+
+} // namespace http
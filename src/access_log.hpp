@@ -0,0 +1,126 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+// OS-SPECIFIC INCLUDES TODO: CHANGE WHEN IMPLEMENTING CROSS-PLATFORM SUPPORT
+#include <sys/types.h>
+
+#include "accounting.hpp"
+
+namespace http {
+
+// Binary access log (see server::setAccessLog), rendered offline by http-logcat. Requests are buffered as fixed-size
+// records, strings are interned, and the buffer is appended to the file with a single write once it fills up, or
+// once it is a second old when the next request is logged. Every write is a self-contained block that redefines the
+// strings it uses, so processes may append to the same file concurrently and the file can be read (or mmap'ed) from
+// the start of any block.
+//
+// The file is a sequence of 64-byte slots: a block slot, then string slots (a definition followed by as many slots
+// as its bytes need) and request slots in the order they were logged, each optionally followed by the usage slot of
+// the request. Integers are in host byte order.
+class access_log {
+  public:
+	static constexpr size_t slotSize = 64;
+	static constexpr char magic[8] = {'H', 'T', 'T', 'P', 'L', 'O', 'G', '1'};
+
+	enum class slot_type : uint8_t {
+		BLOCK = 0,
+		STRING = 1,
+		REQUEST = 2,
+		USAGE = 3,
+	}; // slot_type
+
+	struct block_slot {
+		slot_type type;
+		uint8_t reserved[7];
+		char magic[8];
+		uint64_t pid;
+		uint8_t unused[slotSize - 24];
+	}; // block_slot
+
+	// The bytes continue past the slot into as many following slots as they need, after the first slot the string
+	// is contiguous
+	struct string_slot {
+		slot_type type;
+		uint8_t reserved[3];
+		uint32_t id; // valid until the end of the block
+		uint32_t length;
+		char data[slotSize - 12];
+	}; // string_slot
+
+	struct request_slot {
+		slot_type type;
+		uint8_t reserved;
+		uint16_t status; // 0 if the request failed
+		uint32_t method, host, target, userAgent, client, country, error; // string ids, 0 for none
+		uint64_t start;	   // nanoseconds since the epoch
+		uint64_t duration; // nanoseconds
+		uint64_t requestBytes;
+		uint64_t responseBytes;
+	}; // request_slot
+
+	// What the request before it cost, see resource_usage
+	struct usage_slot {
+		slot_type type;
+		uint8_t reserved[3];
+		uint32_t recvCalls, writeCalls;
+		uint32_t allocations;
+		uint64_t allocatedBytes;
+		uint64_t recvBytes, writeBytes, copiedBytes;
+		uint8_t unused[slotSize - 48];
+	}; // usage_slot
+
+	static constexpr size_t maxStringLength = 8192; // longer strings are truncated
+
+	// Slots taken by a string definition
+	static constexpr size_t stringSlots(size_t length) {
+		constexpr size_t inFirstSlot = sizeof(string_slot::data);
+		return 1 + (length > inFirstSlot ? (length - inFirstSlot + slotSize - 1) / slotSize : 0);
+	}
+
+	static_assert(sizeof(block_slot) == slotSize && sizeof(string_slot) == slotSize && sizeof(request_slot) == slotSize &&
+				  sizeof(usage_slot) == slotSize);
+
+	// Everything is only viewed, the strings are copied into the buffer if they are not interned yet
+	struct entry {
+		std::chrono::system_clock::time_point start;
+		std::chrono::nanoseconds duration;
+		std::string_view method, host, target, userAgent, client, country, error;
+		int status = 0;
+		size_t requestBytes = 0;
+		size_t responseBytes = 0;
+		const resource_usage *usage = nullptr; // logged in a usage slot if set
+	}; // entry
+
+	// Appends to path, creating it if needed; throws std::string on failure
+	explicit access_log(const std::string &path, size_t bufferSize = 64 * 1024);
+	~access_log(); // flushes
+
+	access_log(const access_log &) = delete;
+	access_log &operator=(const access_log &) = delete;
+
+	void append(const entry &entry);
+	void flush();
+
+  private:
+	uint32_t intern(std::string_view string);
+	void beginBlock();
+	void writeBlock();
+
+	int _fd;
+	const size_t _bufferSize;
+	pid_t _blockPid; // of the process that began the current block, a forked worker drops what its parent buffered
+
+	std::mutex _mutex;
+	std::string _buffer;
+	std::unordered_map<std::string_view, uint32_t> _strings; // views into _buffer, the strings of the current block
+	std::chrono::steady_clock::time_point _flushed;
+}; // access_log
+
+} // namespace http
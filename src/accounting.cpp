@@ -0,0 +1,61 @@
+#include "accounting.hpp"
+
+namespace http {
+
+resource_usage &resource_usage::operator+=(const resource_usage &other) {
+	allocations += other.allocations;
+	allocatedBytes += other.allocatedBytes;
+	recvCalls += other.recvCalls;
+	recvBytes += other.recvBytes;
+	writeCalls += other.writeCalls;
+	writeBytes += other.writeBytes;
+	copiedBytes += other.copiedBytes;
+	return *this;
+}
+
+resource_usage resource_usage::operator-(const resource_usage &other) const {
+	resource_usage difference;
+	difference.allocations = allocations - other.allocations;
+	difference.allocatedBytes = allocatedBytes - other.allocatedBytes;
+	difference.recvCalls = recvCalls - other.recvCalls;
+	difference.recvBytes = recvBytes - other.recvBytes;
+	difference.writeCalls = writeCalls - other.writeCalls;
+	difference.writeBytes = writeBytes - other.writeBytes;
+	difference.copiedBytes = copiedBytes - other.copiedBytes;
+	return difference;
+}
+
+accounting::totals_type accounting::_totals;
+
+void accounting::add(const resource_usage &usage) {
+	constexpr auto relaxed = std::memory_order_relaxed;
+
+	_totals.requests.fetch_add(1, relaxed);
+	_totals.allocations.fetch_add(usage.allocations, relaxed);
+	_totals.allocatedBytes.fetch_add(usage.allocatedBytes, relaxed);
+	_totals.recvCalls.fetch_add(usage.recvCalls, relaxed);
+	_totals.recvBytes.fetch_add(usage.recvBytes, relaxed);
+	_totals.writeCalls.fetch_add(usage.writeCalls, relaxed);
+	_totals.writeBytes.fetch_add(usage.writeBytes, relaxed);
+	_totals.copiedBytes.fetch_add(usage.copiedBytes, relaxed);
+}
+
+resource_usage accounting::totals() {
+	constexpr auto relaxed = std::memory_order_relaxed;
+
+	resource_usage usage;
+	usage.allocations = _totals.allocations.load(relaxed);
+	usage.allocatedBytes = _totals.allocatedBytes.load(relaxed);
+	usage.recvCalls = _totals.recvCalls.load(relaxed);
+	usage.recvBytes = _totals.recvBytes.load(relaxed);
+	usage.writeCalls = _totals.writeCalls.load(relaxed);
+	usage.writeBytes = _totals.writeBytes.load(relaxed);
+	usage.copiedBytes = _totals.copiedBytes.load(relaxed);
+	return usage;
+}
+
+uint64_t accounting::requests() {
+	return _totals.requests.load(std::memory_order_relaxed);
+}
+
+} // namespace http
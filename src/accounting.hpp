@@ -0,0 +1,74 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace http {
+
+// What serving a request cost besides time, so regressions in the parsing and response code show up as numbers
+struct resource_usage {
+	uint64_t allocations = 0; // only counted when build/count_allocations.o is linked, see accounting
+	uint64_t allocatedBytes = 0;
+	uint64_t recvCalls = 0;
+	uint64_t recvBytes = 0;
+	uint64_t writeCalls = 0;
+	uint64_t writeBytes = 0;
+	uint64_t copiedBytes = 0; // copied in user space, eg. from the receive buffer into the request
+
+	resource_usage &operator+=(const resource_usage &other);
+	resource_usage operator-(const resource_usage &other) const;
+}; // resource_usage
+
+// Counts, per thread, what the server and the responses do; the server attributes the difference between two points
+// to the request it served in between (see access_log and http-logcat) and adds it to the totals. A counter is a
+// plain increment of a thread local, so accounting is always on.
+//
+// Allocations are counted by replacing the global operator new, which a library should not do behind the back of
+// the application: link build/count_allocations.o into the executable to count them.
+class accounting {
+  public:
+	// Of the calling thread since it started
+	static const resource_usage &current() {
+		return _current;
+	}
+
+	static void allocated(size_t bytes) {
+		_current.allocations++;
+		_current.allocatedBytes += bytes;
+	}
+
+	static void received(size_t bytes) {
+		_current.recvCalls++;
+		_current.recvBytes += bytes;
+	}
+
+	static void wrote(size_t bytes) {
+		_current.writeCalls++;
+		_current.writeBytes += bytes;
+	}
+
+	static void copied(size_t bytes) {
+		_current.copiedBytes += bytes;
+	}
+
+	// Adds a served request to the totals
+	static void add(const resource_usage &usage);
+
+	static resource_usage totals(); // of every request served by the process
+	static uint64_t requests();
+
+  private:
+	static inline thread_local resource_usage _current;
+
+	struct totals_type {
+		std::atomic<uint64_t> requests{0};
+		std::atomic<uint64_t> allocations{0}, allocatedBytes{0};
+		std::atomic<uint64_t> recvCalls{0}, recvBytes{0};
+		std::atomic<uint64_t> writeCalls{0}, writeBytes{0};
+		std::atomic<uint64_t> copiedBytes{0};
+	};
+	static totals_type _totals;
+}; // accounting
+
+} // namespace http
@@ -0,0 +1,96 @@
+#include "body.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+// OS-SPECIFIC INCLUDES TODO: CHANGE WHEN IMPLEMENTING CROSS-PLATFORM SUPPORT
+#include <sys/socket.h>
+
+#include "accounting.hpp"
+#include "io.hpp"
+
+namespace http {
+
+request_body::request_body(int fd, std::string_view buffered, size_t length)
+	: _fd(fd), _buffered(buffered.substr(0, length)), _length(length), _remaining(length) {
+}
+
+size_t request_body::length() const {
+	return _length;
+}
+
+size_t request_body::remaining() const {
+	return _remaining;
+}
+
+size_t request_body::unreceived() const {
+	return _remaining - _buffered.length();
+}
+
+size_t request_body::read(char *buffer, size_t size) {
+	size = std::min(size, _remaining);
+	if (size == 0)
+		return 0;
+
+	if (!_buffered.empty()) {
+		size = std::min(size, _buffered.length());
+		std::memcpy(buffer, _buffered.data(), size);
+		accounting::copied(size);
+		_buffered.remove_prefix(size);
+		_remaining -= size;
+		return size;
+	}
+
+	if (_fd < 0)
+		return 0;
+
+	ssize_t bytesread;
+	do {
+		bytesread = recv(_fd, buffer, size, 0);
+		accounting::received(std::max<ssize_t>(bytesread, 0));
+	} while (bytesread < 0 && errno == EINTR);
+
+	if (bytesread <= 0) {
+		_remaining = 0; // the rest will never arrive
+		return 0;
+	}
+
+	_remaining -= bytesread;
+	return bytesread;
+}
+
+std::string request_body::readAll() {
+	std::string body(_remaining, '\0');
+
+	size_t received = 0;
+	while (received < body.length()) {
+		const size_t n = read(body.data() + received, body.length() - received);
+		if (n == 0)
+			break;
+		received += n;
+	}
+
+	body.resize(received);
+	return body;
+}
+
+bool request_body::relay(int fd) {
+	if (!_buffered.empty()) {
+		if (!writeAll(fd, _buffered))
+			return false;
+		_remaining -= _buffered.length();
+		_buffered = {};
+	}
+
+	if (_remaining == 0)
+		return true;
+	if (_fd < 0)
+		return false;
+
+	const size_t moved = ::http::relay(_fd, fd, _remaining);
+	_remaining -= moved;
+	return _remaining == 0;
+}
+
+} // namespace http
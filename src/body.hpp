@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace http {
+
+// The request body as far as the server did not consume it: the bytes received together with the head first, then
+// the rest straight from the socket, up to Content-Length. Chunked request bodies are not supported.
+class request_body {
+  public:
+	request_body() = default;
+	request_body(int fd, std::string_view buffered, size_t length); // fd may be -1 if the whole body is buffered
+
+	size_t length() const; // Content-Length, 0 if there is no body
+	size_t remaining() const;
+	size_t unreceived() const; // of remaining, what is not buffered yet
+
+	// Returns 0 at the end of the body, or if the client went away
+	size_t read(char *buffer, size_t size);
+	std::string readAll();
+
+	// Moves the rest of the body to fd, with splice where both ends allow it
+	bool relay(int fd);
+
+  private:
+	int _fd = -1;
+	std::string_view _buffered;
+	size_t _length = 0;
+	size_t _remaining = 0;
+}; // request_body
+
+} // namespace http
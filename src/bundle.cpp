@@ -0,0 +1,97 @@
+#include "bundle.hpp"
+
+#include <algorithm>
+
+#include "exception.hpp"
+#include "headers.hpp"
+
+using namespace std::string_literals;
+
+namespace http {
+
+const bundled_asset *asset_bundle::find(std::string_view path) const {
+	std::string index;
+	if (path.empty() || path.back() == '/') {
+		index = std::string(path.empty() ? "/" : path) + "index.html";
+		path = index;
+	}
+
+	const bundled_asset *found = std::lower_bound(
+		begin(), end(), path, [](const bundled_asset &asset, std::string_view path) { return asset.path < path; });
+	return found != end() && found->path == path ? found : nullptr;
+}
+
+bool asset_bundle::send(request &req) const {
+	const bundled_asset *asset = find(req.url.pathname);
+	if (!asset)
+		throw exception(404, "Resource "s + req.url.pathname + " not found"s);
+	return send(req, *asset);
+}
+
+// The tokens of a comma separated header, without their parameters, eg. "gzip" in "gzip;q=1.0, br"
+static bool listContains(std::string_view list, std::string_view token) {
+	while (!list.empty()) {
+		const size_t comma = std::min(list.find(','), list.length());
+		std::string_view item = list.substr(0, comma);
+		list.remove_prefix(std::min(comma + 1, list.length()));
+
+		item = item.substr(0, item.find(';'));
+		const size_t first = item.find_first_not_of(" \t");
+		if (first == std::string_view::npos)
+			continue;
+		item = item.substr(first, item.find_last_not_of(" \t") - first + 1);
+
+		if (item == token || item == "*")
+			return true;
+	}
+	return false;
+}
+
+bool asset_bundle::send(request &req, const bundled_asset &asset) {
+	const bool varies = !asset.gzipContent.empty();
+	const bool gzip = varies && listContains(req.getHeader(header::ACCEPT_ENCODING), "gzip");
+	const std::string_view etag = gzip ? asset.gzipEtag : asset.etag;
+
+	response &res = req.response();
+
+	const std::string_view ifNoneMatch = req.getHeader(header::IF_NONE_MATCH);
+	if (!ifNoneMatch.empty() && listContains(ifNoneMatch, etag)) {
+		res.setStatus(304);
+		res._headers.set(header::ETAG, std::string(etag));
+		if (varies)
+			res._headers.set(header::VARY, "Accept-Encoding");
+		res.setContentString({});
+		return res.send();
+	}
+
+	prepare(res, asset.type, etag, gzip ? asset.gzipContent : asset.content, gzip, varies);
+	if (res._headers.size() == 1u + gzip + varies) // unless the handler added headers of its own
+		res._preparedFields = gzip ? asset.gzipFields : asset.fields;
+	return res.send();
+}
+
+// What send answers with, serializeFields renders exactly this at build time
+void asset_bundle::prepare(response &res, content_type type, std::string_view etag, std::string_view content,
+						   bool gzip, bool varies) {
+	res.setStatus(200);
+	res._headers.set(header::ETAG, std::string(etag));
+	if (gzip)
+		res._headers.set(header::CONTENT_ENCODING, "gzip");
+	if (varies)
+		res._headers.set(header::VARY, "Accept-Encoding");
+	res.setContentType(type);
+	res.setContentView(content); // bundled, static
+}
+
+std::string asset_bundle::serializeFields(content_type type, std::string_view etag, std::string_view content,
+										  bool gzip, bool varies) {
+	response res(-1);
+	prepare(res, type, etag, content, gzip, varies);
+
+	// after the status line and the Date header
+	const std::string head = res.head();
+	const size_t dateEnd = head.find("\r\n", head.find("\r\n") + 2) + 2;
+	return head.substr(dateEnd);
+}
+
+} // namespace http
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+#include "content_type.hpp"
+#include "request.hpp"
+
+namespace http {
+
+// A file packed by http-bundle; everything views into the generated translation unit
+struct bundled_asset {
+	std::string_view path; // eg. "/favicon.ico"
+	content_type type;
+	std::string_view etag; // quoted
+	std::string_view content;
+	std::string_view fields; // the head that follows the Date header, serialized at build time
+
+	std::string_view gzipEtag, gzipContent, gzipFields; // empty unless compressing saved at least a tenth
+}; // bundled_asset
+
+// Static assets compiled into the executable (see the assets rule of the Makefile), served without touching the
+// filesystem, neither at startup nor per request. A bundle is constant-initialized, so it can be used from the
+// constructors of other globals:
+//
+//	extern const http::asset_bundle assets; // generated by http-bundle --name assets
+//
+//	if (const http::bundled_asset *asset = assets.find(req.url.pathname))
+//		return assets.send(req, *asset);
+class asset_bundle {
+  public:
+	// assets sorted by path
+	constexpr asset_bundle(const bundled_asset *assets, size_t count) : _assets(assets), _count(count) {}
+
+	// "/" and paths ending with "/" look up their index.html; nullptr if it is not bundled
+	const bundled_asset *find(std::string_view path) const;
+
+	// Answers with the asset at req.url.pathname, throws exception(404) if it is not bundled
+	bool send(request &req) const;
+
+	// Answers 304 if If-None-Match matches, otherwise with the gzip variant if there is one and the client accepts it
+	static bool send(request &req, const bundled_asset &asset);
+
+	// The fields send answers with after the Date header, for http-bundle to serialize them at build time
+	static std::string serializeFields(content_type type, std::string_view etag, std::string_view content,
+									   bool gzip, bool varies);
+
+	const bundled_asset *begin() const {
+		return _assets;
+	}
+	const bundled_asset *end() const {
+		return _assets + _count;
+	}
+	size_t size() const {
+		return _count;
+	}
+
+  private:
+	static void prepare(response &res, content_type type, std::string_view etag, std::string_view content, bool gzip,
+						bool varies);
+
+	const bundled_asset *_assets;
+	size_t _count;
+}; // asset_bundle
+
+} // namespace http
@@ -0,0 +1,149 @@
+#include "cache.hpp"
+
+#include <algorithm>
+
+using namespace std::string_literals;
+
+namespace http {
+
+response_cache::response_cache(size_t memoryBudget) : _memoryBudget(memoryBudget) {
+}
+
+void response_cache::addRule(rule rule) {
+	_rules.push_back(std::move(rule));
+}
+
+response_cache::lookup response_cache::find(method method, const url &url, const request_headers &headers) {
+	lookup lookup;
+
+	if (method != method::GET)
+		return lookup;
+
+	for (const auto &rule : _rules) {
+		if (rule.matches(url)) {
+			lookup.matched = &rule;
+			break;
+		}
+	}
+
+	if (!lookup.matched)
+		return lookup;
+
+	lookup.authorized = headers.has(header::AUTHORIZATION);
+	lookup.key = url.hostname + " "s + url.pathname;
+	for (const auto &param : lookup.matched->varySearchParams) {
+		auto it = url.searchParams.find(param);
+		lookup.key += "\n"s + param + (it == url.searchParams.end() ? ""s : "="s + it->second);
+	}
+	for (const auto &name : lookup.matched->varyHeaders) {
+		lookup.key += "\n"s + name + ": "s;
+		lookup.key += headers.get(name);
+	}
+
+	std::lock_guard lock(_mutex);
+
+	auto it = _index.find(lookup.key);
+	if (it == _index.end())
+		return lookup;
+
+	entry &entry = *it->second;
+	const auto now = clock::now();
+
+	if (now >= entry.staleUntil) {
+		erase(it->second);
+		return lookup;
+	}
+
+	_entries.splice(_entries.begin(), _entries, it->second);
+
+	lookup.response = entry.response;
+	lookup.headLength = entry.headLength;
+	lookup.age = std::chrono::duration_cast<std::chrono::seconds>(now - entry.stored).count();
+	lookup.status = entry.status;
+	lookup.size = entry.size;
+
+	if (now < entry.expires || entry.revalidating) {
+		lookup.state = freshness::FRESH;
+	} else {
+		lookup.state = freshness::STALE;
+		entry.revalidating = true;
+	}
+
+	return lookup;
+}
+
+// Whether a Cache-Control header lists one of the directives, eg. "private" in "private, max-age=60"
+static bool hasDirective(std::string_view cacheControl, std::initializer_list<std::string_view> directives) {
+	while (!cacheControl.empty()) {
+		const size_t comma = std::min(cacheControl.find(','), cacheControl.length());
+		std::string_view directive = cacheControl.substr(0, comma);
+		cacheControl.remove_prefix(std::min(comma + 1, cacheControl.length()));
+
+		directive = directive.substr(0, directive.find('='));
+		const size_t first = directive.find_first_not_of(" \t");
+		if (first == std::string_view::npos)
+			continue;
+		directive = directive.substr(first, directive.find_last_not_of(" \t") - first + 1);
+
+		for (const std::string_view listed : directives)
+			if (equalsIgnoreCase(directive, listed))
+				return true;
+	}
+	return false;
+}
+
+// Responses meant for one client, or not to be reused, are never replayed to others
+bool response_cache::isShareable(const response &response) {
+	return !response._streamed && !response._headers.has(header::SET_COOKIE) &&
+		   !hasDirective(response._headers.get(header::CACHE_CONTROL), {"private", "no-store", "no-cache"});
+}
+
+bool response_cache::isStorable(const response &response) {
+	return response._status == 200 && isShareable(response);
+}
+
+void response_cache::store(const lookup &lookup, const response &response) {
+	if (lookup.key.empty())
+		return;
+
+	std::shared_ptr<const std::string> serialized;
+	size_t headLength = 0;
+	// a response to credentials is only shared if it says so
+	if (isStorable(response) &&
+		(!lookup.authorized || hasDirective(response._headers.get(header::CACHE_CONTROL), {"public", "s-maxage"}))) {
+		std::string head = response.head();
+		headLength = head.length();
+		serialized = std::make_shared<const std::string>(head.append(response.content()));
+	}
+
+	std::lock_guard lock(_mutex);
+
+	auto it = _index.find(lookup.key);
+	if (it != _index.end())
+		erase(it->second);
+
+	if (!serialized || serialized->size() + lookup.key.size() > _memoryBudget)
+		return;
+
+	const auto now = clock::now();
+	_entries.push_front({lookup.key, serialized, headLength, response._status, response.content().size(), now,
+						 now + lookup.matched->ttl, now + lookup.matched->ttl + lookup.matched->staleWhileRevalidate});
+	_index.emplace(_entries.front().key, _entries.begin());
+	_memoryUsage += serialized->size() + lookup.key.size();
+
+	while (_memoryUsage > _memoryBudget)
+		erase(std::prev(_entries.end()));
+}
+
+size_t response_cache::memoryUsage() {
+	std::lock_guard lock(_mutex);
+	return _memoryUsage;
+}
+
+void response_cache::erase(std::list<entry>::iterator it) {
+	_memoryUsage -= it->response->size() + it->key.size();
+	_index.erase(it->key);
+	_entries.erase(it);
+}
+
+} // namespace http
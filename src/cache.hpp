@@ -0,0 +1,100 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "method.hpp"
+#include "url.hpp"
+#include "headers.hpp"
+#include "response.hpp"
+
+namespace http {
+
+// Opt-in cache of serialized handler responses, shared by any number of servers (see server::setResponseCache).
+// Only GET requests matching a rule are cached, and only their 200 responses, unless they set a cookie or their
+// Cache-Control is private, no-store or no-cache. Responses to requests with Authorization are only cached if their
+// Cache-Control is public or has s-maxage, as for any shared cache (RFC 9111 section 3.5). A fresh entry is written to the client without calling the
+// handler, as it was serialized plus an Age header. Once it expires, it is still served for staleWhileRevalidate
+// while a single request re-runs the handler for it after its client was answered. Least recently used entries are
+// evicted to stay within the memory budget.
+class response_cache {
+  public:
+	using clock = std::chrono::steady_clock;
+
+	struct rule {
+		std::function<bool(const url &)> matches;
+		clock::duration ttl;
+		clock::duration staleWhileRevalidate = clock::duration::zero();
+		std::vector<std::string> varySearchParams; // part of the key, other search params are ignored
+		std::vector<std::string> varyHeaders;	   // part of the key
+	};
+
+	enum class freshness {
+		MISS,
+		FRESH,
+		STALE, // serve it, then revalidate
+	};
+
+	struct lookup {
+		freshness state = freshness::MISS;
+		std::string key; // empty if the request is not cacheable
+		const rule *matched = nullptr;
+		bool authorized = false; // the request carries Authorization
+
+		std::shared_ptr<const std::string> response; // FRESH and STALE only
+		size_t headLength = 0;						 // of response, up to the blank line
+		uint64_t age = 0;							 // seconds since it was stored
+		int status = 0;
+		size_t size = 0; // of the content
+	};
+
+	explicit response_cache(size_t memoryBudget);
+
+	void addRule(rule rule); // before any lookup
+
+	lookup find(method method, const url &url, const request_headers &headers);
+
+	// Caches the response of a MISS or STALE lookup, or drops the entry if the response can not be cached
+	void store(const lookup &lookup, const response &response);
+
+	size_t memoryUsage();
+
+	// Whether a response may be replayed to other clients: not streamed, setting no cookie, and not Cache-Control
+	// private, no-store or no-cache. Also checked by single_flight before sharing a response.
+	static bool isShareable(const response &response);
+
+  private:
+	struct entry {
+		std::string key;
+		std::shared_ptr<const std::string> response;
+		size_t headLength;
+		int status;
+		size_t size;
+		clock::time_point stored;
+		clock::time_point expires;
+		clock::time_point staleUntil;
+		bool revalidating = false;
+	};
+
+	static bool isStorable(const response &response);
+	void erase(std::list<entry>::iterator it);
+
+	const size_t _memoryBudget;
+	size_t _memoryUsage = 0;
+
+	std::vector<rule> _rules;
+
+	std::mutex _mutex;
+	std::list<entry> _entries; // most recently used first
+	std::unordered_map<std::string_view, std::list<entry>::iterator> _index; // keys view entry::key
+}; // response_cache
+
+} // namespace http
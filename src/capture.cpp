@@ -0,0 +1,95 @@
+#include "capture.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+// OS-SPECIFIC INCLUDES TODO: CHANGE WHEN IMPLEMENTING CROSS-PLATFORM SUPPORT
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "headers.hpp"
+#include "io.hpp"
+#include "log.hpp"
+
+using namespace std::string_literals;
+
+namespace http {
+
+traffic_capture::traffic_capture(const std::string &path, size_t maxBodySize, size_t bufferSize)
+	: _fd(::open(path.c_str(), O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0600)), _maxBodySize(maxBodySize),
+	  _bufferSize(bufferSize), _flushed(std::chrono::steady_clock::now()) {
+	if (_fd < 0)
+		throw "Failed to open the capture file "s + path + ": "s + std::strerror(errno);
+
+	struct stat status;
+	if (fstat(_fd, &status) == 0 && status.st_size == 0)
+		_buffer.append(magic, sizeof(magic));
+}
+
+traffic_capture::~traffic_capture() {
+	flush();
+	close(_fd);
+}
+
+size_t traffic_capture::maxBodySize() const {
+	return _maxBodySize;
+}
+
+void traffic_capture::setRedactedHeaders(std::vector<std::string> names) {
+	_redactedHeaders = std::move(names);
+}
+
+void traffic_capture::redact(size_t offset) {
+	const std::string_view recorded = std::string_view(_buffer).substr(offset);
+	const size_t headEnd = std::min(recorded.find("\r\n\r\n"), recorded.length()); // the head may be truncated
+
+	size_t lineEnd = recorded.find("\r\n"); // after the request line
+	while (lineEnd < headEnd) {
+		const size_t lineStart = lineEnd + 2;
+		lineEnd = std::min(recorded.find("\r\n", lineStart), recorded.length());
+
+		const size_t colon = recorded.find(':', lineStart);
+		if (colon >= lineEnd)
+			continue;
+
+		const std::string_view name = recorded.substr(lineStart, colon - lineStart);
+		const bool redacted =
+			std::any_of(_redactedHeaders.begin(), _redactedHeaders.end(), [name](const std::string &header) {
+				return equalsIgnoreCase(name, header);
+			});
+		if (redacted) {
+			const size_t value = std::min(recorded.find_first_not_of(" \t", colon + 1), lineEnd);
+			std::fill(_buffer.begin() + offset + value, _buffer.begin() + offset + lineEnd, '*');
+		}
+	}
+}
+
+void traffic_capture::write() {
+	if (!_buffer.empty() && !writeAll(_fd, _buffer)) // a single write, appended as a whole
+		::http::warn("Failed to write the capture: ", std::strerror(errno));
+
+	_buffer.clear();
+	_flushed = std::chrono::steady_clock::now();
+}
+
+void traffic_capture::flush() {
+	std::lock_guard lock(_mutex);
+	write();
+}
+
+void traffic_capture::record(const record_header &header, std::string_view request) {
+	std::lock_guard lock(_mutex);
+
+	_buffer.append(reinterpret_cast<const char *>(&header), sizeof(header));
+	const size_t offset = _buffer.length();
+	_buffer.append(request.substr(0, header.length));
+	if (!_redactedHeaders.empty())
+		redact(offset);
+
+	if (_buffer.length() >= _bufferSize || std::chrono::steady_clock::now() - _flushed > std::chrono::seconds(1))
+		write();
+}
+
+} // namespace http
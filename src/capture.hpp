@@ -0,0 +1,71 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace http {
+
+// Traffic capture (see server::setCapture), replayed by http-replay. Every HTTP/1.1 request is recorded with its raw
+// bytes, as received, its arrival time and how the server answered it, so a replay can compare latencies. Records are
+// buffered and appended to the file with a single write, several processes may capture to the same file.
+//
+// Requests carry credentials: the file is created readable by its owner only, and the values of the redacted headers
+// (Authorization, Proxy-Authorization and Cookie by default) are overwritten with '*', keeping their length. Bodies are
+// recorded as is, keep maxBodySize at 0 if they may hold secrets.
+//
+// The file starts with the magic, followed by records: a record header, then length bytes of the request.
+class traffic_capture {
+  public:
+	static constexpr char magic[8] = {'H', 'T', 'T', 'P', 'C', 'A', 'P', '1'};
+
+	enum flags : uint16_t {
+		TRUNCATED = 1, // the body was longer than maxBodySize, only the head and what came with it were recorded
+	}; // flags
+
+	struct record_header {
+		uint64_t arrival;  // nanoseconds since the epoch
+		uint64_t duration; // nanoseconds it took to answer
+		uint64_t responseBytes;
+		uint32_t length; // of the request that follows
+		uint16_t status; // 0 if the request failed
+		uint16_t flags;
+	}; // record_header
+
+	static_assert(sizeof(record_header) == 32);
+
+	// Appends to path, creating it if needed; throws std::string on failure. Bodies up to maxBodySize are read before
+	// the handler runs, so they can be recorded; the handler gets them from memory.
+	explicit traffic_capture(const std::string &path, size_t maxBodySize = 1024 * 1024,
+							 size_t bufferSize = 256 * 1024);
+	~traffic_capture(); // flushes
+
+	traffic_capture(const traffic_capture &) = delete;
+	traffic_capture &operator=(const traffic_capture &) = delete;
+
+	size_t maxBodySize() const;
+
+	void setRedactedHeaders(std::vector<std::string> names); // before any request
+
+	void record(const record_header &header, std::string_view request);
+	void flush();
+
+  private:
+	void write();
+	void redact(size_t offset); // the head of the request appended to _buffer at offset
+
+	int _fd;
+	const size_t _maxBodySize;
+	const size_t _bufferSize;
+	std::vector<std::string> _redactedHeaders = {"Authorization", "Proxy-Authorization", "Cookie"};
+
+	std::mutex _mutex;
+	std::string _buffer;
+	std::chrono::steady_clock::time_point _flushed;
+}; // traffic_capture
+
+} // namespace http
@@ -1,5 +1,9 @@
 #pragma once
 
+#include <cstddef>
+#include <iterator>
+#include <string_view>
+
 namespace http {
 
 enum class content_type {
@@ -44,4 +48,101 @@ enum class content_type {
 	VIDEO_WEBM,
 }; // content_type
 
+// indexed by content_type
+constexpr std::string_view contentTypeNames[] = {
+	"application/java-archive",				// APPLICATION_JAVA_ARCHIVE
+	"application/EDI_X12",					// APPLICATION_EDI_X12
+	"application/EDIFACT",					// APPLICATION_EDIFACT
+	"application/javascript",				// APPLICATION_JAVASCRIPT
+	"application/octet-stream",				// APPLICATION_OCTET_STREAM
+	"application/ogg",						// APPLICATION_OGG
+	"application/pdf",						// APPLICATION_PDF
+	"application/xhtml+xml",				// APPLICATION_XHTML_XML
+	"application/x-shockwave-flash",		// APPLICATION_X_SHOCKWAVE_FLASH
+	"application/json",						// APPLICATION_JSON
+	"application/ld+json",					// APPLICATION_LD_JSON
+	"application/xml",						// APPLICATION_XML
+	"application/zip",						// APPLICATION_ZIP
+	"application/x-www-form-urlencoded",	// APPLICATION_X_WWW_FORM_URLENCODED
+	"audio/mpeg",							// AUDIO_MPEG
+	"audio/x-ms-wma",						// AUDIO_X_MS_WMA
+	"audio/vnd.rn-realaudio",				// AUDIO_VND_RN_REALAUDIO
+	"audio/x-wav",							// AUDIO_X_WAV
+	"image/gif",							// IMAGE_GIF
+	"image/jpeg",							// IMAGE_JPEG
+	"image/png",							// IMAGE_PNG
+	"image/tiff",							// IMAGE_TIFF
+	"image/vnd.microsoft.icon",				// IMAGE_VND_MICROSOFT_ICON
+	"image/x-icon",							// IMAGE_X_ICON
+	"image/vnd.djvu",						// IMAGE_VND_DJVU
+	"image/svg+xml",						// IMAGE_SVG_XML
+	"text/css",								// TEXT_CSS
+	"text/csv",								// TEXT_CSV
+	"text/html",							// TEXT_HTML
+	"text/javascript",						// TEXT_JAVASCRIPT
+	"text/plain",							// TEXT_PLAIN
+	"text/xml",								// TEXT_XML
+	"video/mpeg",							// VIDEO_MPEG
+	"video/mp4",							// VIDEO_MP4
+	"video/quicktime",						// VIDEO_QUICKTIME
+	"video/x-ms-wmv",						// VIDEO_X_MS_WMV
+	"video/x-msvideo",						// VIDEO_X_MSVIDEO
+	"video/x-flv",							// VIDEO_X_FLV
+	"video/webm",							// VIDEO_WEBM
+};
+
+// indexed by content_type, pre-rendered for the response head
+constexpr std::string_view contentTypeHeaders[] = {
+	"Content-Type: application/java-archive\r\n",
+	"Content-Type: application/EDI_X12\r\n",
+	"Content-Type: application/EDIFACT\r\n",
+	"Content-Type: application/javascript\r\n",
+	"Content-Type: application/octet-stream\r\n",
+	"Content-Type: application/ogg\r\n",
+	"Content-Type: application/pdf\r\n",
+	"Content-Type: application/xhtml+xml\r\n",
+	"Content-Type: application/x-shockwave-flash\r\n",
+	"Content-Type: application/json\r\n",
+	"Content-Type: application/ld+json\r\n",
+	"Content-Type: application/xml\r\n",
+	"Content-Type: application/zip\r\n",
+	"Content-Type: application/x-www-form-urlencoded\r\n",
+	"Content-Type: audio/mpeg\r\n",
+	"Content-Type: audio/x-ms-wma\r\n",
+	"Content-Type: audio/vnd.rn-realaudio\r\n",
+	"Content-Type: audio/x-wav\r\n",
+	"Content-Type: image/gif\r\n",
+	"Content-Type: image/jpeg\r\n",
+	"Content-Type: image/png\r\n",
+	"Content-Type: image/tiff\r\n",
+	"Content-Type: image/vnd.microsoft.icon\r\n",
+	"Content-Type: image/x-icon\r\n",
+	"Content-Type: image/vnd.djvu\r\n",
+	"Content-Type: image/svg+xml\r\n",
+	"Content-Type: text/css\r\n",
+	"Content-Type: text/csv\r\n",
+	"Content-Type: text/html\r\n",
+	"Content-Type: text/javascript\r\n",
+	"Content-Type: text/plain\r\n",
+	"Content-Type: text/xml\r\n",
+	"Content-Type: video/mpeg\r\n",
+	"Content-Type: video/mp4\r\n",
+	"Content-Type: video/quicktime\r\n",
+	"Content-Type: video/x-ms-wmv\r\n",
+	"Content-Type: video/x-msvideo\r\n",
+	"Content-Type: video/x-flv\r\n",
+	"Content-Type: video/webm\r\n",
+};
+
+static_assert(std::size(contentTypeNames) == static_cast<size_t>(content_type::VIDEO_WEBM) + 1);
+static_assert(std::size(contentTypeHeaders) == std::size(contentTypeNames));
+
+constexpr std::string_view contentTypeToString(content_type type) {
+	return contentTypeNames[static_cast<size_t>(type)];
+}
+
+constexpr std::string_view contentTypeHeader(content_type type) {
+	return contentTypeHeaders[static_cast<size_t>(type)];
+}
+
 } // namespace http
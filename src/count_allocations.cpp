@@ -0,0 +1,38 @@
+// Replaces the global operator new to count allocations per thread, see accounting. Not part of http-server.a: link
+// build/count_allocations.o into the executable to enable it. The default operator delete frees with free, and the
+// array and nothrow variants call these.
+
+#include <cstdlib>
+#include <new>
+
+#include "accounting.hpp"
+
+void *operator new(std::size_t size) {
+	http::accounting::allocated(size);
+
+	while (true) {
+		if (void *memory = std::malloc(size ? size : 1))
+			return memory;
+
+		const std::new_handler handler = std::get_new_handler();
+		if (!handler)
+			throw std::bad_alloc();
+		handler();
+	}
+}
+
+void *operator new(std::size_t size, std::align_val_t alignment) {
+	http::accounting::allocated(size);
+
+	const std::size_t align = static_cast<std::size_t>(alignment);
+	const std::size_t rounded = ((size ? size : 1) + align - 1) / align * align; // as aligned_alloc requires
+	while (true) {
+		if (void *memory = std::aligned_alloc(align, rounded))
+			return memory;
+
+		const std::new_handler handler = std::get_new_handler();
+		if (!handler)
+			throw std::bad_alloc();
+		handler();
+	}
+}
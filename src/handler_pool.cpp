@@ -0,0 +1,109 @@
+#include "handler_pool.hpp"
+
+#include <algorithm>
+
+namespace http {
+
+// The pool and worker index of the current thread, so tasks submitted by a task stay on its worker
+static thread_local const handler_pool *currentPool = nullptr;
+static thread_local size_t currentWorker = 0;
+
+handler_pool::handler_pool(size_t threads) {
+	threads = std::max<size_t>(threads, 1);
+
+	for (size_t i = 0; i < threads; i++)
+		_workers.push_back(std::make_unique<worker>());
+
+	// the workers only start once every queue exists, they steal from each other
+	for (size_t i = 0; i < threads; i++)
+		_workers[i]->thread = std::thread(&handler_pool::run, this, i);
+}
+
+handler_pool::~handler_pool() {
+	{
+		std::lock_guard lock(_sleepMutex);
+		_stopping = true;
+	}
+	_wakeUp.notify_all();
+
+	for (const auto &worker : _workers)
+		worker->thread.join();
+}
+
+void handler_pool::submit(taskType task) {
+	const size_t index = currentPool == this ? currentWorker : _next.fetch_add(1) % _workers.size();
+
+	{ // counted under the sleep lock, so a worker about to wait cannot miss it, and before it is queued, so taking it
+	  // never makes the count negative
+		std::lock_guard lock(_sleepMutex);
+		_queued++;
+	}
+
+	{
+		std::lock_guard lock(_workers[index]->mutex);
+		_workers[index]->tasks.push_back(std::move(task));
+	}
+	_wakeUp.notify_one();
+}
+
+size_t handler_pool::threads() const {
+	return _workers.size();
+}
+
+size_t handler_pool::queued() const {
+	return _queued;
+}
+
+size_t handler_pool::stolen() const {
+	return _stolen;
+}
+
+bool handler_pool::take(size_t index, taskType &task) {
+	{ // the oldest of our own
+		worker &own = *_workers[index];
+		std::lock_guard lock(own.mutex);
+		if (!own.tasks.empty()) {
+			task = std::move(own.tasks.front());
+			own.tasks.pop_front();
+			_queued--;
+			return true;
+		}
+	}
+
+	for (size_t i = 1; i < _workers.size(); i++) { // the newest of someone else's
+		worker &victim = *_workers[(index + i) % _workers.size()];
+		std::lock_guard lock(victim.mutex);
+		if (!victim.tasks.empty()) {
+			task = std::move(victim.tasks.back());
+			victim.tasks.pop_back();
+			_queued--;
+			_stolen++;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void handler_pool::run(size_t index) {
+	currentPool = this;
+	currentWorker = index;
+
+	taskType task;
+	while (true) {
+		{
+			std::unique_lock lock(_sleepMutex);
+			_wakeUp.wait(lock, [this] { return _queued > 0 || _stopping; });
+			if (_queued == 0) // stopping and nothing left to run
+				return;
+		}
+
+		if (!take(index, task))
+			continue; // taken by another worker, or counted but not queued yet
+
+		task();
+		task = nullptr;
+	}
+}
+
+} // namespace http
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace http {
+
+// Threads for CPU-heavy handlers, separate from the threads listening for connections (see server::setHandlerPool).
+// Every worker has its own queue and takes the oldest task from its front; a worker whose queue is empty steals the
+// newest task from the back of another one, so the two rarely contend for the same end. Tasks submitted from outside
+// the pool are spread over the queues round-robin, tasks submitted by a task go to the queue of its own worker.
+class handler_pool {
+  public:
+	using taskType = std::function<void()>;
+
+	explicit handler_pool(size_t threads = std::thread::hardware_concurrency());
+	~handler_pool(); // runs the tasks still queued, then joins the workers
+
+	handler_pool(const handler_pool &) = delete;
+	handler_pool &operator=(const handler_pool &) = delete;
+
+	void submit(taskType task);
+
+	size_t threads() const;
+	size_t queued() const; // submitted but not yet started
+	size_t stolen() const; // taken from the queue of another worker
+
+  private:
+	struct worker {
+		std::mutex mutex;
+		std::deque<taskType> tasks;
+		std::thread thread;
+	};
+
+	void run(size_t index);
+	bool take(size_t index, taskType &task);
+
+	std::vector<std::unique_ptr<worker>> _workers;
+	std::atomic<size_t> _next = 0;
+	std::atomic<size_t> _queued = 0;
+	std::atomic<size_t> _stolen = 0;
+
+	std::mutex _sleepMutex;
+	std::condition_variable _wakeUp;
+	bool _stopping = false;
+}; // handler_pool
+
+} // namespace http
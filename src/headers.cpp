@@ -0,0 +1,74 @@
+#include "headers.hpp"
+
+namespace http {
+
+static constexpr std::string_view headerNames[headerCount] = {
+	"",
+	"Accept",
+	"Accept-Encoding",
+	"Accept-Language",
+	"Authorization",
+	"Cache-Control",
+	"Cf-Connecting-Ip",
+	"Cf-Ipcountry",
+	"Connection",
+	"Content-Encoding",
+	"Content-Length",
+	"Content-Type",
+	"Cookie",
+	"Date",
+	"ETag",
+	"Expect",
+	"Host",
+	"If-Modified-Since",
+	"If-None-Match",
+	"Last-Modified",
+	"Location",
+	"Origin",
+	"Range",
+	"Referer",
+	"Server",
+	"Set-Cookie",
+	"Transfer-Encoding",
+	"Upgrade",
+	"User-Agent",
+	"Vary",
+	"X-Forwarded-For",
+	"X-Forwarded-Host",
+	"X-Forwarded-Proto",
+};
+
+static constexpr char toLower(char c) {
+	return (c >= 'A' && c <= 'Z') ? c + ('a' - 'A') : c;
+}
+
+bool equalsIgnoreCase(std::string_view a, std::string_view b) {
+	if (a.length() != b.length())
+		return false;
+
+	for (size_t i = 0; i < a.length(); i++) {
+		if (toLower(a[i]) != toLower(b[i]))
+			return false;
+	}
+
+	return true;
+}
+
+header headerFromName(std::string_view name) {
+	// the first letter and the length rule out all but one or two candidates before comparing
+	const char first = toLower(name.empty() ? '\0' : name[0]);
+
+	for (size_t i = 1; i < headerCount; i++) {
+		if (headerNames[i].length() == name.length() && toLower(headerNames[i][0]) == first &&
+			equalsIgnoreCase(headerNames[i], name))
+			return static_cast<header>(i);
+	}
+
+	return header::UNKNOWN;
+}
+
+std::string_view headerToString(header header) {
+	return headerNames[static_cast<size_t>(header)];
+}
+
+} // namespace http
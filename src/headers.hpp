@@ -0,0 +1,187 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace http {
+
+// Headers recognised while parsing, looking them up is an array index instead of a scan
+enum class header : uint8_t {
+	UNKNOWN,
+	ACCEPT,
+	ACCEPT_ENCODING,
+	ACCEPT_LANGUAGE,
+	AUTHORIZATION,
+	CACHE_CONTROL,
+	CF_CONNECTING_IP,
+	CF_IPCOUNTRY,
+	CONNECTION,
+	CONTENT_ENCODING,
+	CONTENT_LENGTH,
+	CONTENT_TYPE,
+	COOKIE,
+	DATE,
+	ETAG,
+	EXPECT,
+	HOST,
+	IF_MODIFIED_SINCE,
+	IF_NONE_MATCH,
+	LAST_MODIFIED,
+	LOCATION,
+	ORIGIN,
+	RANGE,
+	REFERER,
+	SERVER,
+	SET_COOKIE,
+	TRANSFER_ENCODING,
+	UPGRADE,
+	USER_AGENT,
+	VARY,
+	X_FORWARDED_FOR,
+	X_FORWARDED_HOST,
+	X_FORWARDED_PROTO,
+}; // header
+
+constexpr size_t headerCount = static_cast<size_t>(header::X_FORWARDED_PROTO) + 1;
+
+header headerFromName(std::string_view name); // case-insensitive, header::UNKNOWN if not well-known
+std::string_view headerToString(header header); // canonical spelling, eg. "Content-Length"
+
+bool equalsIgnoreCase(std::string_view a, std::string_view b);
+
+// Flat list of (name, value) pairs, kept inline until it outgrows the inline capacity.
+// Names are matched case-insensitively, well-known names through an index by header.
+// Setting or adding a header that is already present makes the latest value the one that is looked up.
+template <typename String> class basic_headers {
+  public:
+	using entry = std::pair<String, String>;
+
+	basic_headers() = default;
+	basic_headers(const basic_headers &other) {
+		*this = other;
+	}
+
+	basic_headers &operator=(const basic_headers &other) {
+		clear();
+		for (const auto &[name, value] : other)
+			add(name, value);
+		return *this;
+	}
+
+	void add(String name, String value) {
+		const header known = headerFromName(name);
+		append(std::move(name), std::move(value), known);
+	}
+
+	void set(String name, String value) {
+		const header known = headerFromName(name);
+		const size_t index = indexOf(known, name);
+		if (index != npos) {
+			data()[index].second = std::move(value);
+		} else {
+			append(std::move(name), std::move(value), known);
+		}
+	}
+
+	void set(header known, String value) { // known must not be header::UNKNOWN
+		const size_t index = indexOf(known, {});
+		if (index != npos) {
+			data()[index].second = std::move(value);
+		} else {
+			append(String(headerToString(known)), std::move(value), known);
+		}
+	}
+
+	std::string_view get(std::string_view name) const {
+		const size_t index = indexOf(headerFromName(name), name);
+		return index != npos ? std::string_view(begin()[index].second) : std::string_view();
+	}
+
+	std::string_view get(header known) const {
+		const size_t index = indexOf(known, {});
+		return index != npos ? std::string_view(begin()[index].second) : std::string_view();
+	}
+
+	bool has(std::string_view name) const {
+		return indexOf(headerFromName(name), name) != npos;
+	}
+
+	bool has(header known) const {
+		return indexOf(known, {}) != npos;
+	}
+
+	void clear() {
+		for (size_t i = 0; i < std::min(_size, inlineCapacity); i++)
+			_inline[i] = {};
+		_heap.clear();
+		_size = 0;
+		for (auto &index : _known)
+			index = 0;
+	}
+
+	size_t size() const {
+		return _size;
+	}
+
+	const entry *begin() const {
+		return _heap.empty() ? _inline : _heap.data();
+	}
+
+	const entry *end() const {
+		return begin() + _size;
+	}
+
+  private:
+	static constexpr size_t inlineCapacity = 16;
+	static constexpr size_t npos = static_cast<size_t>(-1);
+
+	entry *data() {
+		return _heap.empty() ? _inline : _heap.data();
+	}
+
+	size_t indexOf(header known, std::string_view name) const {
+		if (known != header::UNKNOWN) {
+			const uint16_t index = _known[static_cast<size_t>(known)];
+			return index ? index - 1 : npos;
+		}
+
+		for (size_t i = _size; i-- > 0;) {
+			if (equalsIgnoreCase(begin()[i].first, name))
+				return i;
+		}
+
+		return npos;
+	}
+
+	void append(String name, String value, header known) {
+		if (_size < inlineCapacity) {
+			_inline[_size] = {std::move(name), std::move(value)};
+		} else {
+			if (_heap.empty()) {
+				_heap.reserve(inlineCapacity * 2);
+				for (auto &e : _inline)
+					_heap.push_back(std::move(e));
+			}
+			_heap.emplace_back(std::move(name), std::move(value));
+		}
+
+		_size++;
+		if (known != header::UNKNOWN && _size <= UINT16_MAX)
+			_known[static_cast<size_t>(known)] = static_cast<uint16_t>(_size);
+	}
+
+	entry _inline[inlineCapacity];
+	std::vector<entry> _heap;
+	size_t _size = 0;
+	uint16_t _known[headerCount] = {}; // index + 1 into the entries, 0 if absent
+}; // basic_headers
+
+using request_headers = basic_headers<std::string_view>; // views into the received request
+using response_headers = basic_headers<std::string>;
+
+} // namespace http
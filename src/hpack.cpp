@@ -0,0 +1,502 @@
+#include "hpack.hpp"
+
+#include <algorithm>
+#include <array>
+
+namespace http {
+
+namespace hpack {
+
+static const std::pair<std::string, std::string> staticTable[] = {
+	{":authority", ""},
+	{":method", "GET"},
+	{":method", "POST"},
+	{":path", "/"},
+	{":path", "/index.html"},
+	{":scheme", "http"},
+	{":scheme", "https"},
+	{":status", "200"},
+	{":status", "204"},
+	{":status", "206"},
+	{":status", "304"},
+	{":status", "400"},
+	{":status", "404"},
+	{":status", "500"},
+	{"accept-charset", ""},
+	{"accept-encoding", "gzip, deflate"},
+	{"accept-language", ""},
+	{"accept-ranges", ""},
+	{"accept", ""},
+	{"access-control-allow-origin", ""},
+	{"age", ""},
+	{"allow", ""},
+	{"authorization", ""},
+	{"cache-control", ""},
+	{"content-disposition", ""},
+	{"content-encoding", ""},
+	{"content-language", ""},
+	{"content-length", ""},
+	{"content-location", ""},
+	{"content-range", ""},
+	{"content-type", ""},
+	{"cookie", ""},
+	{"date", ""},
+	{"etag", ""},
+	{"expect", ""},
+	{"expires", ""},
+	{"from", ""},
+	{"host", ""},
+	{"if-match", ""},
+	{"if-modified-since", ""},
+	{"if-none-match", ""},
+	{"if-range", ""},
+	{"if-unmodified-since", ""},
+	{"last-modified", ""},
+	{"link", ""},
+	{"location", ""},
+	{"max-forwards", ""},
+	{"proxy-authenticate", ""},
+	{"proxy-authorization", ""},
+	{"range", ""},
+	{"referer", ""},
+	{"refresh", ""},
+	{"retry-after", ""},
+	{"server", ""},
+	{"set-cookie", ""},
+	{"strict-transport-security", ""},
+	{"transfer-encoding", ""},
+	{"user-agent", ""},
+	{"vary", ""},
+	{"via", ""},
+	{"www-authenticate", ""},
+};
+
+constexpr size_t staticTableSize = std::size(staticTable);
+
+// RFC 7541 Appendix B, indexed by symbol (256 is EOS)
+static constexpr struct {
+	uint32_t code;
+	uint8_t bits;
+} huffmanCodes[257] = {
+	{0x1ff8, 13}, {0x7fffd8, 23}, {0xfffffe2, 28}, {0xfffffe3, 28},
+	{0xfffffe4, 28}, {0xfffffe5, 28}, {0xfffffe6, 28}, {0xfffffe7, 28},
+	{0xfffffe8, 28}, {0xffffea, 24}, {0x3ffffffc, 30}, {0xfffffe9, 28},
+	{0xfffffea, 28}, {0x3ffffffd, 30}, {0xfffffeb, 28}, {0xfffffec, 28},
+	{0xfffffed, 28}, {0xfffffee, 28}, {0xfffffef, 28}, {0xffffff0, 28},
+	{0xffffff1, 28}, {0xffffff2, 28}, {0x3ffffffe, 30}, {0xffffff3, 28},
+	{0xffffff4, 28}, {0xffffff5, 28}, {0xffffff6, 28}, {0xffffff7, 28},
+	{0xffffff8, 28}, {0xffffff9, 28}, {0xffffffa, 28}, {0xffffffb, 28},
+	{0x14, 6}, {0x3f8, 10}, {0x3f9, 10}, {0xffa, 12},
+	{0x1ff9, 13}, {0x15, 6}, {0xf8, 8}, {0x7fa, 11},
+	{0x3fa, 10}, {0x3fb, 10}, {0xf9, 8}, {0x7fb, 11},
+	{0xfa, 8}, {0x16, 6}, {0x17, 6}, {0x18, 6},
+	{0x0, 5}, {0x1, 5}, {0x2, 5}, {0x19, 6},
+	{0x1a, 6}, {0x1b, 6}, {0x1c, 6}, {0x1d, 6},
+	{0x1e, 6}, {0x1f, 6}, {0x5c, 7}, {0xfb, 8},
+	{0x7ffc, 15}, {0x20, 6}, {0xffb, 12}, {0x3fc, 10},
+	{0x1ffa, 13}, {0x21, 6}, {0x5d, 7}, {0x5e, 7},
+	{0x5f, 7}, {0x60, 7}, {0x61, 7}, {0x62, 7},
+	{0x63, 7}, {0x64, 7}, {0x65, 7}, {0x66, 7},
+	{0x67, 7}, {0x68, 7}, {0x69, 7}, {0x6a, 7},
+	{0x6b, 7}, {0x6c, 7}, {0x6d, 7}, {0x6e, 7},
+	{0x6f, 7}, {0x70, 7}, {0x71, 7}, {0x72, 7},
+	{0xfc, 8}, {0x73, 7}, {0xfd, 8}, {0x1ffb, 13},
+	{0x7fff0, 19}, {0x1ffc, 13}, {0x3ffc, 14}, {0x22, 6},
+	{0x7ffd, 15}, {0x3, 5}, {0x23, 6}, {0x4, 5},
+	{0x24, 6}, {0x5, 5}, {0x25, 6}, {0x26, 6},
+	{0x27, 6}, {0x6, 5}, {0x74, 7}, {0x75, 7},
+	{0x28, 6}, {0x29, 6}, {0x2a, 6}, {0x7, 5},
+	{0x2b, 6}, {0x76, 7}, {0x2c, 6}, {0x8, 5},
+	{0x9, 5}, {0x2d, 6}, {0x77, 7}, {0x78, 7},
+	{0x79, 7}, {0x7a, 7}, {0x7b, 7}, {0x7ffe, 15},
+	{0x7fc, 11}, {0x3ffd, 14}, {0x1ffd, 13}, {0xffffffc, 28},
+	{0xfffe6, 20}, {0x3fffd2, 22}, {0xfffe7, 20}, {0xfffe8, 20},
+	{0x3fffd3, 22}, {0x3fffd4, 22}, {0x3fffd5, 22}, {0x7fffd9, 23},
+	{0x3fffd6, 22}, {0x7fffda, 23}, {0x7fffdb, 23}, {0x7fffdc, 23},
+	{0x7fffdd, 23}, {0x7fffde, 23}, {0xffffeb, 24}, {0x7fffdf, 23},
+	{0xffffec, 24}, {0xffffed, 24}, {0x3fffd7, 22}, {0x7fffe0, 23},
+	{0xffffee, 24}, {0x7fffe1, 23}, {0x7fffe2, 23}, {0x7fffe3, 23},
+	{0x7fffe4, 23}, {0x1fffdc, 21}, {0x3fffd8, 22}, {0x7fffe5, 23},
+	{0x3fffd9, 22}, {0x7fffe6, 23}, {0x7fffe7, 23}, {0xffffef, 24},
+	{0x3fffda, 22}, {0x1fffdd, 21}, {0xfffe9, 20}, {0x3fffdb, 22},
+	{0x3fffdc, 22}, {0x7fffe8, 23}, {0x7fffe9, 23}, {0x1fffde, 21},
+	{0x7fffea, 23}, {0x3fffdd, 22}, {0x3fffde, 22}, {0xfffff0, 24},
+	{0x1fffdf, 21}, {0x3fffdf, 22}, {0x7fffeb, 23}, {0x7fffec, 23},
+	{0x1fffe0, 21}, {0x1fffe1, 21}, {0x3fffe0, 22}, {0x1fffe2, 21},
+	{0x7fffed, 23}, {0x3fffe1, 22}, {0x7fffee, 23}, {0x7fffef, 23},
+	{0xfffea, 20}, {0x3fffe2, 22}, {0x3fffe3, 22}, {0x3fffe4, 22},
+	{0x7ffff0, 23}, {0x3fffe5, 22}, {0x3fffe6, 22}, {0x7ffff1, 23},
+	{0x3ffffe0, 26}, {0x3ffffe1, 26}, {0xfffeb, 20}, {0x7fff1, 19},
+	{0x3fffe7, 22}, {0x7ffff2, 23}, {0x3fffe8, 22}, {0x1ffffec, 25},
+	{0x3ffffe2, 26}, {0x3ffffe3, 26}, {0x3ffffe4, 26}, {0x7ffffde, 27},
+	{0x7ffffdf, 27}, {0x3ffffe5, 26}, {0xfffff1, 24}, {0x1ffffed, 25},
+	{0x7fff2, 19}, {0x1fffe3, 21}, {0x3ffffe6, 26}, {0x7ffffe0, 27},
+	{0x7ffffe1, 27}, {0x3ffffe7, 26}, {0x7ffffe2, 27}, {0xfffff2, 24},
+	{0x1fffe4, 21}, {0x1fffe5, 21}, {0x3ffffe8, 26}, {0x3ffffe9, 26},
+	{0xffffffd, 28}, {0x7ffffe3, 27}, {0x7ffffe4, 27}, {0x7ffffe5, 27},
+	{0xfffec, 20}, {0xfffff3, 24}, {0xfffed, 20}, {0x1fffe6, 21},
+	{0x3fffe9, 22}, {0x1fffe7, 21}, {0x1fffe8, 21}, {0x7ffff3, 23},
+	{0x3fffea, 22}, {0x3fffeb, 22}, {0x1ffffee, 25}, {0x1ffffef, 25},
+	{0xfffff4, 24}, {0xfffff5, 24}, {0x3ffffea, 26}, {0x7ffff4, 23},
+	{0x3ffffeb, 26}, {0x7ffffe6, 27}, {0x3ffffec, 26}, {0x3ffffed, 26},
+	{0x7ffffe7, 27}, {0x7ffffe8, 27}, {0x7ffffe9, 27}, {0x7ffffea, 27},
+	{0x7ffffeb, 27}, {0xffffffe, 28}, {0x7ffffec, 27}, {0x7ffffed, 27},
+	{0x7ffffee, 27}, {0x7ffffef, 27}, {0x7fffff0, 27}, {0x3ffffee, 26},
+	{0x3fffffff, 30},
+};
+
+// The code is canonical: codes of the same length are consecutive in symbol order, so decoding only needs the first
+// code of each length and the symbols sorted by (length, symbol)
+struct huffmanDecodeTable {
+	uint32_t firstCode[31] = {};
+	uint16_t firstIndex[31] = {};
+	uint16_t count[31] = {};
+	uint16_t symbols[257] = {};
+
+	constexpr huffmanDecodeTable() {
+		size_t index = 0;
+		uint32_t code = 0;
+
+		for (uint8_t bits = 1; bits <= 30; bits++) {
+			firstCode[bits] = code;
+			firstIndex[bits] = index;
+
+			for (uint16_t symbol = 0; symbol < 257; symbol++) {
+				if (huffmanCodes[symbol].bits == bits) {
+					symbols[index++] = symbol;
+					count[bits]++;
+				}
+			}
+
+			code = (code + count[bits]) << 1;
+		}
+	}
+};
+
+static constexpr huffmanDecodeTable huffmanDecoding;
+
+static bool huffmanDecode(std::string_view input, std::string &output) {
+	uint32_t code = 0;
+	uint8_t bits = 0;
+
+	for (const unsigned char byte : input) {
+		for (int bit = 7; bit >= 0; bit--) {
+			code = (code << 1) | ((byte >> bit) & 1);
+			bits++;
+
+			if (code - huffmanDecoding.firstCode[bits] < huffmanDecoding.count[bits]) {
+				const uint16_t symbol =
+					huffmanDecoding.symbols[huffmanDecoding.firstIndex[bits] + code - huffmanDecoding.firstCode[bits]];
+				if (symbol == 256) // EOS must not appear in a string literal
+					return false;
+
+				output += static_cast<char>(symbol);
+				code = 0;
+				bits = 0;
+			} else if (bits == 30) {
+				return false;
+			}
+		}
+	}
+
+	// padding is at most 7 bits, all of them ones (the most significant bits of EOS)
+	return bits <= 7 && code == (1u << bits) - 1;
+}
+
+static size_t huffmanEncodedLength(std::string_view input) {
+	size_t bits = 0;
+	for (const unsigned char c : input)
+		bits += huffmanCodes[c].bits;
+	return (bits + 7) / 8;
+}
+
+static void huffmanEncode(std::string_view input, std::string &output) {
+	uint64_t buffer = 0;
+	int bits = 0;
+
+	for (const unsigned char c : input) {
+		buffer = (buffer << huffmanCodes[c].bits) | huffmanCodes[c].code;
+		bits += huffmanCodes[c].bits;
+
+		while (bits >= 8) {
+			bits -= 8;
+			output += static_cast<char>(buffer >> bits);
+		}
+	}
+
+	if (bits > 0) // pad with the most significant bits of EOS
+		output += static_cast<char>((buffer << (8 - bits)) | (0xff >> bits));
+}
+
+static void encodeInteger(uint64_t value, uint8_t prefixBits, uint8_t flags, std::string &output) {
+	const uint64_t max = (1u << prefixBits) - 1;
+
+	if (value < max) {
+		output += static_cast<char>(flags | value);
+		return;
+	}
+
+	output += static_cast<char>(flags | max);
+	value -= max;
+	while (value >= 128) {
+		output += static_cast<char>((value & 0x7f) | 0x80);
+		value >>= 7;
+	}
+	output += static_cast<char>(value);
+}
+
+static bool decodeInteger(std::string_view &input, uint8_t prefixBits, uint64_t &value) {
+	if (input.empty())
+		return false;
+
+	const uint64_t max = (1u << prefixBits) - 1;
+	value = static_cast<unsigned char>(input[0]) & max;
+	input.remove_prefix(1);
+
+	if (value < max)
+		return true;
+
+	for (int shift = 0; shift <= 28; shift += 7) { // larger values than 2^28 are never legitimate
+		if (input.empty())
+			return false;
+
+		const unsigned char byte = input[0];
+		input.remove_prefix(1);
+
+		value += static_cast<uint64_t>(byte & 0x7f) << shift;
+		if (!(byte & 0x80))
+			return true;
+	}
+
+	return false;
+}
+
+static void encodeString(std::string_view value, std::string &output) {
+	const size_t huffmanLength = huffmanEncodedLength(value);
+
+	if (huffmanLength < value.length()) {
+		encodeInteger(huffmanLength, 7, 0x80, output);
+		huffmanEncode(value, output);
+	} else {
+		encodeInteger(value.length(), 7, 0x00, output);
+		output += value;
+	}
+}
+
+static bool decodeString(std::string_view &input, std::string &output) {
+	if (input.empty())
+		return false;
+
+	const bool huffman = input[0] & 0x80;
+
+	uint64_t length;
+	if (!decodeInteger(input, 7, length) || length > input.length())
+		return false;
+
+	const std::string_view encoded = input.substr(0, length);
+	input.remove_prefix(length);
+
+	if (huffman)
+		return huffmanDecode(encoded, output);
+
+	output = encoded;
+	return true;
+}
+
+// table
+
+static size_t entrySize(const std::pair<std::string, std::string> &entry) {
+	return entry.first.length() + entry.second.length() + 32;
+}
+
+const std::pair<std::string, std::string> *table::get(size_t index) const {
+	if (index == 0)
+		return nullptr;
+	if (index <= staticTableSize)
+		return &staticTable[index - 1];
+	if (index - staticTableSize <= _entries.size())
+		return &_entries[index - staticTableSize - 1];
+	return nullptr;
+}
+
+size_t table::find(std::string_view name, std::string_view value, bool &valueMatches) const {
+	size_t nameIndex = 0;
+	valueMatches = false;
+
+	for (size_t i = 0; i < staticTableSize; i++) {
+		if (staticTable[i].first == name) {
+			if (staticTable[i].second == value) {
+				valueMatches = true;
+				return i + 1;
+			}
+			if (!nameIndex)
+				nameIndex = i + 1;
+		}
+	}
+
+	for (size_t i = 0; i < _entries.size(); i++) {
+		if (_entries[i].first == name) {
+			if (_entries[i].second == value) {
+				valueMatches = true;
+				return staticTableSize + i + 1;
+			}
+			if (!nameIndex)
+				nameIndex = staticTableSize + i + 1;
+		}
+	}
+
+	return nameIndex;
+}
+
+void table::insert(std::string name, std::string value) {
+	std::pair<std::string, std::string> entry(std::move(name), std::move(value));
+	const size_t size = entrySize(entry);
+
+	if (size > _maxSize) { // an entry larger than the table empties it
+		_entries.clear();
+		_size = 0;
+		return;
+	}
+
+	evict(_maxSize - size);
+	_entries.push_front(std::move(entry));
+	_size += size;
+}
+
+void table::resize(size_t maxSize) {
+	_maxSize = maxSize;
+	evict(maxSize);
+}
+
+size_t table::maxSize() const {
+	return _maxSize;
+}
+
+void table::evict(size_t sizeToFit) {
+	while (_size > sizeToFit) {
+		_size -= entrySize(_entries.back());
+		_entries.pop_back();
+	}
+}
+
+// decoder
+
+bool decoder::decode(std::string_view block, header_list &headers, bool &tooLarge) {
+	bool headerSeen = false;
+	size_t listSize = 0;
+	tooLarge = false;
+
+	// an indexed reference costs one byte but copies a whole entry, so the list is bounded by what it expands to
+	auto add = [&](auto &&header) {
+		listSize += header.first.length() + header.second.length() + 32;
+		if (tooLarge || listSize > _maxListSize || headers.size() >= _maxListCount) {
+			tooLarge = true;
+			return;
+		}
+		headers.push_back(std::forward<decltype(header)>(header));
+	};
+
+	while (!block.empty()) {
+		const unsigned char first = block[0];
+		uint64_t index;
+
+		if (first & 0x80) { // indexed header field
+			if (!decodeInteger(block, 7, index))
+				return false;
+
+			const auto *entry = _table.get(index);
+			if (!entry)
+				return false;
+
+			add(*entry);
+			headerSeen = true;
+		} else if ((first & 0xe0) == 0x20) { // dynamic table size update, only allowed before the first header
+			if (headerSeen || !decodeInteger(block, 5, index) || index > _maxTableSize)
+				return false;
+
+			_table.resize(index);
+		} else { // literal header field, with incremental indexing (01), without indexing (0000) or never indexed (0001)
+			const bool indexing = (first & 0xc0) == 0x40;
+
+			if (!decodeInteger(block, indexing ? 6 : 4, index))
+				return false;
+
+			std::pair<std::string, std::string> header;
+			if (index) {
+				const auto *entry = _table.get(index);
+				if (!entry)
+					return false;
+				header.first = entry->first;
+			} else if (!decodeString(block, header.first)) {
+				return false;
+			}
+
+			if (!decodeString(block, header.second))
+				return false;
+
+			if (indexing)
+				_table.insert(header.first, header.second);
+
+			add(std::move(header));
+			headerSeen = true;
+		}
+	}
+
+	return true;
+}
+
+void decoder::setMaxTableSize(size_t maxSize) {
+	_maxTableSize = maxSize;
+}
+
+void decoder::setMaxHeaderList(size_t size, size_t count) {
+	_maxListSize = size;
+	_maxListCount = count;
+}
+
+// encoder
+
+void encoder::encode(std::string_view name, std::string_view value, std::string &block) {
+	bool valueMatches;
+	const size_t index = _table.find(name, value, valueMatches);
+
+	if (valueMatches) {
+		encodeInteger(index, 7, 0x80, block);
+		return;
+	}
+
+	// values that change with every response would only churn the table
+	const bool indexing = name != "content-length" && name != "date";
+
+	if (indexing) {
+		encodeInteger(index, 6, 0x40, block);
+	} else {
+		encodeInteger(index, 4, 0x00, block);
+	}
+
+	if (!index)
+		encodeString(name, block);
+	encodeString(value, block);
+
+	if (indexing)
+		_table.insert(std::string(name), std::string(value));
+}
+
+void encoder::beginBlock(std::string &block) {
+	if (_resized) {
+		encodeInteger(_table.maxSize(), 5, 0x20, block);
+		_resized = false;
+	}
+}
+
+void encoder::setMaxTableSize(size_t maxSize) {
+	maxSize = std::min<size_t>(maxSize, 4096); // never use more than the default, even if the peer allows it
+	if (maxSize != _table.maxSize()) {
+		_table.resize(maxSize);
+		_resized = true;
+	}
+}
+
+} // namespace hpack
+
+} // namespace http
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace http {
+
+// Header compression for HTTP/2 (RFC 7541)
+namespace hpack {
+
+using header_list = std::vector<std::pair<std::string, std::string>>;
+
+// Static table (indices 1-61) followed by the dynamic table, newest entry first
+class table {
+  public:
+	const std::pair<std::string, std::string> *get(size_t index) const; // nullptr if out of range
+
+	// Index of an entry with this name and value, or failing that of one with this name, 0 if there is none
+	size_t find(std::string_view name, std::string_view value, bool &valueMatches) const;
+
+	void insert(std::string name, std::string value);
+	void resize(size_t maxSize);
+
+	size_t maxSize() const;
+
+  private:
+	void evict(size_t sizeToFit);
+
+	std::deque<std::pair<std::string, std::string>> _entries;
+	size_t _size = 0;
+	size_t _maxSize = 4096;
+}; // table
+
+class decoder {
+  public:
+	// Decodes one complete header block, returns false on a compression error. Headers past the list limits are still
+	// decoded, so the dynamic table stays in sync, but dropped and tooLarge is set.
+	bool decode(std::string_view block, header_list &headers, bool &tooLarge);
+
+	void setMaxTableSize(size_t maxSize); // our SETTINGS_HEADER_TABLE_SIZE
+	// size as in SETTINGS_MAX_HEADER_LIST_SIZE (name, value and 32 bytes per header), both unlimited by default
+	void setMaxHeaderList(size_t size, size_t count);
+
+  private:
+	table _table;
+	size_t _maxTableSize = 4096;
+	size_t _maxListSize = SIZE_MAX;
+	size_t _maxListCount = SIZE_MAX;
+}; // decoder
+
+class encoder {
+  public:
+	void encode(std::string_view name, std::string_view value, std::string &block); // name must be lowercase
+	void beginBlock(std::string &block); // emits a pending table size update
+
+	void setMaxTableSize(size_t maxSize); // the peer's SETTINGS_HEADER_TABLE_SIZE
+
+  private:
+	table _table;
+	bool _resized = false;
+}; // encoder
+
+} // namespace hpack
+
+} // namespace http
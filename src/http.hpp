@@ -5,7 +5,27 @@
 #include "url.hpp"
 #include "method.hpp"
 #include "content_type.hpp"
+#include "status.hpp"
+#include "headers.hpp"
+#include "pool.hpp"
+#include "mapped_file.hpp"
+#include "accounting.hpp"
 #include "response.hpp"
 #include "request.hpp"
+#include "cache.hpp"
+#include "single_flight.hpp"
+#include "rate_limit.hpp"
+#include "http2.hpp"
+#include "websocket.hpp"
+#include "sse.hpp"
+#include "proxy.hpp"
+#include "multipart.hpp"
+#include "pipeline.hpp"
+#include "bundle.hpp"
 #include "host.hpp"
+#include "listener.hpp"
+#include "handler_pool.hpp"
+#include "access_log.hpp"
+#include "capture.hpp"
+#include "profiler.hpp"
 #include "server.hpp"
\ No newline at end of file
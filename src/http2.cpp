@@ -0,0 +1,751 @@
+#include "http2.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <unordered_map>
+
+// OS-SPECIFIC INCLUDES TODO: CHANGE WHEN IMPLEMENTING CROSS-PLATFORM SUPPORT
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+
+#include "io.hpp"
+#include "log.hpp"
+
+using namespace std::string_literals;
+
+namespace http {
+
+namespace frame_type {
+constexpr uint8_t DATA = 0x0, HEADERS = 0x1, PRIORITY = 0x2, RST_STREAM = 0x3, SETTINGS = 0x4, PUSH_PROMISE = 0x5,
+				  PING = 0x6, GOAWAY = 0x7, WINDOW_UPDATE = 0x8, CONTINUATION = 0x9;
+} // namespace frame_type
+
+namespace flag {
+constexpr uint8_t END_STREAM = 0x1, ACK = 0x1, END_HEADERS = 0x4, PADDED = 0x8, PRIORITY = 0x20;
+} // namespace flag
+
+namespace error_code {
+constexpr uint32_t NO_ERROR = 0x0, PROTOCOL_ERROR = 0x1, INTERNAL_ERROR = 0x2, FLOW_CONTROL_ERROR = 0x3,
+				   STREAM_CLOSED = 0x5, FRAME_SIZE_ERROR = 0x6, REFUSED_STREAM = 0x7, COMPRESSION_ERROR = 0x9,
+				   ENHANCE_YOUR_CALM = 0xb;
+} // namespace error_code
+
+namespace setting {
+constexpr uint16_t HEADER_TABLE_SIZE = 0x1, MAX_CONCURRENT_STREAMS = 0x3, INITIAL_WINDOW_SIZE = 0x4,
+				   MAX_FRAME_SIZE = 0x5, MAX_HEADER_LIST_SIZE = 0x6;
+} // namespace setting
+
+constexpr uint32_t maxFrameSize = 16384;		  // we never raise SETTINGS_MAX_FRAME_SIZE
+constexpr uint32_t maxConcurrentStreams = 100;	  // open, not yet answered streams
+constexpr uint32_t initialWindowSize = 1 << 20;	  // per stream, credit is returned as data is read
+constexpr int64_t maxWindowSize = (1u << 31) - 1;
+constexpr size_t pseudoHeaderCount = 4;			  // :method, :scheme, :authority and :path
+
+struct connection_error {
+	uint32_t code;
+};
+
+static uint32_t readUint32(std::string_view bytes) {
+	return (static_cast<uint32_t>(static_cast<unsigned char>(bytes[0])) << 24) |
+		   (static_cast<uint32_t>(static_cast<unsigned char>(bytes[1])) << 16) |
+		   (static_cast<uint32_t>(static_cast<unsigned char>(bytes[2])) << 8) |
+		   static_cast<uint32_t>(static_cast<unsigned char>(bytes[3]));
+}
+
+static void appendUint32(std::string &bytes, uint32_t value) {
+	bytes += static_cast<char>(value >> 24);
+	bytes += static_cast<char>(value >> 16);
+	bytes += static_cast<char>(value >> 8);
+	bytes += static_cast<char>(value);
+}
+
+static void appendSetting(std::string &bytes, uint16_t id, uint32_t value) {
+	bytes += static_cast<char>(id >> 8);
+	bytes += static_cast<char>(id);
+	appendUint32(bytes, value);
+}
+
+static std::string base64UrlDecode(std::string_view input) {
+	std::string output;
+	uint32_t buffer = 0;
+	int bits = 0;
+
+	for (const char c : input) {
+		int value;
+		if (c >= 'A' && c <= 'Z') {
+			value = c - 'A';
+		} else if (c >= 'a' && c <= 'z') {
+			value = c - 'a' + 26;
+		} else if (c >= '0' && c <= '9') {
+			value = c - '0' + 52;
+		} else if (c == '-' || c == '+') {
+			value = 62;
+		} else if (c == '_' || c == '/') {
+			value = 63;
+		} else {
+			continue; // padding
+		}
+
+		buffer = (buffer << 6) | value;
+		bits += 6;
+		if (bits >= 8) {
+			bits -= 8;
+			output += static_cast<char>(buffer >> bits);
+		}
+	}
+
+	return output;
+}
+
+// Connection-specific headers are not allowed in HTTP/2
+static bool isConnectionSpecific(std::string_view name) {
+	return name == "connection" || name == "keep-alive" || name == "proxy-connection" ||
+		   name == "transfer-encoding" || name == "upgrade";
+}
+
+// The limit of SETTINGS_MAX_HEADER_LIST_SIZE, which also bounds the encoded header block
+static size_t maxHeaderListSize(const http2_connection::limits &limits) {
+	return limits.headerBytes + 32 * (limits.headerCount + pseudoHeaderCount);
+}
+
+http2_connection::http2_connection(int clientfd, dispatchCallbackType dispatch, const limits &limits,
+								   unsigned idleTimeoutSeconds, unsigned lifetimeSeconds)
+	: _clientfd(clientfd), _dispatch(dispatch), _limits(limits), _idleTimeoutMs(idleTimeoutSeconds * 1000),
+	  _deadline(std::chrono::steady_clock::now() + std::chrono::seconds(lifetimeSeconds)) {
+	// frames are small and written one at a time, Nagle would hold them back until the peer acknowledges
+	int one = 1;
+	setsockopt(_clientfd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+	_decoder.setMaxHeaderList(maxHeaderListSize(_limits), _limits.headerCount + pseudoHeaderCount);
+}
+
+void http2_connection::serve(std::string_view received) {
+	_input = received;
+
+	try {
+		if (!fill(preface.length()) || std::string_view(_input).substr(0, preface.length()) != preface)
+			return;
+		_inputPos = preface.length();
+
+		run();
+	} catch (const connection_error &error) {
+		goAway(error.code);
+	}
+}
+
+void http2_connection::serveUpgrade(method method, const url &url, const request_headers &headers,
+									std::string_view settings) {
+	try {
+		applySettings(base64UrlDecode(settings));
+
+		// stream 1 is the upgraded request, half-closed on the client side
+		_lastStreamId = 1;
+		_streams[1] = {{}, {}, _peerInitialWindowSize, initialWindowSize, true};
+
+		// the server preface has to precede the response, the client preface only arrives after the 101
+		sendSettings();
+
+		if (!fill(preface.length()) || std::string_view(_input).substr(0, preface.length()) != preface)
+			return;
+		_inputPos = preface.length();
+
+		const std::unordered_map<std::string, std::string> payload;
+		request req(-1, method, url, headers, payload);
+		dispatchRequest(req, 1, method == method::HEAD);
+		closeStream(1);
+
+		if (_error)
+			throw connection_error{_error};
+
+		run(false);
+	} catch (const connection_error &error) {
+		goAway(error.code);
+	}
+}
+
+void http2_connection::run(bool sendPreface) {
+	if (sendPreface)
+		sendSettings();
+
+	// the connection window bounds what all streams buffer together, one body may use all of it
+	const int64_t connectionWindow = std::clamp<int64_t>(_limits.bodySize, 65535, maxWindowSize);
+	if (connectionWindow > 65535)
+		returnCredit(connectionWindow - 65535);
+
+	while (!_closed) {
+		if (!_ready.empty()) {
+			const uint32_t streamId = _ready.front();
+			_ready.pop_front();
+			dispatchStream(streamId);
+
+			if (_error)
+				throw connection_error{_error};
+			continue;
+		}
+
+		if ((_peerGoingAway || _goingAway) && _streams.empty())
+			break;
+
+		if (!_goingAway && std::chrono::steady_clock::now() >= _deadline) {
+			// a busy connection never goes idle, the client is asked to reconnect behind those waiting to be accepted
+			writeGoAway(error_code::NO_ERROR);
+			_goingAway = true;
+			continue;
+		}
+
+		frame frame;
+		if (!readFrame(frame))
+			break;
+		processFrame(frame);
+	}
+
+	goAway(error_code::NO_ERROR);
+}
+
+void http2_connection::sendSettings() {
+	std::string payload;
+	appendSetting(payload, setting::MAX_CONCURRENT_STREAMS, maxConcurrentStreams);
+	appendSetting(payload, setting::INITIAL_WINDOW_SIZE, initialWindowSize);
+	appendSetting(payload, setting::MAX_HEADER_LIST_SIZE,
+				  static_cast<uint32_t>(std::min<size_t>(maxHeaderListSize(_limits), UINT32_MAX)));
+	writeFrame(frame_type::SETTINGS, 0, 0, payload);
+}
+
+bool http2_connection::fill(size_t length) {
+	if (_inputPos > 0 && _inputPos == _input.length()) {
+		_input.clear();
+		_inputPos = 0;
+	} else if (_inputPos > 65536) {
+		_input.erase(0, _inputPos);
+		_inputPos = 0;
+	}
+
+	while (_input.length() - _inputPos < length) {
+		int timeout = _idleTimeoutMs;
+		if (_goingAway) { // the open streams get one idle timeout past the deadline, however busy the client is
+			const auto left = std::chrono::duration_cast<std::chrono::milliseconds>(
+				_deadline - std::chrono::steady_clock::now() + std::chrono::milliseconds(_idleTimeoutMs));
+			timeout = std::min<int64_t>(timeout, left.count());
+			if (timeout <= 0)
+				return false;
+		}
+
+		pollfd pfd = {_clientfd, POLLIN, 0};
+		const int ready = poll(&pfd, 1, timeout);
+		if (ready < 0 && errno == EINTR)
+			continue;
+		if (ready <= 0) // idle for too long
+			return false;
+
+		char buffer[16384];
+		const ssize_t bytesread = recv(_clientfd, buffer, sizeof(buffer), 0);
+		if (bytesread <= 0)
+			return false;
+
+		_input.append(buffer, bytesread);
+	}
+
+	return true;
+}
+
+bool http2_connection::readFrame(frame &frame) {
+	constexpr size_t headerLength = 9;
+
+	if (!fill(headerLength))
+		return false;
+
+	const uint32_t length = readUint32(std::string_view(_input).substr(_inputPos, headerLength)) >> 8;
+
+	if (length > maxFrameSize)
+		throw connection_error{error_code::FRAME_SIZE_ERROR};
+
+	if (!fill(headerLength + length))
+		return false;
+
+	// fill may have moved the input
+	const std::string_view header = std::string_view(_input).substr(_inputPos, headerLength);
+	frame.type = header[3];
+	frame.flags = header[4];
+	frame.streamId = readUint32(header.substr(5)) & 0x7fffffff;
+	frame.payload = std::string_view(_input).substr(_inputPos + headerLength, length);
+
+	_inputPos += headerLength + length;
+	return true;
+}
+
+void http2_connection::processFrame(const frame &frame) {
+	if (_headerBlockStream && (frame.type != frame_type::CONTINUATION || frame.streamId != _headerBlockStream))
+		throw connection_error{error_code::PROTOCOL_ERROR};
+
+	std::string_view payload = frame.payload;
+
+	auto stripPadding = [&]() {
+		if (!(frame.flags & flag::PADDED))
+			return;
+		if (payload.empty() || static_cast<unsigned char>(payload[0]) >= payload.length())
+			throw connection_error{error_code::PROTOCOL_ERROR};
+		const size_t padding = static_cast<unsigned char>(payload[0]);
+		payload = payload.substr(1, payload.length() - 1 - padding);
+	};
+
+	switch (frame.type) {
+		case frame_type::DATA: {
+			if (frame.streamId == 0 || frame.streamId > _lastStreamId) // idle streams
+				throw connection_error{error_code::PROTOCOL_ERROR};
+
+			// the whole frame counts against flow control
+			_receiveWindow -= frame.payload.length();
+			if (_receiveWindow < 0)
+				throw connection_error{error_code::FLOW_CONTROL_ERROR};
+
+			auto it = _streams.find(frame.streamId);
+			if (it == _streams.end() || it->second.complete) { // refused, reset or answered
+				returnCredit(frame.payload.length());
+				// frames the client sent before it saw our RST_STREAM are ignored, not answered with another one
+				if (std::find(_resetStreams.begin(), _resetStreams.end(), frame.streamId) == _resetStreams.end())
+					resetStream(frame.streamId, error_code::STREAM_CLOSED);
+				break;
+			}
+
+			// the connection's credit comes back when the stream closes
+			it->second.received += frame.payload.length();
+			it->second.receiveWindow -= frame.payload.length();
+			if (it->second.receiveWindow < 0) {
+				resetStream(frame.streamId, error_code::FLOW_CONTROL_ERROR);
+				break;
+			}
+
+			stripPadding();
+
+			if (it->second.body.length() + payload.length() > _limits.bodySize) {
+				rejectStream(frame.streamId, 413);
+				break;
+			}
+			it->second.body += payload;
+
+			if (!frame.payload.empty() && !(frame.flags & flag::END_STREAM)) {
+				std::string increment;
+				appendUint32(increment, frame.payload.length());
+				writeFrame(frame_type::WINDOW_UPDATE, 0, frame.streamId, increment);
+				it->second.receiveWindow += frame.payload.length();
+			}
+
+			if (frame.flags & flag::END_STREAM) {
+				it->second.complete = true;
+				_ready.push_back(frame.streamId);
+			}
+			break;
+		}
+		case frame_type::HEADERS: {
+			if (frame.streamId == 0 || frame.streamId % 2 == 0)
+				throw connection_error{error_code::PROTOCOL_ERROR};
+
+			stripPadding();
+			if (frame.flags & flag::PRIORITY) {
+				if (payload.length() < 5)
+					throw connection_error{error_code::PROTOCOL_ERROR};
+				payload.remove_prefix(5);
+			}
+
+			if (payload.length() > maxHeaderListSize(_limits)) // too large to keep the decoder in sync
+				throw connection_error{error_code::ENHANCE_YOUR_CALM};
+
+			_headerBlock = payload;
+			_headerBlockEndStream = frame.flags & flag::END_STREAM;
+
+			if (frame.flags & flag::END_HEADERS) {
+				processHeaderBlock(frame.streamId, _headerBlockEndStream);
+			} else {
+				_headerBlockStream = frame.streamId;
+			}
+			break;
+		}
+		case frame_type::CONTINUATION: {
+			if (!_headerBlockStream)
+				throw connection_error{error_code::PROTOCOL_ERROR};
+
+			if (_headerBlock.length() + payload.length() > maxHeaderListSize(_limits))
+				throw connection_error{error_code::ENHANCE_YOUR_CALM};
+
+			_headerBlock += payload;
+
+			if (frame.flags & flag::END_HEADERS) {
+				_headerBlockStream = 0;
+				processHeaderBlock(frame.streamId, _headerBlockEndStream);
+			}
+			break;
+		}
+		case frame_type::RST_STREAM: {
+			if (frame.streamId == 0 || payload.length() != 4)
+				throw connection_error{error_code::PROTOCOL_ERROR};
+
+			closeStream(frame.streamId);
+			break;
+		}
+		case frame_type::SETTINGS: {
+			if (frame.streamId != 0)
+				throw connection_error{error_code::PROTOCOL_ERROR};
+
+			if (frame.flags & flag::ACK)
+				break;
+
+			applySettings(payload);
+			writeFrame(frame_type::SETTINGS, flag::ACK, 0, {});
+			break;
+		}
+		case frame_type::PING: {
+			if (frame.streamId != 0 || payload.length() != 8)
+				throw connection_error{error_code::PROTOCOL_ERROR};
+
+			if (!(frame.flags & flag::ACK))
+				writeFrame(frame_type::PING, flag::ACK, 0, payload);
+			break;
+		}
+		case frame_type::GOAWAY: {
+			_peerGoingAway = true;
+			break;
+		}
+		case frame_type::WINDOW_UPDATE: {
+			if (payload.length() != 4)
+				throw connection_error{error_code::FRAME_SIZE_ERROR};
+
+			const uint32_t increment = readUint32(payload) & 0x7fffffff;
+
+			if (frame.streamId == 0) {
+				if (increment == 0 || _sendWindow + increment > maxWindowSize)
+					throw connection_error{error_code::FLOW_CONTROL_ERROR};
+				_sendWindow += increment;
+			} else if (auto it = _streams.find(frame.streamId); it != _streams.end()) {
+				if (increment == 0 || it->second.sendWindow + increment > maxWindowSize) {
+					resetStream(frame.streamId, error_code::FLOW_CONTROL_ERROR);
+				} else {
+					it->second.sendWindow += increment;
+				}
+			}
+			break;
+		}
+		case frame_type::PUSH_PROMISE: // clients must not push
+			throw connection_error{error_code::PROTOCOL_ERROR};
+		case frame_type::PRIORITY: // advisory, requests are answered in order of completion
+		default:				   // unknown frame types are ignored
+			break;
+	}
+}
+
+void http2_connection::processHeaderBlock(uint32_t streamId, bool endStream) {
+	hpack::header_list headers;
+	bool tooLarge;
+	if (!_decoder.decode(_headerBlock, headers, tooLarge))
+		throw connection_error{error_code::COMPRESSION_ERROR};
+
+	auto it = _streams.find(streamId);
+
+	if (it != _streams.end()) { // trailers, only accepted to end the request body
+		if (it->second.complete || !endStream)
+			throw connection_error{error_code::PROTOCOL_ERROR};
+		it->second.complete = true;
+
+		if (tooLarge) {
+			rejectStream(streamId, 431);
+		} else {
+			_ready.push_back(streamId);
+		}
+		return;
+	}
+
+	if (streamId <= _lastStreamId)
+		throw connection_error{error_code::STREAM_CLOSED};
+	_lastStreamId = streamId;
+
+	if (_goingAway || _streams.size() >= maxConcurrentStreams) {
+		resetStream(streamId, error_code::REFUSED_STREAM);
+		return;
+	}
+
+	stream &stream = _streams[streamId] = {
+		std::move(headers), {}, _peerInitialWindowSize, initialWindowSize, endStream};
+
+	if (tooLarge) {
+		rejectStream(streamId, 431);
+		return;
+	}
+
+	for (const auto &[name, value] : stream.headers) {
+		if (name == "content-length" && std::strtoull(value.c_str(), nullptr, 10) > _limits.bodySize) {
+			rejectStream(streamId, 413);
+			return;
+		}
+	}
+
+	if (endStream)
+		_ready.push_back(streamId);
+}
+
+void http2_connection::applySettings(std::string_view payload) {
+	if (payload.length() % 6 != 0)
+		throw connection_error{error_code::FRAME_SIZE_ERROR};
+
+	for (size_t i = 0; i < payload.length(); i += 6) {
+		const uint16_t id = (static_cast<unsigned char>(payload[i]) << 8) | static_cast<unsigned char>(payload[i + 1]);
+		const uint32_t value = readUint32(payload.substr(i + 2));
+
+		switch (id) {
+			case setting::HEADER_TABLE_SIZE:
+				_encoder.setMaxTableSize(value);
+				break;
+			case setting::INITIAL_WINDOW_SIZE: {
+				if (value > maxWindowSize)
+					throw connection_error{error_code::FLOW_CONTROL_ERROR};
+
+				const int64_t delta = static_cast<int64_t>(value) - _peerInitialWindowSize;
+				for (auto &[id, stream] : _streams)
+					stream.sendWindow += delta;
+				_peerInitialWindowSize = value;
+				break;
+			}
+			case setting::MAX_FRAME_SIZE:
+				if (value < 16384 || value > 16777215)
+					throw connection_error{error_code::PROTOCOL_ERROR};
+				_peerMaxFrameSize = value;
+				break;
+			default: // the others do not concern a server that never pushes
+				break;
+		}
+	}
+}
+
+void http2_connection::dispatchStream(uint32_t streamId) {
+	auto it = _streams.find(streamId);
+	if (it == _streams.end())
+		return;
+
+	// the stream may be reset while the handler runs, so the request owns its data
+	const hpack::header_list headerList = std::move(it->second.headers);
+	const std::string body = std::move(it->second.body);
+
+	std::string_view methodName, scheme = "http", authority, path;
+	request_headers headers;
+
+	for (const auto &[name, value] : headerList) {
+		if (name == ":method") {
+			methodName = value;
+		} else if (name == ":scheme") {
+			scheme = value;
+		} else if (name == ":authority") {
+			authority = value;
+		} else if (name == ":path") {
+			path = value;
+		} else if (!name.empty() && name[0] != ':' && !isConnectionSpecific(name)) {
+			headers.add(name, value);
+		}
+	}
+
+	if (authority.empty()) {
+		authority = headers.get(header::HOST);
+	} else if (!headers.has(header::HOST)) {
+		headers.add("host", authority);
+	}
+
+	if (methodName.empty() || path.empty()) {
+		resetStream(streamId, error_code::PROTOCOL_ERROR);
+		return;
+	}
+
+	const method method = methodFromString(methodName);
+
+	std::unordered_map<std::string, std::string> payload;
+	if (method == method::POST && headers.get(header::CONTENT_TYPE) == "application/x-www-form-urlencoded") {
+		std::istringstream payloadStream(body);
+		std::string data;
+		while (std::getline(payloadStream, data, '&')) {
+			std::string key, value;
+			std::istringstream dataStream(data);
+			std::getline(dataStream, key, '=');
+			std::getline(dataStream, value);
+			payload[key] = value;
+		}
+	}
+
+	const url url{std::string(scheme), std::string(authority), std::string(path)};
+	request req(-1, method, url, headers, payload, request_body(-1, body, body.length()));
+	dispatchRequest(req, streamId, method == method::HEAD);
+
+	closeStream(streamId);
+}
+
+void http2_connection::dispatchRequest(request &req, uint32_t streamId, bool head) {
+	req.response()._sender = [this, streamId, head](const response &response) {
+		return sendResponse(streamId, head, response);
+	};
+
+	_dispatch(req);
+}
+
+bool http2_connection::sendResponse(uint32_t streamId, bool head, const response &response) {
+	if (_closed || !_streams.count(streamId))
+		return false;
+
+	try {
+		std::string block;
+		_encoder.beginBlock(block);
+		_encoder.encode(":status", std::to_string(response._status), block);
+
+		std::string name;
+		for (const auto &[key, value] : response._headers) {
+			name.resize(key.length());
+			std::transform(key.begin(), key.end(), name.begin(), [](unsigned char c) {
+				return std::tolower(c);
+			});
+			if (!isConnectionSpecific(name))
+				_encoder.encode(name, value, block);
+		}
+
+		const std::string_view date = response::dateHeader(); // "Date: ...\r\n"
+		if (!response._headers.has(header::CONTENT_TYPE))
+			_encoder.encode("content-type", contentTypeToString(response._content_type), block);
+		_encoder.encode("content-length", std::to_string(response.content().size()), block);
+		_encoder.encode("date", date.substr(6, date.length() - 8), block);
+
+		const bool endStream = head || response.content().empty();
+
+		for (size_t offset = 0; offset < block.length() || offset == 0;) {
+			const size_t length = std::min<size_t>(block.length() - offset, _peerMaxFrameSize);
+			const bool last = offset + length == block.length();
+
+			uint8_t flags = last ? flag::END_HEADERS : 0;
+			if (offset == 0 && endStream)
+				flags |= flag::END_STREAM;
+
+			writeFrame(offset == 0 ? frame_type::HEADERS : frame_type::CONTINUATION, flags, streamId,
+					   std::string_view(block).substr(offset, length));
+			offset += length;
+		}
+
+		if (endStream)
+			return true;
+
+		const std::string_view content = response.content();
+
+		for (size_t offset = 0; offset < content.length();) {
+			auto it = _streams.find(streamId);
+			if (it == _streams.end()) // reset by the client
+				return false;
+
+			const int64_t window = std::min<int64_t>({_sendWindow, it->second.sendWindow, _peerMaxFrameSize});
+
+			if (window <= 0) { // wait for WINDOW_UPDATE, other streams keep being read meanwhile
+				frame frame;
+				if (!readFrame(frame)) {
+					_closed = true;
+					return false;
+				}
+				processFrame(frame);
+				continue;
+			}
+
+			const size_t length = std::min<size_t>(window, content.length() - offset);
+			const bool last = offset + length == content.length();
+
+			writeFrame(frame_type::DATA, last ? flag::END_STREAM : 0, streamId, content.substr(offset, length));
+
+			_sendWindow -= length;
+			it->second.sendWindow -= length;
+			offset += length;
+		}
+
+		return true;
+	} catch (const connection_error &error) {
+		_error = error.code;
+		return false;
+	}
+}
+
+void http2_connection::writeFrame(uint8_t type, uint8_t flags, uint32_t streamId, std::string_view payload) {
+	if (_closed)
+		return;
+
+	char header[9];
+	header[0] = static_cast<char>(payload.length() >> 16);
+	header[1] = static_cast<char>(payload.length() >> 8);
+	header[2] = static_cast<char>(payload.length());
+	header[3] = static_cast<char>(type);
+	header[4] = static_cast<char>(flags);
+	header[5] = static_cast<char>(streamId >> 24);
+	header[6] = static_cast<char>(streamId >> 16);
+	header[7] = static_cast<char>(streamId >> 8);
+	header[8] = static_cast<char>(streamId);
+
+	iovec iov[2] = {{header, sizeof(header)}, {const_cast<char *>(payload.data()), payload.length()}};
+	if (!writeAll(_clientfd, iov, 2))
+		_closed = true;
+}
+
+void http2_connection::returnCredit(uint32_t length) {
+	if (length == 0)
+		return;
+
+	std::string increment;
+	appendUint32(increment, length);
+	writeFrame(frame_type::WINDOW_UPDATE, 0, 0, increment);
+	_receiveWindow += length;
+}
+
+void http2_connection::rejectStream(uint32_t streamId, int status) {
+	response response(-1);
+	response.setStatus(status);
+	sendResponse(streamId, true, response);
+
+	// what the client still sends on the stream is refused rather than read
+	auto it = _streams.find(streamId);
+	if (it != _streams.end() && !it->second.complete) {
+		resetStream(streamId, error_code::NO_ERROR);
+	} else {
+		closeStream(streamId);
+	}
+}
+
+void http2_connection::resetStream(uint32_t streamId, uint32_t errorCode) {
+	std::string payload;
+	appendUint32(payload, errorCode);
+	writeFrame(frame_type::RST_STREAM, 0, streamId, payload);
+
+	_resetStreams.push_back(streamId);
+	if (_resetStreams.size() > maxConcurrentStreams)
+		_resetStreams.pop_front();
+
+	closeStream(streamId);
+}
+
+void http2_connection::closeStream(uint32_t streamId) {
+	auto it = _streams.find(streamId);
+	if (it == _streams.end())
+		return;
+
+	returnCredit(it->second.received);
+	_streams.erase(it);
+	_ready.erase(std::remove(_ready.begin(), _ready.end(), streamId), _ready.end());
+}
+
+void http2_connection::writeGoAway(uint32_t errorCode) {
+	_goAwayStreamId = std::min(_goAwayStreamId, _lastStreamId);
+
+	std::string payload;
+	appendUint32(payload, _goAwayStreamId);
+	appendUint32(payload, errorCode);
+	writeFrame(frame_type::GOAWAY, 0, 0, payload);
+}
+
+void http2_connection::goAway(uint32_t errorCode) {
+	writeGoAway(errorCode);
+
+	if (errorCode != error_code::NO_ERROR)
+		::http::warn("HTTP/2 connection closed with error code ", errorCode);
+
+	_closed = true;
+}
+
+} // namespace http
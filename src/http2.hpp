@@ -0,0 +1,116 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <string>
+#include <string_view>
+
+#include "hpack.hpp"
+#include "request.hpp"
+
+namespace http {
+
+// HTTP/2 over cleartext TCP (h2c), either with prior knowledge or upgraded from an HTTP/1.1 request.
+// Every stream becomes an http::request answered through the usual handlers. Frames of all streams keep being read
+// while a response waits for flow-control credit, but the handler runs for one complete request at a time.
+// Bodies buffered by all streams together stay within the connection window, which is the body limit: its credit is
+// only returned once a stream is answered or reset. DATA past the connection or a stream window is a flow-control
+// error.
+class http2_connection {
+  public:
+	using dispatchCallbackType = std::function<void(request &)>;
+
+	struct limits {
+		size_t headerBytes; // names and values, pseudo-headers included, 431 past it
+		size_t headerCount; // not counting pseudo-headers, 431 past it
+		size_t bodySize;	// 413 past it
+	}; // limits
+
+	static constexpr std::string_view preface = "PRI * HTTP/2.0\r\n\r\nSM\r\n\r\n";
+
+	// Past lifetimeSeconds the client is sent GOAWAY, the streams it already opened get one more idle timeout
+	http2_connection(int clientfd, dispatchCallbackType dispatch, const limits &limits, unsigned idleTimeoutSeconds,
+					 unsigned lifetimeSeconds);
+
+	// received: bytes already read from the client, starting with (part of) the connection preface
+	void serve(std::string_view received);
+
+	// Sends the server preface, answers the upgraded request as stream 1 and serves the connection.
+	// settings: the HTTP2-Settings header of the upgraded request
+	void serveUpgrade(method method, const url &url, const request_headers &headers, std::string_view settings);
+
+  private:
+	struct frame {
+		uint8_t type;
+		uint8_t flags;
+		uint32_t streamId;
+		std::string_view payload; // valid until the next read
+	};
+
+	struct stream {
+		hpack::header_list headers;
+		std::string body;
+		int64_t sendWindow;
+		int64_t receiveWindow; // what the client may still send
+		bool complete = false; // END_STREAM received
+		uint32_t received = 0; // DATA bytes, returned to the connection window when the stream closes
+	};
+
+	void run(bool sendPreface = true);
+	void sendSettings();
+
+	bool fill(size_t length);
+	bool readFrame(frame &frame);
+	void processFrame(const frame &frame);
+	void processHeaderBlock(uint32_t streamId, bool endStream);
+	void applySettings(std::string_view payload);
+
+	void dispatchStream(uint32_t streamId);
+	void dispatchRequest(request &req, uint32_t streamId, bool head);
+	bool sendResponse(uint32_t streamId, bool head, const response &response);
+
+	void writeFrame(uint8_t type, uint8_t flags, uint32_t streamId, std::string_view payload);
+	void returnCredit(uint32_t length); // to the connection window
+	void rejectStream(uint32_t streamId, int status); // answers with a bodiless error response
+	void resetStream(uint32_t streamId, uint32_t errorCode);
+	void closeStream(uint32_t streamId);
+	void writeGoAway(uint32_t errorCode);
+	void goAway(uint32_t errorCode);
+
+	const int _clientfd;
+	const dispatchCallbackType _dispatch;
+	const limits _limits;
+	const int _idleTimeoutMs;
+	const std::chrono::steady_clock::time_point _deadline;
+
+	std::string _input;
+	size_t _inputPos = 0;
+
+	hpack::decoder _decoder;
+	hpack::encoder _encoder;
+
+	std::map<uint32_t, stream> _streams;
+	std::deque<uint32_t> _ready; // streams with a complete request, in order of completion
+	uint32_t _lastStreamId = 0;
+	std::deque<uint32_t> _resetStreams; // the last ones we reset
+
+	uint32_t _headerBlockStream = 0; // stream expecting CONTINUATION frames, 0 if none
+	bool _headerBlockEndStream = false;
+	std::string _headerBlock;
+
+	int64_t _sendWindow = 65535;
+	int64_t _receiveWindow = 65535;
+	uint32_t _peerInitialWindowSize = 65535;
+	uint32_t _peerMaxFrameSize = 16384;
+
+	bool _peerGoingAway = false;
+	bool _goingAway = false;			  // past the deadline, draining the open streams
+	uint32_t _goAwayStreamId = 0x7fffffff; // last stream id sent with GOAWAY, never raised
+	bool _closed = false;
+	uint32_t _error = 0; // connection error raised while a handler was sending
+}; // http2_connection
+
+} // namespace http
@@ -0,0 +1,118 @@
+#include "io.hpp"
+
+#include <algorithm>
+#include <cerrno>
+
+// OS-SPECIFIC INCLUDES TODO: CHANGE WHEN IMPLEMENTING CROSS-PLATFORM SUPPORT
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "accounting.hpp"
+
+namespace http {
+
+bool writeAll(int fd, iovec *iov, int iovcnt) {
+	while (iovcnt > 0) {
+		ssize_t written = writev(fd, iov, iovcnt);
+		accounting::wrote(std::max<ssize_t>(written, 0));
+		if (written < 0) {
+			if (errno == EINTR)
+				continue;
+			return false;
+		}
+
+		while (iovcnt > 0 && static_cast<size_t>(written) >= iov->iov_len) {
+			written -= iov->iov_len;
+			iov++;
+			iovcnt--;
+		}
+
+		if (iovcnt > 0) {
+			iov->iov_base = static_cast<char *>(iov->iov_base) + written;
+			iov->iov_len -= written;
+		}
+	}
+
+	return true;
+}
+
+bool writeAll(int fd, std::string_view data) {
+	iovec iov = {const_cast<char *>(data.data()), data.length()};
+	return writeAll(fd, &iov, 1);
+}
+
+namespace {
+
+struct relay_pipe {
+	int fds[2] = {-1, -1};
+
+	~relay_pipe() {
+		reset();
+	}
+
+	bool open() {
+		return fds[0] >= 0 || pipe2(fds, O_CLOEXEC) == 0;
+	}
+
+	void reset() { // after a failure the pipe may still hold data
+		if (fds[0] >= 0) {
+			close(fds[0]);
+			close(fds[1]);
+		}
+		fds[0] = fds[1] = -1;
+	}
+};
+
+} // namespace
+
+size_t relay(int in, int out, size_t length) {
+	thread_local relay_pipe pipe;
+
+	bool spliceable = pipe.open();
+	size_t moved = 0;
+
+	while (moved < length) {
+		const size_t chunk = std::min<size_t>(length - moved, 1 << 16);
+
+		if (!spliceable) {
+			char buffer[16384];
+			const ssize_t bytesread = read(in, buffer, std::min(chunk, sizeof(buffer)));
+			accounting::received(std::max<ssize_t>(bytesread, 0));
+			if (bytesread < 0 && errno == EINTR)
+				continue;
+			if (bytesread <= 0 || !writeAll(out, std::string_view(buffer, bytesread)))
+				break;
+
+			moved += bytesread;
+			continue;
+		}
+
+		const ssize_t spliced = splice(in, nullptr, pipe.fds[1], nullptr, chunk, SPLICE_F_MOVE | SPLICE_F_MORE);
+		if (spliced < 0 && errno == EINTR)
+			continue;
+		if (spliced < 0 && errno == EINVAL) { // the pipe is still empty
+			spliceable = false;
+			continue;
+		}
+		if (spliced <= 0)
+			break;
+
+		for (size_t pending = spliced; pending > 0;) {
+			const ssize_t written = splice(pipe.fds[0], nullptr, out, nullptr, pending, SPLICE_F_MOVE | SPLICE_F_MORE);
+			accounting::wrote(std::max<ssize_t>(written, 0)); // moved without being copied
+			if (written < 0 && errno == EINTR)
+				continue;
+			if (written <= 0) {
+				pipe.reset();
+				return moved;
+			}
+
+			pending -= written;
+			moved += written;
+		}
+	}
+
+	return moved;
+}
+
+} // namespace http
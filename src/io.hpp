@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+
+// OS-SPECIFIC INCLUDES TODO: CHANGE WHEN IMPLEMENTING CROSS-PLATFORM SUPPORT
+#include <sys/uio.h>
+
+namespace http {
+
+// Write everything or fail, retrying after partial writes and EINTR. iov is consumed.
+bool writeAll(int fd, iovec *iov, int iovcnt);
+bool writeAll(int fd, std::string_view data);
+
+// Moves up to length bytes from in to out through a per-thread pipe with splice, falling back to read/write if in
+// cannot be spliced. Stops early at end of file or on error, returns the number of bytes moved.
+size_t relay(int in, int out, size_t length);
+
+} // namespace http
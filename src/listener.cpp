@@ -0,0 +1,192 @@
+#include "listener.hpp"
+
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <sstream>
+
+// OS-SPECIFIC INCLUDES TODO: CHANGE WHEN IMPLEMENTING CROSS-PLATFORM SUPPORT
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <linux/filter.h>
+
+using namespace std::string_literals;
+
+namespace http {
+
+listener::listener(const host &host, uint16_t port) : port(port) {
+	std::ostringstream address;
+	address << host;
+	this->address = address.str();
+}
+
+listener listener::unixSocket(const std::string &path, mode_t permissions) {
+	listener listener;
+	listener.path = path;
+	listener.permissions = permissions;
+	return listener;
+}
+
+bool listener::isUnixSocket() const {
+	return !path.empty();
+}
+
+// Abstract names are not NUL-terminated, the address length delimits them
+static socklen_t unixSocketAddress(const std::string &path, sockaddr_un &addr) {
+	addr = {};
+	addr.sun_family = AF_UNIX;
+	if (path.length() >= sizeof(addr.sun_path))
+		throw "Unix socket path too long: "s + path;
+
+	std::memcpy(addr.sun_path, path.data(), path.length());
+	if (path[0] == '@') {
+		addr.sun_path[0] = '\0';
+		return offsetof(sockaddr_un, sun_path) + path.length();
+	}
+	return sizeof(addr);
+}
+
+// A socket file nobody accepts on is left over from a server that did not stop cleanly
+static bool isStaleSocket(const sockaddr_un &addr, socklen_t length) {
+	struct stat status;
+	if (stat(addr.sun_path, &status) < 0 || !S_ISSOCK(status.st_mode))
+		return false;
+
+	const int probe = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	if (probe < 0)
+		return false;
+	const bool stale = connect(probe, (const sockaddr *)&addr, length) < 0 && errno == ECONNREFUSED;
+	close(probe);
+	return stale;
+}
+
+static int openUnixSocket(const listener &listener) {
+	sockaddr_un addr;
+	const socklen_t length = unixSocketAddress(listener.path, addr);
+	const bool abstract = listener.path[0] == '@';
+
+	const int sockfd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	if (sockfd < 0)
+		throw std::string(std::strerror(errno));
+
+	const auto fail = [&](const std::string &description) {
+		const std::string error = description + ": "s + std::strerror(errno);
+		close(sockfd);
+		return error;
+	};
+
+	if (listener.receiveBuffer > 0 &&
+		setsockopt(sockfd, SOL_SOCKET, SO_RCVBUF, &listener.receiveBuffer, sizeof(listener.receiveBuffer)) < 0)
+		throw fail("SO_RCVBUF");
+	if (listener.sendBuffer > 0 &&
+		setsockopt(sockfd, SOL_SOCKET, SO_SNDBUF, &listener.sendBuffer, sizeof(listener.sendBuffer)) < 0)
+		throw fail("SO_SNDBUF");
+
+	if (!abstract && isStaleSocket(addr, length))
+		unlink(listener.path.c_str());
+
+	if (bind(sockfd, (const sockaddr *)&addr, length) < 0)
+		throw fail(listener.path);
+
+	if ((!abstract && listener.permissions != 0 && chmod(listener.path.c_str(), listener.permissions) < 0) ||
+		::listen(sockfd, listener.backlog) < 0) {
+		const std::string error = fail(listener.path);
+		if (!abstract)
+			unlink(listener.path.c_str());
+		throw error;
+	}
+
+	return sockfd;
+}
+
+int listener::open() const {
+	if (isUnixSocket())
+		return openUnixSocket(*this);
+
+	addrinfo hints = {};
+	hints.ai_family = AF_UNSPEC;
+	hints.ai_socktype = SOCK_STREAM;
+	hints.ai_flags = AI_PASSIVE | AI_NUMERICSERV;
+
+	addrinfo *result;
+	const int status = getaddrinfo(address.c_str(), std::to_string(port).c_str(), &hints, &result);
+	if (status != 0)
+		throw "Failed to resolve "s + address + ": "s + gai_strerror(status);
+
+	const int sockfd = socket(result->ai_family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, IPPROTO_TCP);
+	if (sockfd < 0) {
+		freeaddrinfo(result);
+		throw std::string(std::strerror(errno));
+	}
+
+	const auto option = [&](int level, int name, int value, const char *description) {
+		if (setsockopt(sockfd, level, name, &value, sizeof(value)) < 0) {
+			const std::string error = description + ": "s + std::strerror(errno);
+			close(sockfd);
+			freeaddrinfo(result);
+			throw error;
+		}
+	};
+
+	if (reuseAddress)
+		option(SOL_SOCKET, SO_REUSEADDR, 1, "SO_REUSEADDR");
+	if (reusePort)
+		option(SOL_SOCKET, SO_REUSEPORT, 1, "SO_REUSEPORT");
+	if (result->ai_family == AF_INET6)
+		option(IPPROTO_IPV6, IPV6_V6ONLY, v6Only, "IPV6_V6ONLY");
+	if (incomingCpu >= 0)
+		option(SOL_SOCKET, SO_INCOMING_CPU, incomingCpu, "SO_INCOMING_CPU");
+
+	// the buffer sizes have to be set before listening to take effect on accepted connections
+	if (receiveBuffer > 0)
+		option(SOL_SOCKET, SO_RCVBUF, receiveBuffer, "SO_RCVBUF");
+	if (sendBuffer > 0)
+		option(SOL_SOCKET, SO_SNDBUF, sendBuffer, "SO_SNDBUF");
+
+	if (deferAcceptSeconds > 0)
+		option(IPPROTO_TCP, TCP_DEFER_ACCEPT, deferAcceptSeconds, "TCP_DEFER_ACCEPT");
+	if (fastOpenQueue > 0)
+		option(IPPROTO_TCP, TCP_FASTOPEN, fastOpenQueue, "TCP_FASTOPEN");
+
+	if (bind(sockfd, result->ai_addr, result->ai_addrlen) < 0 || ::listen(sockfd, backlog) < 0) {
+		const std::string error = std::strerror(errno);
+		close(sockfd);
+		freeaddrinfo(result);
+		throw error;
+	}
+
+	// attached to the whole group, every socket of it attaches the same program
+	if (reusePort && reusePortGroupSize > 0) {
+		sock_filter selectByCpu[] = {
+			{BPF_LD | BPF_W | BPF_ABS, 0, 0, static_cast<uint32_t>(SKF_AD_OFF + SKF_AD_CPU)}, // A = receiving CPU
+			{BPF_ALU | BPF_MOD | BPF_K, 0, 0, reusePortGroupSize},							// A %= group size
+			{BPF_RET | BPF_A, 0, 0, 0},														// socket index A
+		};
+		sock_fprog program = {static_cast<unsigned short>(std::size(selectByCpu)), selectByCpu};
+
+		if (setsockopt(sockfd, SOL_SOCKET, SO_ATTACH_REUSEPORT_CBPF, &program, sizeof(program)) < 0) {
+			const std::string error = "SO_ATTACH_REUSEPORT_CBPF: "s + std::strerror(errno);
+			close(sockfd);
+			freeaddrinfo(result);
+			throw error;
+		}
+	}
+
+	freeaddrinfo(result);
+	return sockfd;
+}
+
+std::ostream &operator<<(std::ostream &out, const listener &listener) {
+	if (listener.isUnixSocket())
+		return out << "unix:" << listener.path;
+	if (listener.address.find(':') != std::string::npos)
+		return out << "[" << listener.address << "]:" << listener.port;
+	return out << listener.address << ":" << listener.port;
+}
+
+} // namespace http
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+
+// OS-SPECIFIC INCLUDES TODO: CHANGE WHEN IMPLEMENTING CROSS-PLATFORM SUPPORT
+#include <sys/types.h>
+#include <string>
+
+#include "host.hpp"
+
+namespace http {
+
+// Where and how a server accepts connections (see server::addListener)
+struct listener {
+	std::string address = "0.0.0.0"; // IPv4 or IPv6 address, or a host name resolving to one
+	uint16_t port = 80;
+	int backlog = 1024;
+
+	// Listen on a Unix domain socket instead of address:port, "@name" for the abstract namespace. A stale socket file
+	// is replaced; the file is removed when the server stops. The TCP options below do not apply.
+	std::string path;
+	mode_t permissions = 0; // chmod of the socket file, 0 keeps what the umask gives
+
+	bool reuseAddress = true; // SO_REUSEADDR, rebind while old connections are in TIME_WAIT
+	bool reusePort = false;	  // SO_REUSEPORT, several threads or processes listen on the same port
+	bool v6Only = false;	  // IPV6_V6ONLY, otherwise "::" also accepts IPv4 connections
+
+	// With reusePort, a connection goes to the socket whose index in the group (the order the sockets were bound in)
+	// is the CPU that received it, modulo reusePortGroupSize (SO_ATTACH_REUSEPORT_CBPF). With the thread listening on
+	// socket i pinned to CPU i (see server::setCpuAffinity), connections are served on the core their NIC queue
+	// interrupts, next to the memory of that thread. 0 keeps the kernel's hash.
+	unsigned reusePortGroupSize = 0;
+	int incomingCpu = -1; // SO_INCOMING_CPU, prefer this socket of the group for connections received on the CPU
+
+	bool noDelay = false;		  // TCP_NODELAY on accepted connections
+	unsigned deferAcceptSeconds = 0; // TCP_DEFER_ACCEPT, only wake up once the request has arrived
+	int fastOpenQueue = 0;		  // TCP_FASTOPEN, pending TFO connections, 0 disables it
+	int receiveBuffer = 0;		  // SO_RCVBUF, 0 keeps the system default
+	int sendBuffer = 0;			  // SO_SNDBUF, 0 keeps the system default
+
+	listener() = default;
+	listener(const host &host, uint16_t port);
+
+	static listener unixSocket(const std::string &path, mode_t permissions = 0);
+
+	bool isUnixSocket() const;
+
+	// A bound, listening, non-blocking socket; throws std::string on failure
+	int open() const;
+}; // listener
+
+// address:port, [address]:port for IPv6, unix:path
+std::ostream &operator<<(std::ostream &out, const listener &listener);
+
+} // namespace http
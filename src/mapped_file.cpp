@@ -0,0 +1,55 @@
+#include "mapped_file.hpp"
+
+#include <cerrno>
+#include <cstring>
+
+// OS-SPECIFIC INCLUDES TODO: CHANGE WHEN IMPLEMENTING CROSS-PLATFORM SUPPORT
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace std::string_literals;
+
+namespace http {
+
+std::shared_ptr<const mapped_file> mapped_file::open(const std::string &path) {
+	const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+	if (fd < 0)
+		throw "Failed to open "s + path + ": "s + std::strerror(errno);
+
+	struct stat status;
+	const bool opened = fstat(fd, &status) == 0;
+	if (!opened || !S_ISREG(status.st_mode)) {
+		const int error = opened ? EINVAL : errno;
+		close(fd);
+		throw "Failed to map "s + path + ": "s + std::strerror(error);
+	}
+
+	void *address = nullptr;
+	if (status.st_size > 0) {
+		address = mmap(nullptr, status.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (address == MAP_FAILED) {
+			const int error = errno;
+			close(fd);
+			throw "Failed to map "s + path + ": "s + std::strerror(error);
+		}
+	}
+	close(fd); // the mapping stays valid
+
+	return std::shared_ptr<const mapped_file>(new mapped_file(address, status.st_size));
+}
+
+mapped_file::mapped_file(void *address, size_t length) : _address(address), _length(length) {
+}
+
+mapped_file::~mapped_file() {
+	if (_address)
+		munmap(_address, _length);
+}
+
+std::string_view mapped_file::content() const {
+	return _address ? std::string_view(static_cast<const char *>(_address), _length) : std::string_view();
+}
+
+} // namespace http
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace http {
+
+// A read-only mapping of a whole file, shared by the responses sending it (see response::setContentMapped), which keep
+// it mapped until they have been sent. The file may be unlinked or replaced meanwhile, not truncated.
+class mapped_file {
+  public:
+	// Throws std::string if the file can not be opened or mapped
+	static std::shared_ptr<const mapped_file> open(const std::string &path);
+	~mapped_file(); // unmaps
+
+	mapped_file(const mapped_file &) = delete;
+	mapped_file &operator=(const mapped_file &) = delete;
+
+	std::string_view content() const;
+
+  private:
+	mapped_file(void *address, size_t length);
+
+	void *const _address; // nullptr for an empty file, which can not be mapped
+	const size_t _length;
+}; // mapped_file
+
+} // namespace http
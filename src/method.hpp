@@ -1,5 +1,7 @@
 #pragma once
 
+#include <string_view>
+
 namespace http {
 
 enum class method {
@@ -15,4 +17,60 @@ enum class method {
 	PATCH,
 }; // method
 
+// The first byte leaves at most two candidates, only those are compared
+constexpr method methodFromString(std::string_view name) {
+	if (name.empty())
+		return method::UNKNOWN;
+
+	switch (name[0]) {
+		case 'G':
+			return name == "GET" ? method::GET : method::UNKNOWN;
+		case 'H':
+			return name == "HEAD" ? method::HEAD : method::UNKNOWN;
+		case 'P':
+			if (name.length() == 3)
+				return name == "PUT" ? method::PUT : method::UNKNOWN;
+			if (name.length() == 4)
+				return name == "POST" ? method::POST : method::UNKNOWN;
+			return name == "PATCH" ? method::PATCH : method::UNKNOWN;
+		case 'D':
+			return name == "DELETE" ? method::DELETE : method::UNKNOWN;
+		case 'C':
+			return name == "CONNECT" ? method::CONNECT : method::UNKNOWN;
+		case 'O':
+			return name == "OPTIONS" ? method::OPTIONS : method::UNKNOWN;
+		case 'T':
+			return name == "TRACE" ? method::TRACE : method::UNKNOWN;
+		default:
+			return method::UNKNOWN;
+	}
+}
+
+constexpr std::string_view methodToString(method method) {
+	switch (method) {
+		case method::GET:
+			return "GET";
+		case method::HEAD:
+			return "HEAD";
+		case method::POST:
+			return "POST";
+		case method::PUT:
+			return "PUT";
+		case method::DELETE:
+			return "DELETE";
+		case method::CONNECT:
+			return "CONNECT";
+		case method::OPTIONS:
+			return "OPTIONS";
+		case method::TRACE:
+			return "TRACE";
+		case method::PATCH:
+			return "PATCH";
+		case method::UNKNOWN:
+			break;
+	}
+
+	return "";
+}
+
 } // namespace http
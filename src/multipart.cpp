@@ -0,0 +1,236 @@
+#include "multipart.hpp"
+
+#include <fstream>
+
+#include "exception.hpp"
+
+using namespace std::string_literals;
+
+namespace http {
+
+static std::string_view trim(std::string_view value) {
+	const size_t first = value.find_first_not_of(" \t");
+	if (first == std::string_view::npos)
+		return {};
+	const size_t last = value.find_last_not_of(" \t");
+	return value.substr(first, last - first + 1);
+}
+
+// A parameter of a header value like `form-data; name="field"; filename="a.txt"`, quotes removed
+static std::string headerParameter(std::string_view value, std::string_view key) {
+	size_t pos = value.find(';');
+	while (pos != std::string_view::npos) {
+		value.remove_prefix(pos + 1);
+
+		const size_t equals = value.find('=');
+		if (equals == std::string_view::npos)
+			break;
+
+		const std::string_view name = trim(value.substr(0, equals));
+		value.remove_prefix(equals + 1);
+		value.remove_prefix(std::min(value.find_first_not_of(" \t"), value.length()));
+
+		std::string parameter;
+		if (!value.empty() && value.front() == '"') {
+			size_t i = 1;
+			for (; i < value.length() && value[i] != '"'; i++) {
+				if (value[i] == '\\' && i + 1 < value.length())
+					i++;
+				parameter += value[i];
+			}
+			value.remove_prefix(std::min(i + 1, value.length()));
+		} else {
+			const size_t end = value.find(';');
+			parameter = trim(value.substr(0, end));
+			value.remove_prefix(end == std::string_view::npos ? value.length() : end);
+		}
+
+		if (equalsIgnoreCase(name, key))
+			return parameter;
+
+		pos = value.find(';');
+	}
+	return "";
+}
+
+std::string_view multipart::part::contentType() const {
+	const std::string_view type = headers.get(header::CONTENT_TYPE);
+	return type.empty() ? "text/plain" : type;
+}
+
+bool multipart::isMultipart(const request &req) {
+	const std::string_view type = req.getHeader(header::CONTENT_TYPE);
+	return equalsIgnoreCase(trim(type.substr(0, type.find(';'))), "multipart/form-data");
+}
+
+multipart::multipart(request &req) : _body(req.body()) {
+	if (!isMultipart(req))
+		throw exception(400, "Not a multipart/form-data request");
+
+	const std::string boundary = headerParameter(req.getHeader(header::CONTENT_TYPE), "boundary");
+	if (boundary.empty() || boundary.length() > 70)
+		throw exception(400, "Missing or invalid multipart boundary");
+
+	_delimiter = "\r\n--"s + boundary;
+
+	_skip.fill(_delimiter.length());
+	for (size_t i = 0; i + 1 < _delimiter.length(); i++)
+		_skip[static_cast<unsigned char>(_delimiter[i])] = _delimiter.length() - 1 - i;
+
+	_buffer = "\r\n"; // the first delimiter has no preceding line break
+}
+
+size_t multipart::find(std::string_view haystack) const {
+	const size_t length = _delimiter.length();
+	const char last = _delimiter.back();
+
+	for (size_t pos = 0; pos + length <= haystack.length();) {
+		const char c = haystack[pos + length - 1];
+		if (c == last && haystack.compare(pos, length - 1, _delimiter, 0, length - 1) == 0)
+			return pos;
+		pos += _skip[static_cast<unsigned char>(c)];
+	}
+
+	return std::string_view::npos;
+}
+
+bool multipart::fill() {
+	if (_pos > 0) { // keep only what has not been consumed yet
+		_buffer.erase(0, _pos);
+		_pos = 0;
+	}
+
+	const size_t size = _buffer.length();
+	_buffer.resize(size + 65536);
+
+	const size_t n = _body.read(_buffer.data() + size, 65536);
+	_buffer.resize(size + n);
+	return n > 0;
+}
+
+bool multipart::streamBody(const chunkCallbackType &callback) {
+	bool accepted = true;
+
+	while (true) {
+		const std::string_view available = std::string_view(_buffer).substr(_pos);
+
+		const size_t found = find(available);
+		if (found != std::string_view::npos) {
+			if (accepted && found > 0)
+				accepted = callback(available.substr(0, found));
+			_pos += found + _delimiter.length();
+			_state = state::DELIMITER;
+			return accepted;
+		}
+
+		// everything except a possible beginning of the delimiter is body
+		if (available.length() >= _delimiter.length()) {
+			const size_t safe = available.length() - (_delimiter.length() - 1);
+			if (accepted)
+				accepted = callback(available.substr(0, safe));
+			_pos += safe;
+		}
+
+		if (!fill())
+			throw exception(400, "Unexpected end of multipart body");
+	}
+}
+
+bool multipart::next(part &part) {
+	if (_state == state::DONE)
+		return false;
+
+	if (_state == state::PREAMBLE || _state == state::BODY) {
+		streamBody([](std::string_view) {
+			return true;
+		});
+	}
+
+	// the delimiter is followed by "--" after the last part, otherwise by optional whitespace and a line break
+	while (_buffer.length() - _pos < 2) {
+		if (!fill())
+			throw exception(400, "Unexpected end of multipart body");
+	}
+
+	if (_buffer.compare(_pos, 2, "--") == 0) {
+		_state = state::DONE;
+		return false;
+	}
+
+	size_t end;
+	while ((end = _buffer.find("\r\n", _pos)) == std::string::npos) {
+		if (_buffer.length() - _pos > 1024 || !fill())
+			throw exception(400, "Malformed multipart delimiter");
+	}
+
+	if (!trim(std::string_view(_buffer).substr(_pos, end - _pos)).empty())
+		throw exception(400, "Malformed multipart delimiter");
+	_pos = end + 2;
+
+	part.headers.clear();
+	part.name.clear();
+	part.filename.clear();
+
+	while (true) { // part headers, up to an empty line
+		size_t lineEnd;
+		while ((lineEnd = _buffer.find("\r\n", _pos)) == std::string::npos) {
+			if (_buffer.length() - _pos > 16384)
+				throw exception(400, "Multipart part header too large");
+			if (!fill())
+				throw exception(400, "Unexpected end of multipart body");
+		}
+
+		const std::string_view line = std::string_view(_buffer).substr(_pos, lineEnd - _pos);
+		_pos = lineEnd + 2;
+
+		if (line.empty())
+			break;
+
+		const size_t colon = line.find(':');
+		if (colon == std::string_view::npos)
+			throw exception(400, "Malformed multipart part header");
+
+		part.headers.add(std::string(trim(line.substr(0, colon))), std::string(trim(line.substr(colon + 1))));
+	}
+
+	const std::string_view disposition = part.headers.get("Content-Disposition");
+	part.name = headerParameter(disposition, "name");
+	part.filename = headerParameter(disposition, "filename");
+
+	_state = state::BODY;
+	return true;
+}
+
+bool multipart::read(const chunkCallbackType &callback) {
+	if (_state != state::BODY)
+		return false;
+
+	return streamBody(callback);
+}
+
+std::string multipart::readAll(size_t limit) {
+	std::string content;
+	const bool complete = read([&content, limit](std::string_view chunk) {
+		if (content.length() + chunk.length() > limit)
+			return false;
+		content += chunk;
+		return true;
+	});
+
+	if (!complete)
+		throw exception(413, "Multipart part too large");
+
+	return content;
+}
+
+bool multipart::saveTo(const fs::path &path) {
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+	if (!file)
+		return false;
+
+	return read([&file](std::string_view chunk) {
+		return static_cast<bool>(file.write(chunk.data(), chunk.length()));
+	}) && file.flush();
+}
+
+} // namespace http
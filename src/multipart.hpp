@@ -0,0 +1,82 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <string_view>
+
+#include "headers.hpp"
+#include "request.hpp"
+
+namespace http {
+
+namespace fs = std::filesystem;
+
+// Streaming multipart/form-data (RFC 7578) parser over the request body. Only a window of the body is held in
+// memory, so parts of any size can be streamed to a callback or to a file:
+//
+//	http::multipart form(req);
+//	http::multipart::part part;
+//	while (form.next(part)) {
+//		if (part.filename.empty()) {
+//			fields[part.name] = form.readAll();
+//			continue;
+//		}
+//
+//		// chosen by the client, eg. "../../etc/passwd" or "/etc/passwd": only its last component is kept
+//		const fs::path filename = fs::path(part.filename).filename();
+//		if (filename.empty() || filename == "." || filename == "..")
+//			throw http::exception(400, "Bad filename");
+//		form.saveTo(uploads / filename);
+//	}
+class multipart {
+  public:
+	struct part {
+		basic_headers<std::string> headers;
+		std::string name;	  // from Content-Disposition
+		std::string filename; // empty for plain fields; as sent by the client, never a path to use as is
+
+		std::string_view contentType() const; // text/plain if not given
+	};
+
+	using chunkCallbackType = std::function<bool(std::string_view)>; // returning false aborts the part
+
+	static bool isMultipart(const request &req);
+
+	// Throws http::exception(400) if the request is not multipart/form-data with a boundary
+	explicit multipart(request &req);
+
+	// Moves to the next part, skipping what is left of the current one. Returns false after the last part,
+	// throws http::exception(400) if the body is malformed or ends early.
+	bool next(part &part);
+
+	// The body of the current part
+	bool read(const chunkCallbackType &callback);
+	std::string readAll(size_t limit = 1 << 20); // throws http::exception(413) if the part is larger than limit
+	bool saveTo(const fs::path &path);
+
+  private:
+	enum class state {
+		PREAMBLE,  // before the first delimiter
+		BODY,	   // in the body of a part
+		DELIMITER, // right after a delimiter
+		DONE,
+	}; // state
+
+	size_t find(std::string_view haystack) const; // Boyer-Moore-Horspool search for the delimiter
+	bool fill();								  // false at the end of the request body
+	bool streamBody(const chunkCallbackType &callback);
+
+	request_body &_body;
+
+	std::string _delimiter; // "\r\n--" boundary
+	std::array<size_t, 256> _skip;
+
+	std::string _buffer;
+	size_t _pos = 0;
+	state _state = state::PREAMBLE;
+}; // multipart
+
+} // namespace http
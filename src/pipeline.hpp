@@ -0,0 +1,103 @@
+#pragma once
+
+#include <string_view>
+#include <tuple>
+#include <utility>
+
+#include "exception.hpp"
+#include "method.hpp"
+#include "request.hpp"
+
+namespace http {
+
+// Middleware and a handler composed as types, so the calls from one stage to the next are direct and can be inlined;
+// the server only makes one indirect call into the whole pipeline (it converts to server::requestCallbackType).
+//
+// A middleware is any callable taking (request &, Next &next) and returning bool, it either calls next(req) to pass
+// the request on or answers it itself. The last stage is the handler, taking (request &).
+//
+//	http::server server(http::pipeline(timing, auth, http::router(
+//		http::route(http::method::GET, "/", index),
+//		http::route(http::method::GET, "/static/*", assets))), dispatchError);
+template <typename... Stages> class pipeline;
+
+template <typename Handler> class pipeline<Handler> {
+  public:
+	explicit pipeline(Handler handler) : _handler(std::move(handler)) {}
+
+	bool operator()(request &req) {
+		return _handler(req);
+	}
+
+  private:
+	Handler _handler;
+}; // pipeline
+
+template <typename Middleware, typename... Rest> class pipeline<Middleware, Rest...> {
+  public:
+	explicit pipeline(Middleware middleware, Rest... rest)
+		: _middleware(std::move(middleware)), _next(std::move(rest)...) {}
+
+	bool operator()(request &req) {
+		return _middleware(req, _next);
+	}
+
+  private:
+	Middleware _middleware;
+	pipeline<Rest...> _next;
+}; // pipeline
+
+template <typename... Stages> pipeline(Stages...) -> pipeline<Stages...>;
+
+// A path ending in "/*" matches everything below it
+template <typename Handler> struct route {
+	route(::http::method method, std::string_view path, Handler handler)
+		: method(method), path(path), handler(std::move(handler)) {}
+
+	::http::method method;
+	std::string_view path; // not owned, usually a literal
+	Handler handler;
+
+	bool matches(const request &req) const {
+		if (req.method != method)
+			return false;
+
+		const std::string_view pathname = req.url.pathname;
+		if (path.length() >= 2 && path.substr(path.length() - 2) == "/*")
+			return pathname.substr(0, path.length() - 1) == path.substr(0, path.length() - 1);
+		return pathname == path;
+	}
+}; // route
+
+template <typename Handler> route(::http::method, std::string_view, Handler) -> route<Handler>;
+
+// Tries the routes in order. As the handler of a pipeline it answers unmatched requests with 404, as a middleware it
+// passes them on.
+template <typename... Handlers> class router {
+  public:
+	explicit router(route<Handlers>... routes) : _routes(std::move(routes)...) {}
+
+	bool operator()(request &req) {
+		bool result = false;
+		if (!dispatch(req, result))
+			throw exception(404, "Not Found");
+		return result;
+	}
+
+	template <typename Next> bool operator()(request &req, Next &next) {
+		bool result = false;
+		return dispatch(req, result) ? result : next(req);
+	}
+
+  private:
+	// Unrolled at compile time, the first matching route answers
+	bool dispatch(request &req, bool &result) {
+		return std::apply(
+			[&](auto &...routes) { return ((routes.matches(req) && (result = routes.handler(req), true)) || ...); },
+			_routes);
+	}
+
+	std::tuple<route<Handlers>...> _routes;
+}; // router
+
+} // namespace http
@@ -0,0 +1,80 @@
+#include "pool.hpp"
+
+#include <array>
+#include <atomic>
+#include <vector>
+
+namespace http {
+
+static constexpr std::array<size_t, 5> sizeClasses = {4 << 10, 16 << 10, 64 << 10, 256 << 10, 1 << 20};
+
+static std::atomic<size_t> pooledMemory = 0;
+static std::atomic<size_t> memoryLimit = 16 << 20;
+
+namespace {
+
+struct free_lists {
+	std::array<std::vector<std::string>, sizeClasses.size()> buffers;
+
+	~free_lists() { // the thread exits, its buffers are freed
+		for (const auto &list : buffers) {
+			for (const auto &buffer : list)
+				pooledMemory -= buffer.capacity();
+		}
+	}
+};
+
+thread_local free_lists freeLists;
+
+} // namespace
+
+std::string buffer_pool::acquire(size_t size) {
+	size_t sizeClass = 0;
+	while (sizeClass < sizeClasses.size() && sizeClasses[sizeClass] < size)
+		sizeClass++;
+
+	std::string buffer;
+	if (sizeClass == sizeClasses.size()) { // too large to be pooled
+		buffer.reserve(size);
+		return buffer;
+	}
+
+	auto &list = freeLists.buffers[sizeClass];
+	if (!list.empty()) {
+		buffer = std::move(list.back());
+		list.pop_back();
+		pooledMemory -= buffer.capacity();
+		return buffer;
+	}
+
+	buffer.reserve(sizeClasses[sizeClass]);
+	return buffer;
+}
+
+void buffer_pool::release(std::string &&buffer) {
+	const size_t capacity = buffer.capacity();
+	if (capacity < sizeClasses.front() || capacity > 2 * sizeClasses.back())
+		return;
+
+	if (pooledMemory + capacity > memoryLimit)
+		return;
+
+	// the largest class the buffer can serve
+	size_t sizeClass = sizeClasses.size() - 1;
+	while (sizeClasses[sizeClass] > capacity)
+		sizeClass--;
+
+	buffer.clear();
+	pooledMemory += capacity;
+	freeLists.buffers[sizeClass].push_back(std::move(buffer));
+}
+
+void buffer_pool::setMemoryLimit(size_t bytes) {
+	memoryLimit = bytes;
+}
+
+size_t buffer_pool::memoryUsage() {
+	return pooledMemory;
+}
+
+} // namespace http
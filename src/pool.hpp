@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace http {
+
+// Recycled byte buffers in size classes of 4KiB, 16KiB, 64KiB, 256KiB and 1MiB. Every thread keeps its own free lists,
+// so acquiring and releasing takes no lock; the memory held by all of them together is capped.
+class buffer_pool {
+  public:
+	// An empty string with a capacity of at least size, recycled if possible
+	static std::string acquire(size_t size);
+
+	// Keeps the buffer for reuse, unless it is too small or too large, or the pool is full
+	static void release(std::string &&buffer);
+
+	static void setMemoryLimit(size_t bytes); // of all threads together, default 16MiB
+	static size_t memoryUsage();
+
+	// Releases its buffer when it goes out of scope
+	class buffer {
+	  public:
+		explicit buffer(size_t size) : _buffer(acquire(size)) {}
+		~buffer() {
+			release(std::move(_buffer));
+		}
+
+		buffer(const buffer &) = delete;
+		buffer &operator=(const buffer &) = delete;
+
+		std::string &operator*() {
+			return _buffer;
+		}
+		std::string *operator->() {
+			return &_buffer;
+		}
+
+	  private:
+		std::string _buffer;
+	}; // buffer
+}; // buffer_pool
+
+} // namespace http
@@ -0,0 +1,228 @@
+#include "profiler.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <charconv>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cxxabi.h>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// OS-SPECIFIC INCLUDES TODO: CHANGE WHEN IMPLEMENTING CROSS-PLATFORM SUPPORT
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <sys/time.h>
+
+#include "exception.hpp"
+
+using namespace std::string_literals;
+
+namespace http {
+
+namespace {
+
+constexpr int maxDepth = 64;
+constexpr int skippedFrames = 2; // the signal handler and the signal trampoline
+constexpr size_t maxSamples = 128 * 1024;
+
+struct sample {
+	profiler::stage stage;
+	int depth;
+	void *frames[maxDepth];
+};
+
+// Allocated for each profile without being initialized, so only the pages of the samples taken are touched
+std::unique_ptr<sample[]> samples;
+size_t capacity = 0;
+std::atomic<size_t> taken = 0;
+std::atomic<size_t> dropped = 0;
+
+std::atomic<bool> sampling = false;
+std::atomic<int> inHandler = 0; // the samples are read once no handler can write to them anymore
+
+std::mutex running;
+
+std::string symbolize(void *address, bool returnAddress) {
+	// a return address points past the call, which may be the first instruction of the next function
+	const char *pc = static_cast<const char *>(address) - (returnAddress ? 1 : 0);
+
+	Dl_info info;
+	if (dladdr(pc, &info) == 0 || info.dli_fname == nullptr) {
+		char buffer[32];
+		std::snprintf(buffer, sizeof(buffer), "%p", address);
+		return buffer;
+	}
+
+	if (info.dli_sname) {
+		int status;
+		char *demangled = abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status);
+		std::string name = status == 0 ? demangled : info.dli_sname;
+		std::free(demangled);
+		std::replace(name.begin(), name.end(), ';', ':'); // the frame separator
+		return name;
+	}
+
+	const char *module = std::strrchr(info.dli_fname, '/');
+	char buffer[32];
+	std::snprintf(buffer, sizeof(buffer), "+0x%zx", static_cast<size_t>(pc - static_cast<const char *>(info.dli_fbase)));
+	return (module ? module + 1 : info.dli_fname) + std::string(buffer);
+}
+
+const char *stageName(profiler::stage stage) {
+	switch (stage) {
+	case profiler::stage::OTHER:
+		return "[other]";
+	case profiler::stage::RECV:
+		return "[recv]";
+	case profiler::stage::PARSE:
+		return "[parse]";
+	case profiler::stage::HANDLER:
+		return "[handler]";
+	case profiler::stage::SEND:
+		return "[send]";
+	}
+	return "[other]";
+}
+
+} // namespace
+
+void profiler::onSignal(int) {
+	const int savedErrno = errno;
+	inHandler.fetch_add(1);
+
+	if (sampling.load()) {
+		const size_t index = taken.fetch_add(1, std::memory_order_relaxed);
+		if (index < capacity) {
+			sample &sample = samples[index];
+			void *frames[maxDepth + skippedFrames];
+			const int depth = backtrace(frames, maxDepth + skippedFrames) - skippedFrames;
+
+			sample.stage = _stage;
+			sample.depth = std::max(depth, 0);
+			std::memcpy(sample.frames, frames + skippedFrames, sample.depth * sizeof(void *));
+		} else {
+			dropped.fetch_add(1, std::memory_order_relaxed);
+		}
+	}
+
+	inHandler.fetch_sub(1);
+	errno = savedErrno;
+}
+
+std::string profiler::profile(unsigned seconds, unsigned frequency) {
+	std::unique_lock lock(running, std::try_to_lock);
+	if (!lock.owns_lock())
+		throw "A profile is already running"s;
+
+	frequency = std::clamp(frequency, 1u, 1000u);
+
+	// backtrace loads the unwinder on its first call, which must not happen in the signal handler
+	void *warmUp[1];
+	backtrace(warmUp, 1);
+
+	capacity = std::min<size_t>(maxSamples,
+								size_t(seconds) * frequency * std::max(1u, std::thread::hardware_concurrency()) + 16);
+	samples.reset(new sample[capacity]);
+	taken = 0;
+	dropped = 0;
+
+	struct sigaction action = {}, previous;
+	action.sa_handler = onSignal;
+	action.sa_flags = SA_RESTART;
+	sigemptyset(&action.sa_mask);
+	if (sigaction(SIGPROF, &action, &previous) < 0)
+		throw "Failed to install the SIGPROF handler: "s + std::strerror(errno);
+
+	sampling = true;
+
+	itimerval timer = {};
+	timer.it_interval.tv_sec = frequency == 1 ? 1 : 0;
+	timer.it_interval.tv_usec = frequency == 1 ? 0 : 1000000 / frequency;
+	timer.it_value = timer.it_interval;
+	if (setitimer(ITIMER_PROF, &timer, nullptr) < 0) {
+		const int error = errno;
+		sampling = false;
+		sigaction(SIGPROF, &previous, nullptr);
+		throw "Failed to start the profiling timer: "s + std::strerror(error);
+	}
+
+	std::this_thread::sleep_for(std::chrono::seconds(seconds));
+
+	const itimerval stopped = {};
+	setitimer(ITIMER_PROF, &stopped, nullptr);
+	sampling = false;
+	while (inHandler.load() != 0) // a signal already delivered to another thread
+		std::this_thread::yield();
+	sigaction(SIGPROF, &previous, nullptr);
+
+	// the stacks are counted by address first, every distinct address is only symbolized once
+	std::map<std::pair<profiler::stage, std::vector<void *>>, size_t> stacks;
+	const size_t count = std::min(taken.load(), capacity);
+	for (size_t i = 0; i < count; i++)
+		stacks[{samples[i].stage, std::vector<void *>(samples[i].frames, samples[i].frames + samples[i].depth)}]++;
+	samples.reset();
+
+	std::unordered_map<void *, std::string> symbols;
+	std::map<std::string, size_t> collapsed; // distinct addresses may still be the same functions
+	for (const auto &[key, hits] : stacks) {
+		const auto &[stage, frames] = key;
+
+		std::string line = stageName(stage);
+		for (size_t i = frames.size(); i-- > 0;) { // outermost first
+			auto symbol = symbols.find(frames[i]);
+			if (symbol == symbols.end())
+				symbol = symbols.emplace(frames[i], symbolize(frames[i], i > 0)).first;
+			line += ';';
+			line += symbol->second;
+		}
+		collapsed[line] += hits;
+	}
+
+	std::string result;
+	for (const auto &[line, hits] : collapsed)
+		result += line + " "s + std::to_string(hits) + "\n"s;
+	if (dropped > 0)
+		result += "[dropped] "s + std::to_string(dropped) + "\n"s;
+	return result;
+}
+
+bool profiler::respond(request &req) {
+	const auto parameter = [&req](const std::string &name, unsigned fallback, unsigned max) {
+		const auto found = req.url.searchParams.find(name);
+		if (found == req.url.searchParams.end())
+			return fallback;
+
+		const std::string &value = found->second;
+		unsigned result;
+		const auto [end, status] = std::from_chars(value.data(), value.data() + value.length(), result);
+		if (status != std::errc() || end != value.data() + value.length() || result == 0 || result > max)
+			throw exception(400, "Invalid "s + name + ", expected 1 to "s + std::to_string(max));
+		return result;
+	};
+
+	const unsigned seconds = parameter("seconds", 10, 300);
+	const unsigned frequency = parameter("frequency", 99, 1000);
+
+	std::string stacks;
+	try {
+		stacks = profile(seconds, frequency);
+	} catch (const std::string &error) {
+		throw exception(409, error);
+	}
+
+	req.response().setStatus(200);
+	req.response().setContentType(content_type::TEXT_PLAIN);
+	req.response().setContentString(stacks);
+	return req.response().send();
+}
+
+} // namespace http
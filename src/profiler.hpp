@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "request.hpp"
+
+namespace http {
+
+// In-process sampling profiler for when perf cannot be attached. While a profile runs, SIGPROF interrupts whichever
+// thread is using the CPU frequency times per second of CPU time; the handler records the stack of that thread and
+// the stage of the request it was in. Once the profile ends the stacks are symbolized and returned collapsed, one
+// "[stage];outermost;...;innermost count" line per distinct stack, ready for flamegraph.pl.
+//
+// Frames are unwound with backtrace(), from the unwind tables, so frame pointers are not needed; functions are named
+// with dladdr, so link with -rdynamic to see the ones of the executable, otherwise they show as executable+offset.
+class profiler {
+  public:
+	// What a thread is doing for the request it serves, maintained by the server
+	enum class stage : uint8_t {
+		OTHER, // accepting, logging, not serving a request
+		RECV,
+		PARSE,
+		HANDLER,
+		SEND,
+	}; // stage
+
+	// Sets the stage of the calling thread until the scope ends
+	class scope {
+	  public:
+		explicit scope(stage stage) : _previous(_stage) {
+			_stage = stage;
+		}
+		~scope() {
+			_stage = _previous;
+		}
+
+		scope(const scope &) = delete;
+		scope &operator=(const scope &) = delete;
+
+	  private:
+		const stage _previous;
+	}; // scope
+
+	// Sets the stage of the calling thread, a single store to a thread local so it is always maintained
+	static void enter(stage stage) {
+		_stage = stage;
+	}
+
+	// Samples the process for seconds, blocking the calling thread, and returns the collapsed stacks. One profile runs
+	// at a time, throws std::string if another one is running.
+	static std::string profile(unsigned seconds, unsigned frequency = 99);
+
+	// Handler for an admin route: profiles for ?seconds= (default 10) at ?frequency= (default 99) and answers with
+	// the collapsed stacks. It blocks the thread it runs on, so offload it to a handler pool (see
+	// server::setHandlerPool) or the server stops serving the requests it should be sampling.
+	static bool respond(request &req);
+
+  private:
+	static void onSignal(int);
+
+	static inline thread_local volatile stage _stage = stage::OTHER;
+}; // profiler
+
+} // namespace http
@@ -0,0 +1,599 @@
+#include "proxy.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+// OS-SPECIFIC INCLUDES TODO: CHANGE WHEN IMPLEMENTING CROSS-PLATFORM SUPPORT
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <unistd.h>
+
+#include "exception.hpp"
+#include "io.hpp"
+
+using namespace std::string_literals;
+
+namespace http {
+
+namespace {
+
+// Buffered reads from an upstream connection
+struct upstream_reader {
+	int fd;
+	std::string buffer;
+	size_t pos = 0;
+
+	explicit upstream_reader(int fd) : fd(fd) {}
+
+	std::string_view available() const {
+		return std::string_view(buffer).substr(pos);
+	}
+
+	void consume(size_t length) {
+		pos += length;
+		if (pos == buffer.length()) {
+			buffer.clear();
+			pos = 0;
+		}
+	}
+
+	bool fill() {
+		char chunk[16384];
+		ssize_t bytesread;
+		do {
+			bytesread = recv(fd, chunk, sizeof(chunk), 0);
+		} while (bytesread < 0 && errno == EINTR);
+
+		if (bytesread <= 0)
+			return false;
+
+		buffer.append(chunk, bytesread);
+		return true;
+	}
+
+	// Without the CRLF, valid until the next read
+	bool readLine(std::string_view &line) {
+		size_t end;
+		while ((end = available().find("\r\n")) == std::string_view::npos) {
+			if (available().length() > 8192 || !fill())
+				return false;
+		}
+
+		line = available().substr(0, end);
+		pos += end + 2; // consumed, but the buffer is kept until the next read
+		return true;
+	}
+};
+
+// Where the upstream response goes: straight to the client, or into the response content
+struct response_sink {
+	int clientfd; // -1 if buffering
+	std::string &content;
+
+	bool write(std::string_view data) {
+		if (clientfd < 0) {
+			content += data;
+			return true;
+		}
+		return writeAll(clientfd, data);
+	}
+
+	// length bytes of body, SIZE_MAX for everything until the upstream closes the connection
+	bool relay(upstream_reader &reader, size_t length) {
+		const size_t buffered = std::min(length, reader.available().length());
+		if (!write(reader.available().substr(0, buffered)))
+			return false;
+		reader.consume(buffered);
+
+		if (length != SIZE_MAX)
+			length -= buffered;
+
+		if (clientfd >= 0) {
+			const size_t moved = ::http::relay(reader.fd, clientfd, length);
+			return length == SIZE_MAX || moved == length;
+		}
+
+		while (length > 0) {
+			if (!reader.fill())
+				return length == SIZE_MAX;
+
+			const size_t n = std::min(length, reader.available().length());
+			content += reader.available().substr(0, n);
+			reader.consume(n);
+			if (length != SIZE_MAX)
+				length -= n;
+		}
+		return true;
+	}
+};
+
+bool containsToken(std::string_view list, std::string_view token) {
+	size_t start = 0;
+	while (start <= list.length()) {
+		size_t end = list.find(',', start);
+		if (end == std::string_view::npos)
+			end = list.length();
+
+		std::string_view item = list.substr(start, end - start);
+		while (!item.empty() && (item.front() == ' ' || item.front() == '\t'))
+			item.remove_prefix(1);
+		while (!item.empty() && (item.back() == ' ' || item.back() == '\t'))
+			item.remove_suffix(1);
+
+		if (equalsIgnoreCase(item, token))
+			return true;
+
+		start = end + 1;
+	}
+	return false;
+}
+
+// Hop-by-hop headers apply to a single connection and are never forwarded (RFC 9110 section 7.6.1)
+bool isHopByHop(std::string_view name, std::string_view connection) {
+	constexpr std::string_view hopByHop[] = {"Connection", "Keep-Alive",		"Proxy-Connection", "TE",
+											 "Trailer",	   "Transfer-Encoding", "Upgrade",			"HTTP2-Settings"};
+
+	for (const std::string_view header : hopByHop) {
+		if (equalsIgnoreCase(name, header))
+			return true;
+	}
+	return containsToken(connection, name);
+}
+
+std::string peerAddress(int fd) {
+	sockaddr_storage address;
+	socklen_t length = sizeof(address);
+	if (fd < 0 || getpeername(fd, reinterpret_cast<sockaddr *>(&address), &length) < 0)
+		return "";
+
+	char buffer[INET6_ADDRSTRLEN] = "";
+	if (address.ss_family == AF_INET) {
+		inet_ntop(AF_INET, &reinterpret_cast<sockaddr_in *>(&address)->sin_addr, buffer, sizeof(buffer));
+	} else if (address.ss_family == AF_INET6) {
+		inet_ntop(AF_INET6, &reinterpret_cast<sockaddr_in6 *>(&address)->sin6_addr, buffer, sizeof(buffer));
+	}
+	return buffer;
+}
+
+} // namespace
+
+proxy::proxy(balancing balancing) : _balancing(balancing) {
+}
+
+proxy::~proxy() {
+	{
+		std::lock_guard lock(_mutex);
+		_stopping = true;
+	}
+	_stop.notify_all();
+
+	if (_healthChecker.joinable())
+		_healthChecker.join();
+
+	for (const auto &upstream : _upstreams) {
+		for (const int fd : upstream->idle)
+			close(fd);
+	}
+}
+
+void proxy::addUpstream(const std::string &host, uint16_t port) {
+	addrinfo hints = {};
+	hints.ai_family = AF_UNSPEC;
+	hints.ai_socktype = SOCK_STREAM;
+
+	addrinfo *result;
+	const int status = getaddrinfo(host.c_str(), std::to_string(port).c_str(), &hints, &result);
+	if (status != 0)
+		throw exception(500, "Failed to resolve upstream "s + host + ": "s + gai_strerror(status));
+
+	auto added = std::make_unique<upstream>();
+	added->name = host + ":"s + std::to_string(port);
+	std::memcpy(&added->address, result->ai_addr, result->ai_addrlen);
+	added->addressLength = result->ai_addrlen;
+	freeaddrinfo(result);
+
+	std::lock_guard lock(_mutex);
+	_upstreams.push_back(std::move(added));
+}
+
+void proxy::setHealthCheck(const std::string &path, unsigned intervalSeconds) {
+	std::lock_guard lock(_mutex);
+	_healthCheckPath = path;
+	_healthCheckInterval = std::chrono::seconds(std::max(1u, intervalSeconds));
+
+	if (!_healthChecker.joinable())
+		_healthChecker = std::thread(&proxy::checkHealth, this);
+}
+
+void proxy::setMaxIdleConnections(size_t perUpstream) {
+	std::lock_guard lock(_mutex);
+	_maxIdleConnections = perUpstream;
+}
+
+void proxy::setTimeout(unsigned seconds) {
+	_timeout = seconds;
+}
+
+proxy::upstream *proxy::pick(const std::vector<upstream *> &tried) {
+	std::lock_guard lock(_mutex);
+
+	upstream *picked = nullptr;
+	for (size_t i = 0; i < _upstreams.size(); i++) {
+		const size_t index = (_next + i) % _upstreams.size();
+		upstream *candidate = _upstreams[index].get();
+
+		if (!candidate->healthy || std::find(tried.begin(), tried.end(), candidate) != tried.end())
+			continue;
+
+		if (_balancing == balancing::ROUND_ROBIN) {
+			picked = candidate;
+			_next = index + 1;
+			break;
+		}
+
+		if (!picked || candidate->active < picked->active)
+			picked = candidate;
+	}
+
+	if (picked)
+		picked->active++;
+	return picked;
+}
+
+int proxy::connect(const upstream &upstream) const {
+	const int fd = socket(upstream.address.ss_family, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	if (fd < 0)
+		return -1;
+
+	// on Linux the send timeout also bounds connect
+	const timeval timeout = {static_cast<time_t>(_timeout), 0};
+	setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+	setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+	const int enable = 1;
+	setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+
+	if (::connect(fd, reinterpret_cast<const sockaddr *>(&upstream.address), upstream.addressLength) < 0) {
+		close(fd);
+		return -1;
+	}
+
+	return fd;
+}
+
+int proxy::acquire(upstream &upstream, bool &reused) {
+	{
+		std::lock_guard lock(_mutex);
+
+		while (!upstream.idle.empty()) {
+			const int fd = upstream.idle.back();
+			upstream.idle.pop_back();
+
+			// an idle connection must have nothing to read, otherwise the upstream closed it
+			char byte;
+			if (recv(fd, &byte, 1, MSG_PEEK | MSG_DONTWAIT) < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+				reused = true;
+				return fd;
+			}
+			close(fd);
+		}
+	}
+
+	reused = false;
+	return connect(upstream);
+}
+
+void proxy::release(upstream &upstream, int fd, bool reusable) {
+	std::lock_guard lock(_mutex);
+	upstream.active--;
+
+	if (fd < 0)
+		return;
+
+	if (reusable && upstream.idle.size() < _maxIdleConnections) {
+		upstream.idle.push_back(fd);
+	} else {
+		close(fd);
+	}
+}
+
+bool proxy::handle(request &req) {
+	response &res = req.response();
+	request_body &body = req.body();
+
+	std::string head;
+	{ // the request head sent upstream
+		const std::string_view connection = req.getHeader(header::CONNECTION);
+		std::string_view target = std::string_view(req.url.href).substr(req.url.origin.length());
+		if (target.empty())
+			target = "/";
+
+		head += methodToString(req.method);
+		head += ' ';
+		head += target;
+		head += " HTTP/1.1\r\n";
+
+		for (const auto &[name, value] : req.headers()) {
+			if (isHopByHop(name, connection) || equalsIgnoreCase(name, "Content-Length") ||
+				equalsIgnoreCase(name, "X-Forwarded-For"))
+				continue;
+
+			head += name;
+			head += ": ";
+			head += value;
+			head += "\r\n";
+		}
+
+		std::string forwardedFor(req.getHeader(header::X_FORWARDED_FOR));
+		const std::string peer = peerAddress(res._clientfd);
+		if (!peer.empty())
+			forwardedFor += (forwardedFor.empty() ? ""s : ", "s) + peer;
+		if (!forwardedFor.empty())
+			head += "X-Forwarded-For: "s + forwardedFor + "\r\n"s;
+
+		// set by an earlier proxy, or by us
+		if (!req.headers().has(header::X_FORWARDED_HOST) && req.headers().has(header::HOST))
+			head += "X-Forwarded-Host: "s + std::string(req.getHeader(header::HOST)) + "\r\n"s;
+		if (!req.headers().has(header::X_FORWARDED_PROTO))
+			head += "X-Forwarded-Proto: http\r\n";
+
+		if (body.length() > 0 || req.headers().has(header::CONTENT_LENGTH))
+			head += "Content-Length: "s + std::to_string(body.length()) + "\r\n"s;
+
+		head += "Connection: keep-alive\r\n\r\n";
+	}
+
+	std::vector<upstream *> tried;
+
+	while (true) {
+		upstream *target = pick(tried);
+		if (!target) {
+			res.setStatus(tried.empty() ? 503 : 502);
+			res.setContentString(tried.empty() ? "No healthy upstream" : "Bad gateway");
+			return res.send();
+		}
+
+		bool reused;
+		int fd = acquire(*target, reused);
+
+		upstream_reader reader(fd);
+		bool sent = fd >= 0 && writeAll(fd, head) && body.relay(fd);
+		bool received = sent && reader.fill();
+
+		// a kept-alive connection may have been closed by the upstream in the meantime
+		if (reused && !received && body.length() == 0) {
+			close(fd);
+			fd = connect(*target);
+			reader = upstream_reader(fd);
+			sent = fd >= 0 && writeAll(fd, head);
+			received = sent && reader.fill();
+		}
+
+		if (!received) {
+			if (fd >= 0)
+				close(fd);
+			release(*target, -1, false);
+
+			if (_healthCheckInterval.count() > 0) { // the health checker takes it back once it recovers
+				std::lock_guard lock(_mutex);
+				target->healthy = false;
+			}
+
+			if (body.remaining() < body.length()) { // the body is gone, so no other upstream can be tried
+				res.setStatus(502);
+				res.setContentString("Bad gateway");
+				return res.send();
+			}
+
+			tried.push_back(target);
+			continue;
+		}
+
+		int status = 0;
+		bool keepAlive = true, chunked = false;
+		size_t contentLength = SIZE_MAX;
+		std::string_view statusLine;
+		std::vector<std::pair<std::string_view, std::string_view>> headers;
+
+		bool valid = true;
+		do { // interim responses (1xx) are skipped
+			headers.clear();
+			keepAlive = true;
+			chunked = false;
+			contentLength = SIZE_MAX;
+
+			size_t headEnd;
+			while ((headEnd = reader.available().find("\r\n\r\n")) == std::string_view::npos) {
+				if (reader.available().length() > 65536 || !reader.fill()) {
+					valid = false;
+					break;
+				}
+			}
+			if (!valid)
+				break;
+
+			const std::string_view responseHead = reader.available().substr(0, headEnd + 2);
+			size_t pos = responseHead.find("\r\n");
+			statusLine = responseHead.substr(0, pos);
+
+			if (statusLine.length() < 12 || statusLine.substr(0, 5) != "HTTP/") {
+				valid = false;
+				break;
+			}
+			status = std::atoi(std::string(statusLine.substr(9, 3)).c_str());
+			if (statusLine.substr(0, 8) == "HTTP/1.0")
+				keepAlive = false;
+
+			for (pos += 2; pos < responseHead.length();) {
+				const size_t end = responseHead.find("\r\n", pos);
+				const std::string_view line = responseHead.substr(pos, end - pos);
+				pos = end + 2;
+
+				const size_t colon = line.find(':');
+				if (colon == std::string_view::npos)
+					continue;
+
+				std::string_view value = line.substr(colon + 1);
+				while (!value.empty() && (value.front() == ' ' || value.front() == '\t'))
+					value.remove_prefix(1);
+				while (!value.empty() && (value.back() == ' ' || value.back() == '\t'))
+					value.remove_suffix(1);
+
+				headers.emplace_back(line.substr(0, colon), value);
+			}
+
+			for (const auto &[name, value] : headers) {
+				if (equalsIgnoreCase(name, "Connection")) {
+					if (containsToken(value, "close"))
+						keepAlive = false;
+				} else if (equalsIgnoreCase(name, "Transfer-Encoding")) {
+					chunked = containsToken(value, "chunked");
+				} else if (equalsIgnoreCase(name, "Content-Length")) {
+					contentLength = std::strtoull(std::string(value).c_str(), nullptr, 10);
+				}
+			}
+
+			if (status >= 100 && status < 200) {
+				reader.consume(headEnd + 4);
+				continue;
+			}
+
+			// statusLine and headers stay valid, the buffer is only reallocated by the next read
+			reader.pos += headEnd + 4;
+		} while (status >= 100 && status < 200);
+
+		if (!valid) {
+			close(fd);
+			release(*target, -1, false);
+
+			res.setStatus(502);
+			res.setContentString("Bad gateway");
+			return res.send();
+		}
+
+		std::string_view connection;
+		for (const auto &[name, value] : headers) {
+			if (equalsIgnoreCase(name, "Connection"))
+				connection = value;
+		}
+
+		const bool streaming = res._clientfd >= 0 && !res._sender;
+		res._status = status;
+
+		std::string clientHead;
+		if (streaming) {
+			clientHead += statusLine;
+			clientHead += "\r\n";
+		}
+
+		for (const auto &[name, value] : headers) {
+			if (isHopByHop(name, connection) && !(streaming && chunked && equalsIgnoreCase(name, "Transfer-Encoding")))
+				continue;
+
+			if (streaming) {
+				clientHead += name;
+				clientHead += ": ";
+				clientHead += value;
+				clientHead += "\r\n";
+			} else if (!equalsIgnoreCase(name, "Content-Length") && !equalsIgnoreCase(name, "Date")) {
+				res._headers.add(std::string(name), std::string(value));
+			}
+		}
+
+		if (streaming) {
+			clientHead += "Connection: close\r\n\r\n"; // this server answers one request per connection
+			res._sent = true;
+			res._streamed = true;
+		}
+
+		// statusLine and headers are invalid from here on
+		response_sink sink{streaming ? res._clientfd : -1, res.ownedContent()};
+		bool complete = !streaming || writeAll(res._clientfd, clientHead);
+
+		const bool bodyless = req.method == method::HEAD || status == 204 || status == 304;
+		if (complete && !bodyless) {
+			if (chunked) {
+				std::string_view line;
+				while ((complete = reader.readLine(line))) {
+					const size_t chunkSize = std::strtoull(std::string(line).c_str(), nullptr, 16);
+					if (streaming && !(complete = sink.write(std::string(line) + "\r\n"s)))
+						break;
+
+					if (chunkSize == 0) { // trailers, up to an empty line
+						while ((complete = reader.readLine(line)) && !line.empty()) {
+							if (streaming && !(complete = sink.write(std::string(line) + "\r\n"s)))
+								break;
+						}
+						complete = complete && (!streaming || sink.write("\r\n"));
+						break;
+					}
+
+					if (!(complete = sink.relay(reader, chunkSize) && reader.readLine(line) && line.empty()))
+						break;
+					if (streaming && !(complete = sink.write("\r\n")))
+						break;
+				}
+			} else if (contentLength != SIZE_MAX) {
+				complete = sink.relay(reader, contentLength);
+			} else { // delimited by the upstream closing the connection
+				complete = sink.relay(reader, SIZE_MAX);
+				keepAlive = false;
+			}
+		}
+
+		release(*target, fd, complete && keepAlive && reader.available().empty());
+
+		if (!complete && !streaming) {
+			res._headers.clear();
+			res.setStatus(502);
+			res.setContentString("Bad gateway");
+		}
+
+		return res.send();
+	}
+}
+
+void proxy::checkHealth() {
+	std::unique_lock lock(_mutex);
+
+	while (!_stopping) {
+		std::vector<upstream *> upstreams;
+		for (const auto &upstream : _upstreams)
+			upstreams.push_back(upstream.get());
+		const std::string path = _healthCheckPath;
+
+		lock.unlock();
+
+		for (upstream *upstream : upstreams) {
+			bool healthy = false;
+
+			const int fd = connect(*upstream);
+			if (fd >= 0) {
+				const std::string check = "GET "s + path + " HTTP/1.1\r\nHost: "s + upstream->name +
+										  "\r\nConnection: close\r\n\r\n"s;
+
+				upstream_reader reader(fd);
+				std::string_view statusLine;
+				if (writeAll(fd, check) && reader.readLine(statusLine) && statusLine.length() >= 12) {
+					const int status = std::atoi(std::string(statusLine.substr(9, 3)).c_str());
+					healthy = status >= 200 && status < 400;
+				}
+
+				close(fd);
+			}
+
+			std::lock_guard upstreamLock(_mutex);
+			upstream->healthy = healthy;
+		}
+
+		lock.lock();
+		_stop.wait_for(lock, _healthCheckInterval, [this]() {
+			return _stopping;
+		});
+	}
+}
+
+} // namespace http
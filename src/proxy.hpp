@@ -0,0 +1,90 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// OS-SPECIFIC INCLUDES TODO: CHANGE WHEN IMPLEMENTING CROSS-PLATFORM SUPPORT
+#include <sys/socket.h>
+
+#include "request.hpp"
+
+namespace http {
+
+// Reverse proxy handler relaying requests to a set of HTTP/1.1 upstreams over pooled keep-alive connections:
+//
+//	http::proxy backends;
+//	backends.addUpstream("127.0.0.1", 8081);
+//	backends.addUpstream("127.0.0.1", 8082);
+//	backends.setHealthCheck("/health", 5);
+//	http::server server([&backends](http::request &req) { return backends.handle(req); }, dispatchError);
+//
+// Over HTTP/1.1 the upstream response is relayed to the client as it arrives (with splice where possible), over
+// HTTP/2 it is read into the response first.
+class proxy {
+  public:
+	enum class balancing {
+		ROUND_ROBIN,
+		LEAST_CONNECTIONS,
+	}; // balancing
+
+	explicit proxy(balancing balancing = balancing::ROUND_ROBIN);
+	~proxy();
+
+	proxy(const proxy &) = delete;
+	proxy &operator=(const proxy &) = delete;
+
+	// Resolved once, throws http::exception if the host cannot be resolved
+	void addUpstream(const std::string &host, uint16_t port);
+
+	// Periodically GETs path from every upstream, those not answering with 2xx or 3xx receive no requests until
+	// they do again. Without health checks every upstream is always considered healthy.
+	void setHealthCheck(const std::string &path, unsigned intervalSeconds);
+
+	void setMaxIdleConnections(size_t perUpstream); // default 32
+	void setTimeout(unsigned seconds);				// for connecting, sending and receiving, default 30
+
+	// Answers 503 if no upstream is healthy and 502 if none could be reached
+	bool handle(request &req);
+
+  private:
+	struct upstream {
+		std::string name; // host:port, sent as Host to health checks
+		sockaddr_storage address;
+		socklen_t addressLength;
+
+		std::vector<int> idle; // keep-alive connections
+		size_t active = 0;
+		bool healthy = true;
+	};
+
+	upstream *pick(const std::vector<upstream *> &tried);
+	int connect(const upstream &upstream) const;
+	int acquire(upstream &upstream, bool &reused);
+	void release(upstream &upstream, int fd, bool reusable);
+
+	void checkHealth();
+
+	const balancing _balancing;
+
+	std::mutex _mutex;
+	std::vector<std::unique_ptr<upstream>> _upstreams;
+	size_t _next = 0;
+
+	size_t _maxIdleConnections = 32;
+	unsigned _timeout = 30;
+
+	std::string _healthCheckPath;
+	std::chrono::seconds _healthCheckInterval{0};
+	bool _stopping = false;
+	std::condition_variable _stop;
+	std::thread _healthChecker;
+}; // proxy
+
+} // namespace http
@@ -0,0 +1,85 @@
+#include "rate_limit.hpp"
+
+#include <algorithm>
+
+namespace http {
+
+rate_limiter::rate_limiter(double requestsPerSecond, double requestBurst, size_t maxClients)
+	: _requestsPerSecond(requestsPerSecond), _requestBurst(std::max(1.0, requestBurst)),
+	  _maxClientsPerShard(std::max<size_t>(1, maxClients / shardCount)) {
+}
+
+void rate_limiter::setByteLimit(double bytesPerSecond, double byteBurst) {
+	_bytesPerSecond = bytesPerSecond;
+	_byteBurst = byteBurst;
+}
+
+void rate_limiter::trustProxy(std::string address) {
+	_trustedProxies.push_back(std::move(address));
+}
+
+bool rate_limiter::isTrustedProxy(std::string_view address) const {
+	return std::find(_trustedProxies.begin(), _trustedProxies.end(), address) != _trustedProxies.end();
+}
+
+rate_limiter::bucket &rate_limiter::find(shard &shard, std::string_view client, clock::time_point now) {
+	auto it = shard.index.find(client);
+
+	if (it != shard.index.end()) {
+		shard.buckets.splice(shard.buckets.begin(), shard.buckets, it->second);
+
+		bucket &found = *it->second;
+		const double elapsed = std::chrono::duration<double>(now - found.refilled).count();
+		found.requests = std::min(_requestBurst, found.requests + elapsed * _requestsPerSecond);
+		found.bytes = std::min(_byteBurst, found.bytes + elapsed * _bytesPerSecond);
+		found.refilled = now;
+		return found;
+	}
+
+	if (shard.buckets.size() >= _maxClientsPerShard) { // the least recently seen client starts over when it returns
+		shard.index.erase(shard.buckets.back().client);
+		shard.buckets.pop_back();
+	}
+
+	shard.buckets.push_front({std::string(client), _requestBurst, _byteBurst, now});
+	shard.index.emplace(shard.buckets.front().client, shard.buckets.begin());
+	return shard.buckets.front();
+}
+
+bool rate_limiter::admit(std::string_view client, size_t requestBytes) {
+	const auto now = clock::now();
+	shard &shard = _shards[std::hash<std::string_view>()(client) % shardCount];
+
+	std::lock_guard lock(shard.mutex);
+	bucket &bucket = find(shard, client, now);
+
+	if (bucket.requests < 1 || (_bytesPerSecond > 0 && bucket.bytes <= 0))
+		return false;
+
+	bucket.requests -= 1;
+	if (_bytesPerSecond > 0)
+		bucket.bytes -= requestBytes;
+	return true;
+}
+
+void rate_limiter::charge(std::string_view client, size_t responseBytes) {
+	if (_bytesPerSecond <= 0)
+		return;
+
+	const auto now = clock::now();
+	shard &shard = _shards[std::hash<std::string_view>()(client) % shardCount];
+
+	std::lock_guard lock(shard.mutex);
+	find(shard, client, now).bytes -= responseBytes;
+}
+
+size_t rate_limiter::clients() {
+	size_t count = 0;
+	for (shard &shard : _shards) {
+		std::lock_guard lock(shard.mutex);
+		count += shard.buckets.size();
+	}
+	return count;
+}
+
+} // namespace http
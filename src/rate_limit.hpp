@@ -0,0 +1,75 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <list>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace http {
+
+// Opt-in per-client rate limiting, shared by any number of servers (see server::setRateLimiter). Every client has a
+// token bucket for requests and, optionally, one for bytes (the request as received plus the response); buckets are
+// refilled lazily when the client is seen again. Requests over the limit are answered with a pre-serialized 429 before
+// anything else happens. The table is split into shards with a lock each, every shard evicting its least recently seen
+// clients past its share of maxClients.
+class rate_limiter {
+  public:
+	using clock = std::chrono::steady_clock;
+
+	static constexpr std::string_view tooManyRequests = "HTTP/1.1 429 Too Many Requests\r\n"
+														"Content-Type: text/plain\r\n"
+														"Content-Length: 17\r\n"
+														"Retry-After: 1\r\n"
+														"\r\n"
+														"Too Many Requests";
+
+	rate_limiter(double requestsPerSecond, double requestBurst, size_t maxClients = 65536);
+
+	void setByteLimit(double bytesPerSecond, double byteBurst); // before any request, unlimited by default
+
+	// Before any request: clients are their peer address unless it is a trusted proxy, then the rightmost
+	// X-Forwarded-For address that is not one. address is formatted as the peer is, eg. "10.0.0.1", "::1", or "unix"
+	// for the peers of Unix socket listeners. Nothing is trusted by default, the client sets X-Forwarded-For.
+	void trustProxy(std::string address);
+	bool isTrustedProxy(std::string_view address) const;
+
+	// Takes a request token and requestBytes byte tokens, false if the client is over either limit
+	bool admit(std::string_view client, size_t requestBytes = 0);
+
+	// Charges the response, which may leave the byte bucket in debt until it refills
+	void charge(std::string_view client, size_t responseBytes);
+
+	size_t clients();
+
+  private:
+	static constexpr size_t shardCount = 64;
+
+	struct bucket {
+		std::string client;
+		double requests;
+		double bytes;
+		clock::time_point refilled;
+	};
+
+	struct shard {
+		std::mutex mutex;
+		std::list<bucket> buckets;										   // most recently seen first
+		std::unordered_map<std::string_view, std::list<bucket>::iterator> index; // keys view bucket::client
+	};
+
+	bucket &find(shard &shard, std::string_view client, clock::time_point now); // with shard.mutex held
+
+	const double _requestsPerSecond, _requestBurst;
+	double _bytesPerSecond = 0, _byteBurst = 0; // no byte limit if 0
+	const size_t _maxClientsPerShard;
+	std::vector<std::string> _trustedProxies;
+
+	std::array<shard, shardCount> _shards;
+}; // rate_limiter
+
+} // namespace http
@@ -2,20 +2,25 @@
 
 namespace http {
 
-request::request(int clientfd, ::http::method method, const ::http::url &url,
-				 const std::unordered_map<std::string, std::string> &headers,
-				 const std::unordered_map<std::string, std::string> &payload)
-	: method(method), url(url), _response(clientfd), _headers(headers), _payload(payload) {
+request::request(int clientfd, ::http::method method, const ::http::url &url, const request_headers &headers,
+				 const std::unordered_map<std::string, std::string> &payload, request_body body)
+	: method(method), url(url), _response(clientfd), _headers(headers), _payload(payload), _body(body) {
 }
 
 response &request::response() {
 	return _response;
 }
 
-const std::string &request::getHeader(const std::string &name) {
-	const static std::string empty = {};
-	auto it = _headers.find(name);
-	return (it == _headers.end()) ? empty : it->second;
+std::string_view request::getHeader(std::string_view name) const {
+	return _headers.get(name);
+}
+
+std::string_view request::getHeader(header name) const {
+	return _headers.get(name);
+}
+
+const request_headers &request::headers() const {
+	return _headers;
 }
 
 const std::string &request::getPayloadParameter(const std::string &key) {
@@ -24,4 +29,16 @@ const std::string &request::getPayloadParameter(const std::string &key) {
 	return (it == _payload.end()) ? empty : it->second;
 }
 
-} // namespace http
\ No newline at end of file
+request_body &request::body() {
+	return _body;
+}
+
+const std::optional<peer_credentials> &request::peerCredentials() const {
+	return _peerCredentials;
+}
+
+bool request::isOffloaded() const {
+	return _offloaded;
+}
+
+} // namespace http
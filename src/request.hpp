@@ -1,29 +1,60 @@
 #pragma once
 
+#include <optional>
+#include <string_view>
+
+// OS-SPECIFIC INCLUDES TODO: CHANGE WHEN IMPLEMENTING CROSS-PLATFORM SUPPORT
+#include <sys/types.h>
+
+#include "body.hpp"
 #include "method.hpp"
 #include "url.hpp"
+#include "headers.hpp"
 #include "response.hpp"
 
 namespace http {
 
+// SO_PEERCRED, the process on the other end of a Unix domain socket when it connected
+struct peer_credentials {
+	pid_t pid;
+	uid_t uid;
+	gid_t gid;
+}; // peer_credentials
+
 struct request {
-	request(int clientfd, ::http::method method, const ::http::url &url,
-			const std::unordered_map<std::string, std::string> &headers,
-			const std::unordered_map<std::string, std::string> &payload);
+	request(int clientfd, ::http::method method, const ::http::url &url, const request_headers &headers,
+			const std::unordered_map<std::string, std::string> &payload, request_body body = {});
 
 	const ::http::method method;
 	const ::http::url &url;
 
 	::http::response &response();
 
-	const std::string &getHeader(const std::string &name);
+	std::string_view getHeader(std::string_view name) const; // case-insensitive, empty if not present
+	std::string_view getHeader(header name) const;
+	const request_headers &headers() const;
+
 	const std::string &getPayloadParameter(const std::string &key);
 
+	// Bodies the server does not parse itself (anything but application/x-www-form-urlencoded) are left to the handler
+	request_body &body();
+
+	// Only for clients connected to a Unix domain socket listener (see listener::path)
+	const std::optional<peer_credentials> &peerCredentials() const;
+
+	// The handler runs on a handler pool (see server::setHandlerPool), not on the thread accepting connections
+	bool isOffloaded() const;
+
   private:
+	friend class server;
+
 	::http::response _response;
 
-	const std::unordered_map<std::string, std::string> &_headers;
+	const request_headers &_headers;
 	const std::unordered_map<std::string, std::string> &_payload; // POST-only
+	request_body _body;
+	std::optional<peer_credentials> _peerCredentials;
+	bool _offloaded = false;
 
 }; // request
 
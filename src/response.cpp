@@ -1,16 +1,19 @@
 #include "response.hpp"
 
-#include <fstream>
+#include <charconv>
+#include <ctime>
 #include <sstream>
 
 // OS-SPECIFIC INCLUDES TODO: CHANGE WHEN IMPLEMENTING CROSS-PLATFORM SUPPORT
 #include <unistd.h>
 
+#include "accounting.hpp"
 #include "exception.hpp"
+#include "io.hpp"
 #include "log.hpp"
-
-std::string httpStatusCodeToString(int code);				  // forward-declaration
-std::string httpContentTypeToString(http::content_type type); // forward-declaration
+#include "pool.hpp"
+#include "profiler.hpp"
+#include "status.hpp"
 
 using namespace std::string_literals;
 
@@ -21,6 +24,7 @@ response::response(int clientfd) : _clientfd(clientfd) {
 
 response::~response() {
 	send();
+	buffer_pool::release(std::move(_content));
 }
 
 int response::status() {
@@ -28,37 +32,154 @@ int response::status() {
 }
 
 size_t response::size() {
-	return _content.length();
+	return content().length();
 }
 
 void response::setStatus(int status) {
 	_status = status;
+	_preparedFields = {};
 }
 
 void response::setHeader(const std::string &key, const std::string &value) {
-	_headers[key] = value;
+	_headers.set(key, value);
+	_preparedFields = {};
 }
 
 void response::setContentType(const http::content_type content_type) {
 	_content_type = content_type;
+	_preparedFields = {};
 }
 
-void response::setContentString(const std::string &content) {
-	_content = content;
+void response::setContentString(std::string_view content) {
+	std::string &owned = ownedContent();
+	if (owned.capacity() < content.length()) {
+		buffer_pool::release(std::move(owned));
+		owned = buffer_pool::acquire(content.length());
+	}
+	owned.assign(content);
+	accounting::copied(content.length());
 }
 
-bool response::send() {
-	std::string res;
+void response::setContentOwned(std::string &&content) {
+	buffer_pool::release(std::move(ownedContent()));
+	_content = std::move(content);
+}
+
+void response::setContentView(std::string_view content) {
+	_preparedFields = {};
+	_content.clear();
+	_borrowed = content;
+	_isBorrowed = true;
+	_keepAlive.reset();
+}
 
-	res += "HTTP/1.1 "s + httpStatusCodeToString(_status) + "\r\n"s;
-	for (auto &[k, v] : _headers)
-		res += k + ": " + v + "\r\n"s;
-	res += "Content-Type: "s + httpContentTypeToString(_content_type) + "\r\n"s;
-	res += "Content-Length: "s + std::to_string(_content.size()) + "\r\n"s;
-	res += "\r\n"s;
-	res += _content;
+void response::setContentShared(std::shared_ptr<const std::string> content) {
+	setContentView(content ? std::string_view(*content) : std::string_view());
+	_keepAlive = std::move(content);
+}
+
+void response::setContentMapped(std::shared_ptr<const mapped_file> file, size_t offset, size_t length) {
+	const std::string_view mapped = file ? file->content() : std::string_view();
+	setContentView(mapped.substr(std::min(offset, mapped.length()), length));
+	_keepAlive = std::move(file);
+}
 
-	return write(_clientfd, res.data(), res.length()) >= 0;
+std::string_view response::content() const {
+	return _isBorrowed ? _borrowed : std::string_view(_content);
+}
+
+std::string &response::ownedContent() {
+	_preparedFields = {};
+	_borrowed = {};
+	_isBorrowed = false;
+	_keepAlive.reset();
+	return _content;
+}
+
+// rendered at most once per second on each thread
+std::string_view response::dateHeader() {
+	thread_local char buffer[64];
+	thread_local size_t length = 0;
+	thread_local std::time_t renderedAt = -1;
+
+	const std::time_t now = std::time(nullptr);
+	if (now != renderedAt) {
+		std::tm tm;
+		gmtime_r(&now, &tm);
+		length = std::strftime(buffer, sizeof(buffer), "Date: %a, %d %b %Y %H:%M:%S GMT\r\n", &tm);
+		renderedAt = now;
+	}
+
+	return std::string_view(buffer, length);
+}
+
+std::string response::head() const {
+	std::string head;
+	writeHead(head);
+	return head;
+}
+
+void response::writeHead(std::string &head) const {
+	std::string_view statusLine = ::http::statusLine(_status);
+	std::string unknownStatusLine;
+	if (statusLine.empty()) {
+		unknownStatusLine = "HTTP/1.1 "s + std::to_string(_status) + "\r\n"s;
+		statusLine = unknownStatusLine;
+	}
+
+	if (!_preparedFields.empty()) { // only the Date changes
+		head += statusLine;
+		head += dateHeader();
+		head += _preparedFields;
+		return;
+	}
+
+	char contentLength[32] = "Content-Length: ";
+	char *contentLengthEnd = std::to_chars(contentLength + 16, std::end(contentLength) - 2, content().size()).ptr;
+	*contentLengthEnd++ = '\r';
+	*contentLengthEnd++ = '\n';
+
+	const std::string_view date = dateHeader();
+	const std::string_view contentType = _headers.has(header::CONTENT_TYPE) ? "" : contentTypeHeader(_content_type);
+
+	size_t headSize = statusLine.length() + date.length() + contentType.length() + (contentLengthEnd - contentLength) + 2;
+	for (const auto &[k, v] : _headers)
+		headSize += k.length() + v.length() + 4;
+	head.reserve(head.length() + headSize);
+
+	head += statusLine;
+	head += date;
+	for (const auto &[k, v] : _headers) {
+		head += k;
+		head += ": ";
+		head += v;
+		head += "\r\n";
+	}
+	head += contentType;
+	head.append(contentLength, contentLengthEnd);
+	head += "\r\n";
+}
+
+bool response::send() {
+	if (_sent) // the handler already sent it, the destructor must not send it again
+		return true;
+	_sent = true;
+
+	profiler::scope stage(profiler::stage::SEND);
+	if (_sender)
+		return _sender(*this);
+
+	if (_clientfd < 0) // no client to send to, eg. while revalidating a cached response
+		return true;
+
+	// the head is built in a recycled buffer, the content is written straight from where it was set
+	thread_local std::string head;
+	head.clear();
+	writeHead(head);
+	accounting::copied(head.length());
+	const std::string_view body = content();
+	iovec iov[2] = {{head.data(), head.length()}, {const_cast<char *>(body.data()), body.length()}};
+	return writeAll(_clientfd, iov, 2);
 }
 
 content_type getContentType(const fs::path filepath) {
@@ -131,7 +252,7 @@ content_type getContentType(const fs::path filepath) {
 		if (mimeTypeToContentTypeMap.find(result) != mimeTypeToContentTypeMap.end()) {
 			const content_type type = mimeTypeToContentTypeMap.at(result);
 			cache.insert_or_assign(filepath, std::make_pair(fs::last_write_time(filepath), type));
-			::http::info("The content-type of ", filepath, " deduced from mime type: ", httpContentTypeToString(type));
+			::http::info("The content-type of ", filepath, " deduced from mime type: ", contentTypeToString(type));
 			return type;
 		}
 	}
@@ -184,7 +305,7 @@ content_type getContentType(const fs::path filepath) {
 		if (extensionToContentTypeMap.find(extension) != extensionToContentTypeMap.end()) {
 			const content_type type = extensionToContentTypeMap.at(extension);
 			cache.insert_or_assign(filepath, std::make_pair(fs::last_write_time(filepath), type));
-			::http::info("The content-type of ", filepath, " deduced from extension: ", httpContentTypeToString(type));
+			::http::info("The content-type of ", filepath, " deduced from extension: ", contentTypeToString(type));
 			return type;
 		}
 	}
@@ -193,24 +314,14 @@ content_type getContentType(const fs::path filepath) {
 	return content_type::APPLICATION_OCTET_STREAM;
 }
 
-std::string readFileContents(const fs::path &filepath) {
-	std::ifstream file(filepath.string(), std::ios::binary | std::ios::ate);
-	if (!file.good()) {
-		throw exception(500, "Internal server error");
-	}
-
-	auto fileSize = file.tellg();
-	file.seekg(0, std::ios::beg);
-
-	std::string buffer(fileSize, '\0');
-
-	if (!file.read(buffer.data(), fileSize)) {
+// Mapped rather than read, it is sent from the page cache without being copied
+static std::shared_ptr<const mapped_file> mapFile(const fs::path &filepath) {
+	try {
+		return mapped_file::open(filepath.string());
+	} catch (const std::string &error) {
+		::http::warn(error);
 		throw exception(500, "Internal server error");
 	}
-
-	file.close();
-
-	return buffer;
 }
 
 bool response::sendFile(fs::path filepath, const http::content_type content_type, const std::string displayPath) {
@@ -221,11 +332,9 @@ bool response::sendFile(fs::path filepath, const http::content_type content_type
 			}
 
 			if (fs::exists(filepath)) {
-				std::string buffer = readFileContents(filepath);
-
 				setStatus(200);
 				setContentType(content_type);
-				setContentString(buffer);
+				setContentMapped(mapFile(filepath));
 				return send();
 			}
 		}
@@ -244,11 +353,9 @@ bool response::sendFile(fs::path filepath, const std::string displayPath) {
 			}
 
 			if (fs::exists(filepath)) {
-				std::string buffer = readFileContents(filepath);
-
 				setStatus(200);
 				setContentType(getContentType(filepath));
-				setContentString(buffer);
+				setContentMapped(mapFile(filepath));
 				return send();
 			}
 		}
@@ -260,287 +367,3 @@ bool response::sendFile(fs::path filepath, const std::string displayPath) {
 }
 
 } // namespace http
-
-std::string httpContentTypeToString(http::content_type type) { // TODO: move to content_type.cpp
-	switch (type) {
-		case http::content_type::APPLICATION_JAVA_ARCHIVE:
-			return "application/java-archive";
-		case http::content_type::APPLICATION_EDI_X12:
-			return "application/EDI_X12";
-		case http::content_type::APPLICATION_EDIFACT:
-			return "application/EDIFACT";
-		case http::content_type::APPLICATION_JAVASCRIPT:
-			return "application/javascript";
-		case http::content_type::APPLICATION_OCTET_STREAM:
-			return "application/octet-stream";
-		case http::content_type::APPLICATION_OGG:
-			return "application/ogg";
-		case http::content_type::APPLICATION_PDF:
-			return "application/pdf";
-		case http::content_type::APPLICATION_XHTML_XML:
-			return "application/xhtml+xml";
-		case http::content_type::APPLICATION_X_SHOCKWAVE_FLASH:
-			return "application/x-shockwave-flash";
-		case http::content_type::APPLICATION_JSON:
-			return "application/json";
-		case http::content_type::APPLICATION_LD_JSON:
-			return "application/ld+json";
-		case http::content_type::APPLICATION_XML:
-			return "application/xml";
-		case http::content_type::APPLICATION_ZIP:
-			return "application/zip";
-		case http::content_type::APPLICATION_X_WWW_FORM_URLENCODED:
-			return "application/x-www-form-urlencoded";
-		case http::content_type::AUDIO_MPEG:
-			return "audio/mpeg";
-		case http::content_type::AUDIO_X_MS_WMA:
-			return "audio/x-ms-wma";
-		case http::content_type::AUDIO_VND_RN_REALAUDIO:
-			return "audio/vnd.rn-realaudio";
-		case http::content_type::AUDIO_X_WAV:
-			return "audio/x-wav";
-		case http::content_type::IMAGE_GIF:
-			return "image/gif";
-		case http::content_type::IMAGE_JPEG:
-			return "image/jpeg";
-		case http::content_type::IMAGE_PNG:
-			return "image/png";
-		case http::content_type::IMAGE_TIFF:
-			return "image/tiff";
-		case http::content_type::IMAGE_VND_MICROSOFT_ICON:
-			return "image/vnd.microsoft.icon";
-		case http::content_type::IMAGE_X_ICON:
-			return "image/x-icon";
-		case http::content_type::IMAGE_VND_DJVU:
-			return "image/vnd.djvu";
-		case http::content_type::IMAGE_SVG_XML:
-			return "image/svg+xml";
-		case http::content_type::TEXT_CSS:
-			return "text/css";
-		case http::content_type::TEXT_CSV:
-			return "text/csv";
-		case http::content_type::TEXT_HTML:
-			return "text/html";
-		case http::content_type::TEXT_JAVASCRIPT:
-			return "text/javascript";
-		case http::content_type::TEXT_PLAIN:
-			return "text/plain";
-		case http::content_type::TEXT_XML:
-			return "text/xml";
-		case http::content_type::VIDEO_MPEG:
-			return "video/mpeg";
-		case http::content_type::VIDEO_MP4:
-			return "video/mp4";
-		case http::content_type::VIDEO_QUICKTIME:
-			return "video/quicktime";
-		case http::content_type::VIDEO_X_MS_WMV:
-			return "video/x-ms-wmv";
-		case http::content_type::VIDEO_X_MSVIDEO:
-			return "video/x-msvideo";
-		case http::content_type::VIDEO_X_FLV:
-			return "video/x-flv";
-		case http::content_type::VIDEO_WEBM:
-			return "video/webm";
-	}
-
-	throw http::exception(500, "Something went wrong");
-}
-
-std::string httpStatusCodeToString(int code) {
-	switch (code) {
-		case 100:
-			return "100 Continue";
-		case 101:
-			return "101 Switching Protocols";
-		case 102:
-			return "102 Processing";
-		case 103:
-			return "103 Early Hints";
-		case 110:
-			return "110 Response is Stale";
-		case 111:
-			return "111 Revalidation Failed";
-		case 112:
-			return "112 Disconnected Operation";
-		case 113:
-			return "113 Heuristic Expiration";
-		case 199:
-			return "199 Miscellaneous Warning";
-		case 200:
-			return "200 OK";
-		case 201:
-			return "201 Created";
-		case 202:
-			return "202 Accepted";
-		case 203:
-			return "203 Non-Authoritative Information";
-		case 204:
-			return "204 No Content";
-		case 205:
-			return "205 Reset Content";
-		case 206:
-			return "206 Partial Content";
-		case 207:
-			return "207 Multi-Status";
-		case 208:
-			return "208 Already Reported";
-		case 214:
-			return "214 Transformation Applied";
-		case 226:
-			return "226 IM Used";
-		case 299:
-			return "299 Miscellaneous Persistent Warning";
-		case 300:
-			return "300 Multiple Choices";
-		case 301:
-			return "301 Moved Permanently";
-		case 302:
-			return "302 Found";
-		case 303:
-			return "303 See Other";
-		case 304:
-			return "304 Not Modified";
-		case 305:
-			return "305 Use Proxy";
-		case 306:
-			return "306 Switch Proxy";
-		case 307:
-			return "307 Temporary Redirect";
-		case 308:
-			return "308 Permanent Redirect";
-		case 400:
-			return "400 Bad Request";
-		case 401:
-			return "401 Unauthorized";
-		case 402:
-			return "402 Payment Required";
-		case 403:
-			return "403 Forbidden";
-		case 404:
-			return "404 Not Found";
-		case 405:
-			return "405 Method Not Allowed";
-		case 406:
-			return "406 Not Acceptable";
-		case 407:
-			return "407 Proxy Authentication Required";
-		case 408:
-			return "408 Request Timeout";
-		case 409:
-			return "409 Conflict";
-		case 410:
-			return "410 Gone";
-		case 411:
-			return "411 Length Required";
-		case 412:
-			return "412 Precondition Failed";
-		case 413:
-			return "413 Payload Too Large";
-		case 414:
-			return "414 URI Too Long";
-		case 415:
-			return "415 Unsupported Media Type";
-		case 416:
-			return "416 Range Not Satisfiable";
-		case 417:
-			return "417 Expectation Failed";
-		case 418:
-			return "418 I'm a teapot";
-		case 419:
-			return "419 Page Expired";
-		case 420:
-			return "420 Method Failure";
-		case 421:
-			return "421 Misdirected Request";
-		case 422:
-			return "422 Unprocessable Entity";
-		case 423:
-			return "423 Locked";
-		case 424:
-			return "424 Failed Dependency";
-		case 425:
-			return "425 Too Early";
-		case 426:
-			return "426 Upgrade Required";
-		case 428:
-			return "428 Precondition Required";
-		case 429:
-			return "429 Too Many Requests";
-		case 430:
-			return "430 Request Header Fields Too Large";
-		case 431:
-			return "431 Request Header Fields Too Large";
-		case 440:
-			return "440 Login Time-out";
-		case 444:
-			return "444 No Response";
-		case 449:
-			return "449 Retry With";
-		case 450:
-			return "450 Blocked by Windows Parental Controls";
-		case 451:
-			return "451 Unavailable For Legal Reasons";
-		case 494:
-			return "494 Request header too large";
-		case 495:
-			return "495 SSL Certificate Error";
-		case 496:
-			return "496 SSL Certificate Required";
-		case 497:
-			return "497 HTTP Request Sent to HTTPS Port";
-		case 498:
-			return "498 Invalid Token";
-		case 499:
-			return "499 Token Required";
-		case 500:
-			return "500 Internal Server Error";
-		case 501:
-			return "501 Not Implemented";
-		case 502:
-			return "502 Bad Gateway";
-		case 503:
-			return "503 Service Unavailable";
-		case 504:
-			return "504 Gateway Timeout";
-		case 505:
-			return "505 HTTP Version Not Supported";
-		case 506:
-			return "506 Variant Also Negotiates";
-		case 507:
-			return "507 Insufficient Storage";
-		case 508:
-			return "508 Loop Detected";
-		case 509:
-			return "509 Bandwidth Limit Exceeded";
-		case 510:
-			return "510 Not Extended";
-		case 511:
-			return "511 Network Authentication Required";
-		case 520:
-			return "520 Web Server Returned an Unknown Error";
-		case 521:
-			return "521 Web Server Is Down";
-		case 522:
-			return "522 Connection Timed Out";
-		case 523:
-			return "523 Origin Is Unreachable";
-		case 524:
-			return "524 A Timeout Occurred";
-		case 525:
-			return "525 SSL Handshake Failed";
-		case 526:
-			return "526 Invalid SSL Certificate";
-		case 527:
-			return "527 Railgun Error";
-		case 529:
-			return "529 Site is overloaded";
-		case 530:
-			return "530 Site is frozen";
-		case 561:
-			return "561 Unauthorized";
-		case 599:
-			return "599 Network Connect Timeout Error";
-	}
-
-	return std::to_string(code);
-}
@@ -1,10 +1,15 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <filesystem>
+#include <functional>
+#include <memory>
 
 #include "content_type.hpp"
+#include "headers.hpp"
+#include "mapped_file.hpp"
 
 namespace http {
 
@@ -14,8 +19,15 @@ class response {
   public:
 	void setStatus(int status);
 	void setHeader(const std::string &key, const std::string &value);
-	void setContentType(const http::content_type content_type);
-	void setContentString(const std::string &content);
+	void setContentType(const http::content_type content_type); // overridden by a Content-Type header
+
+	// The content is sent straight from where it is set, only setContentString copies it
+	void setContentString(std::string_view content);
+	void setContentOwned(std::string &&content);
+	void setContentView(std::string_view content); // the storage must outlive the response, eg. static data
+	void setContentShared(std::shared_ptr<const std::string> content); // eg. one immutable body for many responses
+	void setContentMapped(std::shared_ptr<const mapped_file> file, size_t offset = 0,
+						  size_t length = std::string_view::npos);
 
 	bool sendFile(fs::path filepath, const http::content_type content_type, const std::string displayPath);
 	bool sendFile(fs::path filepath,
@@ -27,6 +39,14 @@ class response {
 	~response();
 
 	friend class request;
+	friend class response_cache;
+	friend class single_flight;
+	friend class http2_connection;
+	friend class websocket;
+	friend class sse_hub;
+	friend class proxy;
+	friend class server;
+	friend class asset_bundle;
 
 	int status();
 	size_t size();
@@ -34,12 +54,28 @@ class response {
   private:
 	response(int clientfd);
 
+	std::string head() const;
+	void writeHead(std::string &head) const; // appends to head
+	std::string_view content() const;
+	std::string &ownedContent(); // drops a borrowed content, eg. for the proxy to buffer into
+	static std::string_view dateHeader(); // "Date: ...\r\n"
+
 	const int _clientfd;
+	std::function<bool(const response &)> _sender; // replaces the HTTP/1.1 serialization, eg. for HTTP/2 streams
 
+	bool _sent = false;
+	bool _streamed = false; // sent straight to the client by a websocket, SSE hub or proxy, bypassing _content
 	int _status = 200;
-	std::unordered_map<std::string, std::string> _headers;
+	response_headers _headers;
 	http::content_type _content_type = http::content_type::TEXT_PLAIN;
-	std::string _content;
+	std::string _content; // from the buffer pool unless moved in, returned to it by the destructor
+	std::string_view _borrowed; // the content instead of _content, if _isBorrowed
+	bool _isBorrowed = false;
+	std::shared_ptr<const void> _keepAlive; // a shared or mapped content
+	std::string_view _preparedFields; // serialized at build time for a bundled asset, cleared by any change
 }; // response
 
+// Deduced from the mime type reported by file(1), otherwise from the extension, otherwise application/octet-stream
+content_type getContentType(const fs::path filepath);
+
 } // namespace http
@@ -1,16 +1,34 @@
 #include "server.hpp"
 
+#include <algorithm>
+#include <charconv>
+#include <cstdio>
 #include <cstring>
 #include <chrono>
 #include <sstream>
 #include <memory>
+#include <vector>
 
 // OS-SPECIFIC INCLUDES TODO: CHANGE WHEN IMPLEMENTING CROSS-PLATFORM SUPPORT
 #include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
 #include <arpa/inet.h>
+#include <netinet/tcp.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/prctl.h>
+#include <sys/wait.h>
 
 #include "log.hpp"
 #include "exception.hpp"
+#include "io.hpp"
+#include "http2.hpp"
+#include "accounting.hpp"
+#include "pool.hpp"
+#include "profiler.hpp"
 
 template <typename T> T validate(T code) {
 	if (code < 0)
@@ -22,72 +40,936 @@ using namespace std::string_literals;
 
 namespace http {
 
-static void handleRequest(int clientfd, server::requestCallbackType requestListener,
-						  server::requestErrorCallbackType dispatchError); // forward-declaration
+std::unordered_map<server *, std::string> server::_instances;
 
-std::unordered_map<server *, std::pair<host, uint16_t>> server::_instances;
+volatile std::sig_atomic_t server::_drainRequested = 0;
+unsigned server::_drainTimeout = 30;
+int server::_wakePipe[2] = {-1, -1};
 
 server::server(requestCallbackType requestListener, requestErrorCallbackType dispatchError)
 	: _requestListener(requestListener), _dispatchError(dispatchError) {
 }
 
-void server::stopAllInstances(int) {
+void server::stopAllInstances(int sig) {
 	std::putc('\n', stdout);
 
-	for (const auto &[instance, ip] : _instances) {
-		::http::log("Stopping ", ip.first, ":", ip.second, "... ",
+	const bool graceful = sig == SIGINT || sig == SIGTERM || sig == SIGQUIT || sig == SIGHUP;
+
+	if (graceful && !_drainRequested) {
+		_drainRequested = 1;
+
+		for (const auto &[instance, addresses] : _instances) {
+			::http::log("Draining ", addresses, "...");
+		}
+
+		// the pipe is left readable, so every listen loop wakes up on it
+		if (_wakePipe[1] >= 0 && write(_wakePipe[1], "", 1) < 0)
+			::http::warn("Failed to wake up the servers: ", std::strerror(errno));
+
+		// only async-signal-safe calls: no logging through streams, no atexit handlers nor destructors, the drain failed
+		std::signal(SIGALRM, [](int) {
+			constexpr std::string_view message = "warning: Drain timeout exceeded, exiting\n";
+			[[maybe_unused]] const ssize_t written = write(STDOUT_FILENO, message.data(), message.length());
+			_exit(1);
+		});
+		alarm(_drainTimeout);
+
+		return;
+	}
+
+	for (const auto &[instance, addresses] : _instances) {
+		::http::log("Stopping ", addresses, "... ",
 					(instance->stop() ? "done"s : "failed: "s + std::string(std::strerror(errno))));
 	}
 
 	std::exit(0);
 }
 
+void server::setDrainTimeout(unsigned seconds) {
+	_drainTimeout = seconds;
+}
+
+void server::setUpgradeSocket(const std::string &path) {
+	_upgradeSocketPath = path;
+}
+
+void server::setReusePort(bool reusePort) {
+	_reusePort = reusePort;
+}
+
+void server::setAccessLog(access_log &log) {
+	_accessLog = &log;
+}
+
+void server::setLimits(const limits &limits) {
+	_limits = limits;
+}
+
+void server::setCapture(traffic_capture &capture) {
+	_capture = &capture;
+}
+
+void server::setCpuAffinity(int cpu) {
+	_cpu = cpu;
+}
+
+void server::setWorkers(unsigned count, workerInitCallbackType init) {
+	_workerCount = count;
+	_workerInit = init;
+}
+
+std::vector<server::worker_status> server::workers() const {
+	std::lock_guard<std::mutex> lock(_workersMutex);
+
+	std::vector<worker_status> workers;
+	for (const worker &worker : _workers)
+		workers.push_back(worker.status);
+	return workers;
+}
+
+void server::setResponseCache(response_cache &cache) {
+	_cache = &cache;
+}
+
+void server::setHttp2(bool enabled, unsigned idleTimeoutSeconds, unsigned lifetimeSeconds) {
+	_http2 = enabled;
+	_http2IdleTimeout = idleTimeoutSeconds;
+	_http2Lifetime = lifetimeSeconds;
+}
+
+void server::setSingleFlight(single_flight &singleFlight) {
+	_singleFlight = &singleFlight;
+}
+
+void server::setRateLimiter(rate_limiter &limiter) {
+	_rateLimiter = &limiter;
+}
+
+void server::setHandlerPool(handler_pool &pool, offloadCallbackType offload) {
+	_handlerPool = &pool;
+	_offload = offload;
+}
+
 bool server::stop() {
-	return close(_sockfd) == 0;
+	bool closed = true;
+	for (const int sockfd : _sockfds)
+		closed = close(sockfd) == 0 && closed;
+	return closed;
+}
+
+void server::addListener(const listener &listener) {
+	_listeners.push_back(listener);
+}
+
+static sockaddr_un unixSocketAddress(const std::string &path) {
+	sockaddr_un addr = {};
+	addr.sun_family = AF_UNIX;
+	if (path.length() >= sizeof(addr.sun_path))
+		throw "Upgrade socket path too long: "s + path;
+	std::memcpy(addr.sun_path, path.c_str(), path.length() + 1);
+	return addr;
+}
+
+constexpr size_t maxListeners = 16; // that can be handed off at once
+
+static bool sendFileDescriptors(int sockfd, const std::vector<int> &fds) {
+	char byte = 0;
+	iovec iov = {&byte, 1};
+
+	alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int) * maxListeners)] = {};
+
+	msghdr msg = {};
+	msg.msg_iov = &iov;
+	msg.msg_iovlen = 1;
+	msg.msg_control = control;
+	msg.msg_controllen = CMSG_SPACE(sizeof(int) * fds.size());
+
+	cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+	cmsg->cmsg_level = SOL_SOCKET;
+	cmsg->cmsg_type = SCM_RIGHTS;
+	cmsg->cmsg_len = CMSG_LEN(sizeof(int) * fds.size());
+	std::memcpy(CMSG_DATA(cmsg), fds.data(), sizeof(int) * fds.size());
+
+	return sendmsg(sockfd, &msg, MSG_NOSIGNAL) == 1;
+}
+
+static std::vector<int> receiveFileDescriptors(int sockfd) {
+	char byte;
+	iovec iov = {&byte, 1};
+
+	alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int) * maxListeners)] = {};
+
+	msghdr msg = {};
+	msg.msg_iov = &iov;
+	msg.msg_iovlen = 1;
+	msg.msg_control = control;
+	msg.msg_controllen = sizeof(control);
+
+	if (recvmsg(sockfd, &msg, MSG_CMSG_CLOEXEC) != 1)
+		return {};
+
+	cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+	if (!cmsg || cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS)
+		return {};
+
+	std::vector<int> fds((cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int));
+	std::memcpy(fds.data(), CMSG_DATA(cmsg), sizeof(int) * fds.size());
+	return fds;
+}
+
+// Asks the process currently owning the upgrade socket for its listening sockets, none if there is no such process
+static std::vector<int> inheritListeningSockets(const std::string &path) {
+	const sockaddr_un addr = unixSocketAddress(path);
+
+	int sockfd = validate(socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0));
+	if (connect(sockfd, (sockaddr *)&addr, sizeof(addr)) < 0) {
+		close(sockfd);
+		return {};
+	}
+
+	std::vector<int> fds = receiveFileDescriptors(sockfd);
+	close(sockfd);
+	return fds;
+}
+
+void server::handOff() {
+	int connfd = accept4(_controlfd, nullptr, nullptr, SOCK_CLOEXEC);
+	if (connfd < 0)
+		return;
+
+	if (sendFileDescriptors(connfd, _sockfds)) {
+		::http::info("Listening sockets handed off via ", _upgradeSocketPath, ", draining");
+		_draining = true;
+	} else {
+		::http::warn("Failed to hand off listening socket: ", std::strerror(errno));
+	}
+
+	close(connfd);
+}
+
+static void pinThread(int cpu) {
+	cpu_set_t cpus;
+	CPU_ZERO(&cpus);
+	CPU_SET(cpu, &cpus);
+	if (const int status = pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus); status != 0)
+		throw "Failed to pin the thread to CPU "s + std::to_string(cpu) + ": "s + std::strerror(status);
+}
+
+// What a worker writes to its pipe, atomically as it is shorter than PIPE_BUF
+struct worker_report {
+	uint64_t requests;
+	resource_usage usage;
+};
+
+void server::report() {
+	_reported = std::chrono::steady_clock::now();
+
+	const worker_report report = {accounting::requests(), accounting::totals()};
+	if (write(_reportfd, &report, sizeof(report)) < 0 && errno != EAGAIN)
+		::http::warn("Worker ", _worker, ": failed to report: ", std::strerror(errno));
+}
+
+bool server::spawn(size_t index) {
+	worker &worker = _workers[index];
+
+	int reportPipe[2];
+	if (pipe2(reportPipe, O_CLOEXEC) < 0) {
+		::http::warn("Failed to start worker ", index, ": ", std::strerror(errno));
+		worker.restartAt = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+		return false;
+	}
+
+	const pid_t supervisor = getpid();
+	const pid_t pid = fork();
+	if (pid < 0) {
+		::http::warn("Failed to start worker ", index, ": ", std::strerror(errno));
+		close(reportPipe[0]);
+		close(reportPipe[1]);
+		worker.restartAt = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+		return false;
+	}
+
+	if (pid > 0) {
+		close(reportPipe[1]);
+
+		std::lock_guard<std::mutex> lock(_workersMutex);
+		worker.pid = worker.status.pid = pid;
+		worker.reportfd = reportPipe[0];
+		worker.started = std::chrono::steady_clock::now();
+		return false;
+	}
+
+	// in the worker: only the listening sockets are shared with the supervisor
+	close(reportPipe[0]);
+	for (const struct worker &other : _workers)
+		if (other.reportfd >= 0)
+			close(other.reportfd);
+	_workers.clear();
+	if (_controlfd >= 0) {
+		close(_controlfd); // hand-offs go through the supervisor
+		_controlfd = -1;
+	}
+
+	// SIGINT from the terminal only reaches the supervisor, which drains the workers, or they would be signalled twice
+	setpgid(0, 0);
+	prctl(PR_SET_PDEATHSIG, SIGTERM);
+	if (getppid() != supervisor)
+		std::raise(SIGTERM);
+
+	// the supervisor restarts a worker killed by a crash, unlike stopAllInstances which exits cleanly
+	for (const int sig : {SIGSEGV, SIGBUS, SIGILL, SIGFPE, SIGABRT, SIGSYS})
+		std::signal(sig, SIG_DFL);
+
+	_worker = static_cast<int>(index);
+	_reportfd = reportPipe[1];
+	fcntl(_reportfd, F_SETFL, O_NONBLOCK);
+
+	try {
+		// the supervisor's wake pipe stays readable once it drains, which would keep this loop spinning
+		close(_wakePipe[0]);
+		close(_wakePipe[1]);
+		validate(pipe2(_wakePipe, O_CLOEXEC | O_NONBLOCK));
+
+		if (_cpu >= 0) {
+			const long cpus = std::max(sysconf(_SC_NPROCESSORS_ONLN), 1L);
+			pinThread(static_cast<int>((_cpu + index) % cpus));
+		}
+
+		if (_workerInit)
+			_workerInit(_worker);
+
+		if (_handlerPool && _completionPipe[0] < 0)
+			validate(pipe2(_completionPipe, O_CLOEXEC | O_NONBLOCK));
+	} catch (const std::string &error) {
+		::http::warn("Worker ", index, ": ", error);
+		_exit(1);
+	}
+
+	::http::info("Worker ", index, " started, pid ", getpid());
+	return true;
+}
+
+bool server::supervise() {
+	_workers.assign(_workerCount, worker());
+	for (size_t i = 0; i < _workers.size(); i++) {
+		_workers[i].status.index = static_cast<unsigned>(i);
+		if (spawn(i))
+			return true;
+	}
+
+	bool stopping = false;
+	std::vector<pollfd> fds;
+	std::vector<size_t> polled; // the worker of each report pipe in fds
+
+	while (true) {
+		if (!stopping && (_draining || _drainRequested)) {
+			stopping = true;
+			for (const worker &worker : _workers)
+				if (worker.pid > 0)
+					kill(worker.pid, SIGTERM);
+		}
+
+		fds.clear();
+		polled.clear();
+		for (size_t i = 0; i < _workers.size(); i++) {
+			if (_workers[i].reportfd >= 0) {
+				fds.push_back({_workers[i].reportfd, POLLIN, 0});
+				polled.push_back(i);
+			}
+		}
+		if (stopping && fds.empty())
+			break;
+
+		// the wake pipe stays readable once draining
+		if (!stopping) {
+			fds.push_back({_wakePipe[0], POLLIN, 0});
+			if (_controlfd >= 0)
+				fds.push_back({_controlfd, POLLIN, 0});
+		}
+
+		// until the next restart
+		const auto now = std::chrono::steady_clock::now();
+		int timeout = -1;
+		for (const worker &worker : _workers) {
+			if (!stopping && worker.pid == 0) {
+				const auto wait = std::chrono::ceil<std::chrono::milliseconds>(worker.restartAt - now).count();
+				const int clamped = static_cast<int>(std::clamp<long long>(wait, 0, 1000));
+				timeout = timeout < 0 ? clamped : std::min(timeout, clamped);
+			}
+		}
+
+		if (poll(fds.data(), fds.size(), timeout) < 0) {
+			if (errno == EINTR)
+				continue;
+			::http::warn("Failed to poll the workers: ", std::strerror(errno));
+			break;
+		}
+
+		if (!stopping && _controlfd >= 0 && (fds.back().revents & POLLIN))
+			handOff();
+
+		for (size_t j = 0; j < polled.size(); j++) {
+			if (!fds[j].revents)
+				continue;
+			worker &worker = _workers[polled[j]];
+
+			worker_report reports[16];
+			const ssize_t got = read(worker.reportfd, reports, sizeof(reports));
+			if (got >= static_cast<ssize_t>(sizeof(worker_report))) {
+				const worker_report &latest = reports[got / sizeof(worker_report) - 1];
+
+				std::lock_guard<std::mutex> lock(_workersMutex);
+				worker.status.requests = worker.retiredRequests + latest.requests;
+				worker.status.usage = worker.retiredUsage;
+				worker.status.usage += latest.usage;
+				continue;
+			}
+			if (got < 0 && errno == EINTR)
+				continue;
+
+			// hung up, the worker exited
+			int status = 0;
+			while (waitpid(worker.pid, &status, 0) < 0 && errno == EINTR)
+				;
+			close(worker.reportfd);
+
+			const auto exited = std::chrono::steady_clock::now();
+			const std::string how = WIFSIGNALED(status)
+										? "killed by "s + strsignal(WTERMSIG(status))
+										: "exited with status "s + std::to_string(WEXITSTATUS(status));
+			if (stopping)
+				::http::info("Worker ", polled[j], " (pid ", worker.pid, ") ", how);
+			else
+				::http::warn("Worker ", polled[j], " (pid ", worker.pid, ") ", how, ", restarting");
+
+			std::lock_guard<std::mutex> lock(_workersMutex);
+			worker.retiredRequests = worker.status.requests;
+			worker.retiredUsage = worker.status.usage;
+			worker.pid = worker.status.pid = 0;
+			worker.reportfd = -1;
+			// a worker crashing as it starts is restarted once a second, not in a loop
+			worker.restartAt = exited - worker.started < std::chrono::seconds(1) ? exited + std::chrono::seconds(1) : exited;
+			if (!stopping)
+				worker.status.restarts++;
+		}
+
+		if (stopping)
+			continue;
+
+		for (size_t i = 0; i < _workers.size(); i++) {
+			if (_workers[i].pid == 0 && _workers[i].restartAt <= std::chrono::steady_clock::now() && spawn(i))
+				return true;
+		}
+	}
+
+	return false;
 }
 
 void server::listen(const host &host, uint16_t port, std::function<void()> successCallback,
 					std::function<void(const std::string &)> errorCallback) {
-	_instances.insert_or_assign(this, std::make_pair(host, port));
+	listener listener(host, port);
+	listener.reusePort = _reusePort;
+	addListener(listener);
+
+	listen(successCallback, errorCallback);
+}
+
+void server::listen(std::function<void()> successCallback, std::function<void(const std::string &)> errorCallback) {
+	std::ostringstream addresses;
+	for (size_t i = 0; i < _listeners.size(); i++)
+		addresses << (i > 0 ? ", " : "") << _listeners[i];
+	_instances.insert_or_assign(this, addresses.str());
 
 	try {
-		_sockfd = validate(socket(PF_INET, SOCK_STREAM, IPPROTO_TCP));
+		if (_listeners.empty())
+			throw "No listeners"s;
+		if (_listeners.size() > maxListeners)
+			throw "Too many listeners, at most "s + std::to_string(maxListeners) + " are supported"s;
 
-		_serveraddr.sin_family = AF_INET;
-		_serveraddr.sin_port = htons(port);
-		_serveraddr.sin_addr.s_addr = host.getIP()._full;
+		if (_cpu >= CPU_SETSIZE)
+			throw "No such CPU: "s + std::to_string(_cpu);
+		if (_cpu >= 0 && _workerCount == 0)
+			pinThread(_cpu);
 
-		validate(bind(_sockfd, (sockaddr *)&_serveraddr, sizeof(_serveraddr)));
+		// pools set before listen would fork without their threads
+		if (_workerCount > 0 && _handlerPool)
+			throw "A handler pool can not be shared by worker processes, set it from their init callback"s;
 
-		validate(::listen(_sockfd, 1024));
+		if (_wakePipe[0] < 0)
+			validate(pipe2(_wakePipe, O_CLOEXEC | O_NONBLOCK));
+		if (_handlerPool && _completionPipe[0] < 0)
+			validate(pipe2(_completionPipe, O_CLOEXEC | O_NONBLOCK));
+
+		if (!_upgradeSocketPath.empty())
+			_sockfds = inheritListeningSockets(_upgradeSocketPath);
+
+		if (!_sockfds.empty()) {
+			if (_sockfds.size() != _listeners.size())
+				::http::warn("Inherited ", _sockfds.size(), " listening sockets for ", _listeners.size(), " listeners");
+			::http::info("Inherited listening sockets via ", _upgradeSocketPath);
+		} else {
+			for (const listener &listener : _listeners)
+				_sockfds.push_back(listener.open());
+		}
+
+		if (!_upgradeSocketPath.empty()) {
+			const sockaddr_un addr = unixSocketAddress(_upgradeSocketPath);
+
+			_controlfd = validate(socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0));
+			unlink(_upgradeSocketPath.c_str());
+			validate(bind(_controlfd, (sockaddr *)&addr, sizeof(addr)));
+			validate(::listen(_controlfd, 1));
+		}
 
 		successCallback();
 	} catch (const std::string &error) {
+		stop();
+		_sockfds.clear();
+		_instances.erase(this);
 		errorCallback(error);
 		return;
 	}
 
+	if (_workerCount == 0 || supervise())
+		serve();
+
+	// only our references to the listening sockets are dropped, after a hand-off the new process keeps listening
+	stop();
+	_sockfds.clear();
+	if (!_draining && _worker < 0) {
+		for (const listener &listener : _listeners)
+			if (listener.isUnixSocket() && listener.path[0] != '@')
+				unlink(listener.path.c_str());
+	}
+	if (_controlfd >= 0) {
+		close(_controlfd);
+		if (!_draining) // after a hand-off the path belongs to the new process
+			unlink(_upgradeSocketPath.c_str());
+	}
+
+	_instances.erase(this);
+	::http::log(_worker >= 0 ? "Worker "s + std::to_string(_worker) + ": stopped "s : "Stopped "s, addresses.str());
+}
+
+void server::serve() {
 	sockaddr_storage clientaddr;
-	socklen_t clientsize = sizeof(clientaddr);
+	socklen_t clientsize;
 
-	while (true) {
-		int clientfd = accept(_sockfd, (sockaddr *)&clientaddr, &clientsize);
-		handleRequest(clientfd, _requestListener, _dispatchError);
+	std::vector<pollfd> fds;
+	for (const int sockfd : _sockfds)
+		fds.push_back({sockfd, POLLIN, 0});
+	fds.push_back({_wakePipe[0], POLLIN, 0});
+	if (_completionPipe[0] >= 0)
+		fds.push_back({_completionPipe[0], POLLIN, 0});
+	if (_controlfd >= 0)
+		fds.push_back({_controlfd, POLLIN, 0});
+	const size_t completionIndex = _sockfds.size() + 1;
+
+	while (!_draining && !_drainRequested) {
+		// a worker wakes up every second to report, even idle
+		if (poll(fds.data(), fds.size(), _reportfd >= 0 ? 1000 : -1) < 0) {
+			if (errno == EINTR)
+				continue;
+			::http::warn("Failed to poll the listening sockets: ", std::strerror(errno));
+			break;
+		}
+
+		for (size_t i = 0; i < _sockfds.size(); i++) {
+			if (!(fds[i].revents & POLLIN))
+				continue;
+
+			// the listening sockets are non-blocking, another thread or process may have taken the connection
+			clientsize = sizeof(clientaddr);
+			int clientfd = accept4(_sockfds[i], (sockaddr *)&clientaddr, &clientsize, SOCK_CLOEXEC);
+			if (clientfd < 0)
+				continue;
+
+			if (i < _listeners.size() && _listeners[i].noDelay && !_listeners[i].isUnixSocket()) {
+				int one = 1;
+				setsockopt(clientfd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+			}
+
+			handleRequest(clientfd, clientaddr);
+		}
+
+		if (_completionPipe[0] >= 0 && (fds[completionIndex].revents & POLLIN))
+			completeOffloaded();
+
+		if (_controlfd >= 0 && (fds.back().revents & POLLIN))
+			handOff();
+
+		if (_reportfd >= 0 && std::chrono::steady_clock::now() - _reported >= std::chrono::seconds(1))
+			report();
+	}
+
+	// the offloaded handlers still have to be answered, their connections were accepted by this thread
+	while (_offloaded > 0) {
+		pollfd completion = {_completionPipe[0], POLLIN, 0};
+		if (poll(&completion, 1, -1) < 0 && errno != EINTR)
+			break;
+		completeOffloaded();
+	}
+
+	if (_reportfd >= 0)
+		report(); // the pipe hangs up once the process exits
+}
+
+static std::string formatSize(const size_t bytes) {
+	const static size_t kilobyte = 1024;
+	const static size_t megabyte = 1024 * 1024;
+	const static size_t gigabyte = 1024 * 1024 * 1024;
+
+	if (bytes < kilobyte) {
+		return std::to_string(bytes) + "B";
+	} else if (bytes < megabyte) {
+		double sizeInKB = static_cast<double>(bytes) / kilobyte;
+		return std::to_string(sizeInKB) + "KB";
+	} else if (bytes < gigabyte) {
+		double sizeInMB = static_cast<double>(bytes) / megabyte;
+		return std::to_string(sizeInMB) + "MB";
+	} else {
+		double sizeInGB = static_cast<double>(bytes) / gigabyte;
+		return std::to_string(sizeInGB) + "GB";
+	}
+}
+
+static std::string formatDuration(const std::chrono::high_resolution_clock::duration executionTime) {
+	const auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(executionTime);
+	if (duration.count() < 1000) {
+		return std::to_string(duration.count()) + "ms"s;
+	} else if (duration.count() < 60000) {
+		auto seconds = std::chrono::duration_cast<std::chrono::seconds>(duration);
+		return std::to_string(seconds.count()) + "s"s;
+	} else {
+		auto minutes = std::chrono::duration_cast<std::chrono::minutes>(duration);
+		auto seconds = std::chrono::duration_cast<std::chrono::seconds>(duration - minutes);
+		return std::to_string(seconds.count()) + "min"s;
+	}
+}
+
+static std::string_view getPlatform(std::string_view userAgent) {
+	for (const auto &[agent, platform] : std::initializer_list<std::pair<std::string_view, std::string_view>>({
+			 {"Windows NT 10.0", "Windows 10"},
+			 {"Windows NT 6.3", "Windows 8.1"},
+			 {"Windows NT 6.2", "Windows 8"},
+			 {"Windows NT 6.1", "Windows 7"},
+			 {"Windows NT 6.0", "Windows Vista"},
+			 {"Windows NT 5.2", "Windows Server 2003/XP x64"},
+			 {"Windows NT 5.1", "Windows XP"},
+			 {"Windows NT 5.01", "Windows 2000, Service Pack 1 (SP1)"},
+			 {"Windows NT 5.0", "Windows 2000"},
+			 {"Windows NT 4.0", "Windows NT 4.0"},
+			 {"Windows NT", "Windows NT"},
+		 })) {
+		if (userAgent.find(agent) != std::string_view::npos)
+			return platform;
+	}
+
+	for (const auto &platform : {
+			 "Windows",	   "iPhone",	  "iPad",	 "Macintosh", "Mac OS X",	   "Mac_PowerPC", "Mac_68K",
+			 "iOS",		   "Android",	  "FreeBSD", "OpenBSD",	  "NetBSD",		   "SunOS",		  "IRIX",
+			 "HP-UX",	   "AIX",		  "OS/2",	 "QNX",		  "BeOS",		   "AmigaOS",	  "MorphOS",
+			 "Nintendo",   "PlayStation", "Xbox",	 "Linux",	  "X11",		   "Chrome OS",	  "BlackBerry",
+			 "Symbian OS", "PalmOS",	  "WebOS",	 "Tizen",	  "Windows Phone", "Windows CE",
+		 }) {
+		if (userAgent.find(platform) != std::string_view::npos)
+			return platform;
+	}
+
+	return "_";
+}
+
+static void logRequest(const request_headers &headers, std::string_view method, std::string_view target,
+					   const std::string &responseOrError,
+					   const std::chrono::high_resolution_clock::duration executionTime) {
+	const auto getHeader = [&headers](header name) -> std::string_view {
+		std::string_view value = headers.get(name);
+		return value.empty() ? "_" : value;
+	};
+
+	::http::log(												// log message
+		getHeader(header::X_FORWARDED_FOR), "/",				// IP/
+		getHeader(header::CF_IPCOUNTRY), " ",					// COUNTRY
+		"(", getPlatform(headers.get(header::USER_AGENT)), ") ",	// "PLATFORM"
+		method, " ",											// METHOD
+		getHeader(header::HOST), " ",							// HOST
+		target, " ",											// PATH
+		responseOrError, " ",									// RESPONSE (CODE AND SIZE) or ERROR
+		formatDuration(executionTime)							// EXECUTION TIME
+	);
+}
+
+// The fields logRequest would format, only viewed
+static access_log::entry accessLogEntry(const request_headers &headers, std::string_view method,
+										std::string_view target,
+										const std::chrono::high_resolution_clock::duration executionTime) {
+	access_log::entry entry;
+	entry.duration = std::chrono::duration_cast<std::chrono::nanoseconds>(executionTime);
+	entry.start =
+		std::chrono::system_clock::now() - std::chrono::duration_cast<std::chrono::system_clock::duration>(executionTime);
+	entry.method = method;
+	entry.host = headers.get(header::HOST);
+	entry.target = target;
+	entry.userAgent = headers.get(header::USER_AGENT);
+	entry.client = headers.get(header::X_FORWARDED_FOR);
+	entry.country = headers.get(header::CF_IPCOUNTRY);
+	return entry;
+}
+
+// The first X-Forwarded-For address, otherwise the peer address
+static std::string peerAddress(const sockaddr_storage &peer) {
+	if (peer.ss_family == AF_UNIX) // all local clients share one identity
+		return "unix";
+
+	char buffer[INET6_ADDRSTRLEN] = "";
+	if (peer.ss_family == AF_INET) {
+		inet_ntop(AF_INET, &reinterpret_cast<const sockaddr_in *>(&peer)->sin_addr, buffer, sizeof(buffer));
+	} else if (peer.ss_family == AF_INET6) {
+		inet_ntop(AF_INET6, &reinterpret_cast<const sockaddr_in6 *>(&peer)->sin6_addr, buffer, sizeof(buffer));
+	}
+	return buffer;
+}
+
+// The client sets X-Forwarded-For, every proxy appends the address it got the request from: only the addresses
+// appended by trusted proxies identify anyone, the rightmost one that is not itself a trusted proxy is the client
+static std::string clientAddress(const request_headers &headers, const sockaddr_storage &peer,
+								 const rate_limiter &limiter) {
+	std::string address = peerAddress(peer);
+	if (!limiter.isTrustedProxy(address))
+		return address;
+
+	std::string_view forwardedFor = headers.get(header::X_FORWARDED_FOR);
+	while (!forwardedFor.empty()) {
+		const size_t comma = forwardedFor.rfind(',');
+		std::string_view hop = forwardedFor.substr(comma == std::string_view::npos ? 0 : comma + 1);
+		forwardedFor = forwardedFor.substr(0, comma == std::string_view::npos ? 0 : comma);
+
+		const size_t first = hop.find_first_not_of(" \t");
+		if (first == std::string_view::npos)
+			continue;
+		hop = hop.substr(first, hop.find_last_not_of(" \t") - first + 1);
+
+		address = hop;
+		if (!limiter.isTrustedProxy(address))
+			break;
 	}
+	return address;
 }
 
-static void handleRequest(int clientfd, server::requestCallbackType requestListener,
-						  server::requestErrorCallbackType dispatchError) {
+static std::optional<peer_credentials> peerCredentials(int clientfd, const sockaddr_storage &peer) {
+	if (peer.ss_family != AF_UNIX)
+		return std::nullopt;
+
+	ucred credentials;
+	socklen_t length = sizeof(credentials);
+	if (getsockopt(clientfd, SOL_SOCKET, SO_PEERCRED, &credentials, &length) < 0)
+		return std::nullopt;
+	return peer_credentials{credentials.pid, credentials.uid, credentials.gid};
+}
 
+void server::dispatch(request &req, int errorCode, const std::string &errorMessage) {
+	if (errorCode > 0) {
+		profiler::scope stage(profiler::stage::HANDLER);
+		_dispatchError(req, errorCode, errorMessage);
+	} else if (errorCode != -1) {
+		profiler::scope stage(profiler::stage::HANDLER);
+		try {
+			if (!_requestListener(req))
+				throw exception(500, "Something went wrong");
+		} catch (const exception &e) {
+			_dispatchError(req, e.code, e.message);
+		}
+	}
+
+	req.response().send();
+}
+
+void server::dispatchHttp2(request &req, const sockaddr_storage &peer) {
 	const auto startTime = std::chrono::high_resolution_clock::now();
+	const resource_usage mark = accounting::current(); // the frames of the connection are not attributed to streams
+	const std::string_view methodName = methodToString(req.method);
+
+	std::string client;
+	if (_rateLimiter)
+		client = clientAddress(req.headers(), peer, *_rateLimiter);
+
+	if (_rateLimiter && !_rateLimiter->admit(client, req.body().length())) {
+		req.response().setStatus(429);
+		req.response().setHeader("Retry-After", "1");
+		req.response().setContentString("Too Many Requests");
+		req.response().send();
+	} else if (req.method == method::UNKNOWN) {
+		dispatch(req, 501, "The requested method is not implemented by this server");
+	} else {
+		dispatch(req, 0, {});
+
+		if (_rateLimiter)
+			_rateLimiter->charge(client, req.response().size());
+	}
+
+	const std::string target = req.url.pathname + req.url.search;
+	const auto executionTime = std::chrono::high_resolution_clock::now() - startTime;
+
+	const resource_usage usage = accounting::current() - mark;
+	accounting::add(usage);
+
+	if (_accessLog) {
+		access_log::entry entry = accessLogEntry(req.headers(), methodName, target, executionTime);
+		entry.status = req.response().status();
+		entry.requestBytes = req.body().length();
+		entry.responseBytes = req.response().size();
+		entry.usage = &usage;
+		_accessLog->append(entry);
+		return;
+	}
+
+	logRequest(req.headers(), methodName.empty() ? "_" : methodName, target,
+			   std::to_string(req.response().status()) + " "s + formatSize(req.response().size()), executionTime);
+}
+
+// Everything about one request from being received until it has been answered and logged. Recycled by the listening
+// thread; while an offloaded handler runs, the exchange belongs to the handler pool.
+struct server::exchange {
+	int clientfd = -1;
+	std::chrono::high_resolution_clock::time_point startTime;
+	std::optional<peer_credentials> credentials;
+
+	std::string requestStr; // from the buffer pool
+	std::string method, url, protocolVersion;
+	request_headers headers; // views into requestStr
+	std::unordered_map<std::string, std::string> payload; // POST-only
+	request_body body;
+	size_t size = 0; // of the head and the body, as received
+
+	std::string captured; // the raw request, if it is being captured
+	bool captureTruncated = false;
 
-	std::string requestStr;
 	struct {
 		int code = 0;
 		std::string message;
 	} error;
 
+	::http::method requestMethod = method::UNKNOWN;
+	std::optional<::http::url> requestUrl;
+
+	std::string client; // for the rate limiter
+	response_cache::lookup cached;
+	single_flight::ticket flight;
+	bool offload = false;	   // the handler runs on the handler pool, see setHandlerPool
+	bool revalidating = false; // on the handler pool, once answered and logged
+	std::optional<request> req; // unless answered without the handler
+
+	int status = 0;
+	size_t responseSize = 0;
+
+	resource_usage usage; // attributed to the request so far
+	resource_usage mark;  // accounting::current() when the thread serving the request last took it over
+
+	std::string_view getHeader(header name) {
+		std::string_view value = headers.get(name);
+		return value.empty() ? "_" : value;
+	}
+
+	void reset() {
+		req.reset(); // refers to everything else
+		credentials.reset();
+		method.clear();
+		url.clear();
+		protocolVersion.clear();
+		headers.clear();
+		payload.clear();
+		body = {};
+		size = 0;
+		captured.clear();
+		captureTruncated = false;
+		error.code = 0;
+		error.message.clear();
+		requestMethod = method::UNKNOWN;
+		requestUrl.reset();
+		client.clear();
+		cached = {};
+		flight = {};
+		offload = false;
+		revalidating = false;
+		status = 0;
+		responseSize = 0;
+		usage = {};
+	}
+}; // exchange
+
+thread_local std::vector<std::unique_ptr<server::exchange>> server::_spareExchanges;
+
+// The request line of HTTP/1.1 travels as pseudo-headers in HTTP/2
+static http2_connection::limits http2Limits(const server::limits &limits) {
+	return {limits.requestLine + limits.headerBytes, limits.headerCount, limits.bodySize};
+}
+
+// Closing a socket with unread input makes the kernel answer with a reset, which may discard the response before the
+// client reads it: stop writing, then drop what the client still sends, up to a bounded time and amount, until it
+// closes its side after reading the response
+static int lingeringClose(int clientfd) {
+	constexpr auto lingerTime = std::chrono::milliseconds(100);
+	constexpr size_t lingerBytes = 1024 * 1024;
+
+	if (shutdown(clientfd, SHUT_WR) == 0) {
+		const auto deadline = std::chrono::steady_clock::now() + lingerTime;
+		char discarded[4096];
+		size_t total = 0;
+
+		while (total < lingerBytes) {
+			const auto left =
+				std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+			pollfd input = {clientfd, POLLIN, 0};
+			if (left.count() <= 0 || poll(&input, 1, static_cast<int>(left.count())) <= 0)
+				break;
+
+			const ssize_t got = recv(clientfd, discarded, sizeof(discarded), 0);
+			accounting::received(std::max<ssize_t>(got, 0));
+			if (got <= 0)
+				break;
+			total += got;
+		}
+	}
+
+	return close(clientfd);
+}
+
+std::unique_ptr<server::exchange> server::takeExchange() {
+	if (_spareExchanges.empty())
+		return std::make_unique<exchange>();
+
+	std::unique_ptr<exchange> exchange = std::move(_spareExchanges.back());
+	_spareExchanges.pop_back();
+	return exchange;
+}
+
+void server::recycle(std::unique_ptr<exchange> exchange) {
+	constexpr size_t maxSpareExchanges = 64; // per thread, more are only needed while handlers are offloaded
+
+	buffer_pool::release(std::move(exchange->requestStr));
+	exchange->reset();
+	if (_spareExchanges.size() < maxSpareExchanges)
+		_spareExchanges.push_back(std::move(exchange));
+}
+
+void server::handleRequest(int clientfd, const sockaddr_storage &peer) {
+	profiler::scope stage(profiler::stage::RECV); // back to OTHER once handled, or offloaded
+
+	std::unique_ptr<exchange> current = takeExchange();
+	exchange &requestElements = *current;
+
+	requestElements.mark = accounting::current();
+	requestElements.clientfd = clientfd;
+	requestElements.startTime = std::chrono::high_resolution_clock::now();
+	requestElements.credentials = peerCredentials(clientfd, peer);
+	requestElements.requestStr = buffer_pool::acquire(4096);
+	std::string &requestStr = requestElements.requestStr;
+
+	auto &error = requestElements.error;
+
 	auto set_error = [&](const int code, const std::string message) {
+		if (error.code != 0) // the first error is answered
+			return;
 		error.code = code;
 		error.message = message;
 	};
@@ -101,112 +983,188 @@ static void handleRequest(int clientfd, server::requestCallbackType requestListe
 		panic(message + ": "s + std::strerror(errno));
 	};
 
-	{ // recieve request
-		constexpr int BUFFER_SIZE = 256;
+	{ // recieve request, checking the limits as the head arrives so it never grows past them
+		constexpr int BUFFER_SIZE = 4096;
 		char buffer[BUFFER_SIZE];
 
 		std::string delimiter = "\r\n\r\n";
-		size_t pos = std::string::npos;
+		size_t searchFrom = 0; // the delimiter is only looked for in what is new
+		size_t requestLineEnd = std::string::npos;
+		size_t lines = 0;
 
-		while ((pos = requestStr.find(delimiter)) == std::string::npos) {
-			int bytesread = recv(clientfd, buffer, BUFFER_SIZE - 1, 0);
+		// checked once more when the head is complete, all of it may have arrived with one read
+		while (true) {
+			const size_t headEnd = requestStr.find(delimiter, searchFrom);
+			searchFrom = requestStr.length() < delimiter.length() ? 0 : requestStr.length() - delimiter.length() + 1;
+
+			if (requestLineEnd == std::string::npos)
+				requestLineEnd = requestStr.find('\n');
+
+			if (requestLineEnd == std::string::npos ? requestStr.length() > _limits.requestLine
+													: requestLineEnd > _limits.requestLine) {
+				set_error(414, "URI Too Long");
+				break;
+			}
+			const size_t headersEnd = headEnd == std::string::npos ? requestStr.length() : headEnd + 2;
+			if (requestLineEnd != std::string::npos &&
+				(headersEnd - requestLineEnd - 1 > _limits.headerBytes ||
+				 (headEnd == std::string::npos && lines - 1 > _limits.headerCount))) {
+				set_error(431, "Request Header Fields Too Large");
+				break;
+			}
+
+			if (headEnd != std::string::npos)
+				break;
+
+			int bytesread = recv(clientfd, buffer, BUFFER_SIZE, 0);
+			accounting::received(std::max(bytesread, 0));
 			if (bytesread <= 0) {
 				panic_errno("Failed to recieve message from socket");
 				break;
 			}
 
-			buffer[bytesread] = '\0';
-			requestStr += buffer;
+			requestStr.append(buffer, bytesread);
+			accounting::copied(bytesread);
+			lines += std::count(buffer, buffer + bytesread, '\n');
 		}
 	}
 
-	struct {
-		std::string method, url, protocolVersion;
-		std::unordered_map<std::string, std::string> headers;
-		std::unordered_map<std::string, std::string> payload; // POST-only
+	profiler::enter(profiler::stage::PARSE);
 
-		const std::string getHeader(const std::string &key) {
-			try {
-				return headers.at(key);
-			} catch (const std::exception &e) {
-				return "_";
+	// the receive loop stops in the middle of the HTTP/2 connection preface, after "PRI * HTTP/2.0\r\n\r\n"
+	constexpr std::string_view http2RequestLine = http2_connection::preface.substr(0, 18);
+
+	if (_http2 && std::string_view(requestStr).substr(0, http2RequestLine.length()) == http2RequestLine) {
+		const std::optional<peer_credentials> &credentials = requestElements.credentials;
+		http2_connection connection(
+			clientfd,
+			[this, &peer, &credentials](request &req) {
+				req._peerCredentials = credentials;
+				dispatchHttp2(req, peer);
+			},
+			http2Limits(_limits), _http2IdleTimeout, _http2Lifetime);
+		connection.serve(requestStr);
+
+		if (close(clientfd) < 0)
+			::http::warn("Failed to close the socket: ", std::strerror(errno));
+		recycle(std::move(current));
+		return;
+	}
+
+	{ // parse request
+		{ // parse request line, assigned into the recycled strings
+			std::string_view line = std::string_view(requestStr).substr(0, requestStr.find('\n'));
+
+			for (std::string *element :
+				 {&requestElements.method, &requestElements.url, &requestElements.protocolVersion}) {
+				const size_t start = std::min(line.find_first_not_of(" \t\r"), line.length());
+				line.remove_prefix(start);
+
+				const size_t end = std::min(line.find_first_of(" \t\r"), line.length());
+				element->assign(line.substr(0, end));
+				accounting::copied(end);
+				line.remove_prefix(end);
 			}
 		}
 
-		const std::string getPlatform() {
-			const std::string userAgent = getHeader("User-Agent");
-
-			for (const auto &[agent, platform] : std::vector<std::pair<std::string, std::string>>({
-					 {"Windows NT 10.0", "Windows 10"},
-					 {"Windows NT 6.3", "Windows 8.1"},
-					 {"Windows NT 6.2", "Windows 8"},
-					 {"Windows NT 6.1", "Windows 7"},
-					 {"Windows NT 6.0", "Windows Vista"},
-					 {"Windows NT 5.2", "Windows Server 2003/XP x64"},
-					 {"Windows NT 5.1", "Windows XP"},
-					 {"Windows NT 5.01", "Windows 2000, Service Pack 1 (SP1)"},
-					 {"Windows NT 5.0", "Windows 2000"},
-					 {"Windows NT 4.0", "Windows NT 4.0"},
-					 {"Windows NT", "Windows NT"},
-				 })) {
-				if (userAgent.find(agent) != std::string::npos)
-					return platform;
-			}
+		{ // parse headers
+			const std::string_view view = requestStr;
+			size_t pos = view.find('\n'); // skip the request line
+			pos = pos == std::string_view::npos ? view.length() : pos + 1;
+
+			while (pos < view.length()) {
+				size_t end = view.find('\n', pos);
+				if (end == std::string_view::npos)
+					end = view.length();
 
-			for (const auto &platform : {
-					 "Windows",	   "iPhone",	  "iPad",	 "Macintosh", "Mac OS X",	   "Mac_PowerPC", "Mac_68K",
-					 "iOS",		   "Android",	  "FreeBSD", "OpenBSD",	  "NetBSD",		   "SunOS",		  "IRIX",
-					 "HP-UX",	   "AIX",		  "OS/2",	 "QNX",		  "BeOS",		   "AmigaOS",	  "MorphOS",
-					 "Nintendo",   "PlayStation", "Xbox",	 "Linux",	  "X11",		   "Chrome OS",	  "BlackBerry",
-					 "Symbian OS", "PalmOS",	  "WebOS",	 "Tizen",	  "Windows Phone", "Windows CE",
-				 }) {
-				if (userAgent.find(platform) != std::string::npos)
-					return platform;
+				std::string_view line = view.substr(pos, end - pos);
+				pos = end + 1;
+
+				if (!line.empty() && line.back() == '\r')
+					line.remove_suffix(1);
+				if (line.empty())
+					break;
+
+				const size_t colon = line.find(':');
+				std::string_view name = line.substr(0, colon);
+				std::string_view value = colon == std::string_view::npos ? "" : line.substr(colon + 1);
+
+				const size_t first = value.find_first_not_of(" \t");
+				value.remove_prefix(first == std::string_view::npos ? value.length() : first);
+				const size_t last = value.find_last_not_of(" \t");
+				value.remove_suffix(value.length() - (last == std::string_view::npos ? 0 : last + 1));
+
+				requestElements.headers.add(name, value);
 			}
 
-			return "_";
+			if (requestElements.headers.size() > _limits.headerCount)
+				set_error(431, "Request Header Fields Too Large");
 		}
 
-	} requestElements;
+		requestElements.size = requestStr.length();
 
-	{ // parse request
-		std::istringstream requestStream(requestStr);
+		if (error.code == 0) { // parse payload, unless the request is rejected anyway
+			const size_t headEnd = requestStr.find("\r\n\r\n");
+			const std::string_view buffered =
+				headEnd == std::string::npos ? std::string_view() : std::string_view(requestStr).substr(headEnd + 4);
 
-		std::string line;
+			if (_capture && headEnd != std::string::npos) {
+				requestElements.captured.assign(requestStr, 0, headEnd + 4);
+				accounting::copied(headEnd + 4);
+			}
 
-		{ // parse request line
-			std::getline(requestStream, line);
-			std::istringstream requestLineStream(line);
-			requestLineStream >> requestElements.method;
-			requestLineStream >> requestElements.url;
-			requestLineStream >> requestElements.protocolVersion;
-		}
+			const std::string_view contentLength = requestElements.headers.get(header::CONTENT_LENGTH);
+			size_t length = 0;
+			if (!contentLength.empty()) {
+				const auto [end, status] =
+					std::from_chars(contentLength.data(), contentLength.data() + contentLength.length(), length);
+				if (status != std::errc() || end != contentLength.data() + contentLength.length()) {
+					set_error(400, "Bad request");
+				} else if (length > _limits.bodySize) {
+					set_error(413, "Payload Too Large"); // before reading any of it
+				}
+			}
 
-		{ // parse headers
-			std::string header;
-			while (std::getline(requestStream, line) && line != "\r") {
-				std::istringstream headerStream(line);
-				std::getline(headerStream, header, ':');
-				std::string value;
-				std::getline(headerStream, value);
-				value.erase(0, value.find_first_not_of(' '));
-				if (value[value.length() - 1] == '\r')
-					value.pop_back();
-				requestElements.headers[header] = value;
+			if (!contentLength.empty() && error.code == 0) {
+				requestElements.body = request_body(clientfd, buffered, length);
+
+				// the whole body is read now to be captured, the handler reads it from memory instead
+				if (_capture && headEnd != std::string::npos) {
+					if (length <= _capture->maxBodySize()) {
+						std::string &captured = requestElements.captured;
+						const size_t headLength = captured.length();
+
+						captured.resize(headLength + length);
+						size_t received = headLength;
+						while (received < captured.length()) {
+							const size_t n =
+								requestElements.body.read(captured.data() + received, captured.length() - received);
+							if (n == 0)
+								break;
+							received += n;
+						}
+						captured.resize(received);
+
+						requestElements.body =
+							request_body(-1, std::string_view(captured).substr(headLength), length);
+					} else {
+						requestElements.captured.append(buffered.substr(0, length));
+						accounting::copied(std::min(buffered.length(), length));
+						requestElements.captureTruncated = true;
+					}
+				}
 			}
-		}
+			requestElements.size = requestStr.length() - buffered.length() + requestElements.body.length();
 
-		{ // parse payload
-			if (requestElements.method == "POST") {
+			if (requestElements.method == "POST" && error.code == 0) {
 				try {
-					auto lenstr = requestElements.headers.at("Content-Length");
-					auto len = stoi(lenstr);
-					auto contentType = requestElements.headers.at("Content-Type");
-					if (contentType == "application/x-www-form-urlencoded") {
-						std::string payload(len + 1, '\0');
+					if (contentLength.empty() || !requestElements.headers.has(header::CONTENT_TYPE))
+						throw std::invalid_argument("missing Content-Length or Content-Type");
 
-						int bytesread = recv(clientfd, payload.data(), len, 0);
-						if (bytesread <= 0) {
+					auto contentType = std::string(requestElements.headers.get(header::CONTENT_TYPE));
+					if (contentType == "application/x-www-form-urlencoded") {
+						const std::string payload = requestElements.body.readAll();
+						if (payload.length() < length) {
 							panic_errno("Failed to recieve message from socket");
 						}
 
@@ -219,9 +1177,7 @@ static void handleRequest(int clientfd, server::requestCallbackType requestListe
 							std::getline(dataStream, value);
 							requestElements.payload[key] = value;
 						}
-					} else {
-						set_error(501, "Parsing '"s + contentType + "' payloads not implemented by this server"s);
-					}
+					} // other payloads are left to the handler, see request::body
 				} catch (const std::exception &e) {
 					set_error(400, "Bad request");
 				}
@@ -229,95 +1185,277 @@ static void handleRequest(int clientfd, server::requestCallbackType requestListe
 		}
 	}
 
-	method req_method = method::UNKNOWN;
-	std::shared_ptr<request> req;
+	const method req_method = requestElements.requestMethod = methodFromString(requestElements.method);
+	if (req_method == method::UNKNOWN)
+		set_error(501, "The requested method '"s + requestElements.method + "' is not implemented by this server"s);
 
-	{
-		static std::unordered_map<std::string, method> methodMap = {
-			{"GET", method::GET},		  {"HEAD", method::HEAD},	  {"POST", method::POST},
-			{"PUT", method::PUT},		  {"DELETE", method::DELETE}, {"CONNECT", method::CONNECT},
-			{"OPTIONS", method::OPTIONS}, {"TRACE", method::TRACE},	  {"PATCH", method::PATCH},
-		};
+	const url &url = requestElements.requestUrl.emplace(std::string(requestElements.getHeader(header::X_FORWARDED_PROTO)),
+														 std::string(requestElements.getHeader(header::HOST)),
+														 requestElements.url);
+
+	bool limited = false;
+	if (_rateLimiter && error.code == 0) {
+		requestElements.client = clientAddress(requestElements.headers, peer, *_rateLimiter);
+		limited = !_rateLimiter->admit(requestElements.client, requestElements.size);
+	}
+
+	// a body would have to be sent before the 101 and become stream 1's, only requests without one are upgraded
+	if (_http2 && error.code == 0 && !limited && requestElements.body.length() == 0 &&
+		!requestElements.headers.has(header::TRANSFER_ENCODING) &&
+		requestElements.headers.get(header::UPGRADE).find("h2c") != std::string_view::npos &&
+		requestElements.headers.has("HTTP2-Settings")) {
+		constexpr std::string_view switchingProtocols =
+			"HTTP/1.1 101 Switching Protocols\r\nConnection: Upgrade\r\nUpgrade: h2c\r\n\r\n";
+
+		if (writeAll(clientfd, switchingProtocols)) {
+			const std::optional<peer_credentials> &credentials = requestElements.credentials;
+			http2_connection connection(
+				clientfd,
+				[this, &peer, &credentials](request &req) {
+					req._peerCredentials = credentials;
+					dispatchHttp2(req, peer);
+				},
+				http2Limits(_limits), _http2IdleTimeout, _http2Lifetime);
+			connection.serveUpgrade(req_method, url, requestElements.headers,
+									requestElements.headers.get("HTTP2-Settings"));
+		}
+
+		if (close(clientfd) < 0)
+			::http::warn("Failed to close the socket: ", std::strerror(errno));
+		recycle(std::move(current));
+		return;
+	}
+
+	response_cache::lookup &cached = requestElements.cached;
+	if (_cache && error.code == 0 && !limited)
+		cached = _cache->find(req_method, url, requestElements.headers);
+
+	// decided before joining a flight: waiting for an offloaded leader would block this thread, and every connection
+	// with it, until the pool has run the handler and this very thread has taken the exchange back, ie. forever
+	bool &offload = requestElements.offload; // also revalidates a stale response on the pool
+	if (_handlerPool && error.code == 0 && !limited && cached.state != response_cache::freshness::FRESH) {
+		request probe(-1, req_method, url, requestElements.headers, requestElements.payload, requestElements.body);
+		probe._peerCredentials = requestElements.credentials;
+		offload = _offload(probe);
+	}
+
+	single_flight::ticket &flight = requestElements.flight;
+	if (_singleFlight && error.code == 0 && !limited && !offload &&
+		cached.state == response_cache::freshness::MISS)
+		flight = _singleFlight->join(req_method, url, requestElements.headers);
+
+	single_flight::result coalesced;
+	if (!flight.key.empty() && !flight.leader)
+		coalesced = _singleFlight->wait(flight);
+
+	if (limited) {
+		profiler::scope stage(profiler::stage::SEND);
+		if (!writeAll(clientfd, rate_limiter::tooManyRequests))
+			panic_errno("Failed to send 429 response");
+
+		requestElements.client.clear(); // not charged for the 429
+		requestElements.status = 429;
+		requestElements.responseSize = 17; // "Too Many Requests"
+	} else if (cached.state != response_cache::freshness::MISS) { // answered without the handler
+		profiler::scope stage(profiler::stage::SEND);
+		// as serialized, with the Date it was generated at, plus how long it has been cached since
+		char age[32];
+		const int ageLength =
+			std::snprintf(age, sizeof(age), "Age: %llu\r\n", static_cast<unsigned long long>(cached.age));
+		const std::string_view serialized = *cached.response;
+		const size_t fieldsEnd = cached.headLength - 2; // before the blank line
+		iovec iov[3] = {{const_cast<char *>(serialized.data()), fieldsEnd},
+						{age, static_cast<size_t>(ageLength)},
+						{const_cast<char *>(serialized.data()) + fieldsEnd, serialized.length() - fieldsEnd}};
+		if (!writeAll(clientfd, iov, 3))
+			panic_errno("Failed to send cached response");
+
+		requestElements.status = cached.status;
+		requestElements.responseSize = cached.size;
+	} else if (coalesced.response) { // answered with the response of an identical request
+		profiler::scope stage(profiler::stage::SEND);
+		if (!writeAll(clientfd, *coalesced.response))
+			panic_errno("Failed to send coalesced response");
+
+		requestElements.status = coalesced.status;
+		requestElements.responseSize = coalesced.size;
+	} else {
+		request &req = requestElements.req.emplace(clientfd, req_method, url, requestElements.headers,
+												   requestElements.payload, requestElements.body);
+		req._peerCredentials = requestElements.credentials;
+
+		if (offload) {
+			req._offloaded = true;
+
+			// the response is only serialized once the listening thread takes the exchange back, see finish
+			req.response()._sender = [](const response &) { return true; };
+
+			requestElements.usage += accounting::current() - requestElements.mark;
+
+			exchange *offloaded = current.release();
+			_offloaded++;
+			_handlerPool->submit([this, offloaded] {
+				const resource_usage mark = accounting::current();
+				try {
+					dispatch(*offloaded->req, 0, {});
+				} catch (const std::exception &e) { // must not end the worker, nor leave the client waiting
+					::http::warn("Offloaded handler failed: ", e.what());
+					_dispatchError(*offloaded->req, 500, "Something went wrong");
+				}
+				offloaded->usage += accounting::current() - mark;
+				postCompletion(offloaded);
+			});
+			return;
+		}
 
 		try {
-			req_method = methodMap.at(requestElements.method);
-		} catch (const std::exception &e) {
-			set_error(501, "The requested method '"s + requestElements.method + "' is not implemented by this server"s);
+			dispatch(req, error.code, error.message);
+		} catch (...) { // the waiting requests still have to be released
+			if (flight.leader)
+				_singleFlight->complete(flight, req.response());
+			throw;
 		}
+	}
 
-		url url(requestElements.getHeader("X-Forwarded-Proto"), requestElements.getHeader("Host"), requestElements.url);
+	finish(std::move(current));
+}
 
-		req = std::make_shared<request>(clientfd, req_method, url, requestElements.headers, requestElements.payload);
+void server::finish(std::unique_ptr<exchange> current) {
+	exchange &requestElements = *current;
 
-		if (error.code > 0) {
-			dispatchError(*req, error.code, error.message);
-		} else if (error.code != -1) {
-			try {
-				if (!requestListener(*req))
-					throw exception(500, "Something went wrong");
-			} catch (const exception &e) {
-				dispatchError(*req, e.code, e.message);
-			}
+	if (requestElements.req) {
+		response &response = requestElements.req->response();
+
+		if (response._sender) { // offloaded, the handler only prepared the response
+			requestElements.mark = accounting::current(); // back on the listening thread
+			response._sender = nullptr;
+			response._sent = response._streamed;
+			response.send();
 		}
+
+		if (requestElements.flight.leader)
+			_singleFlight->complete(requestElements.flight, response);
+
+		if (!requestElements.cached.key.empty())
+			_cache->store(requestElements.cached, response);
+
+		requestElements.status = response.status();
+		requestElements.responseSize = response.size();
 	}
 
 	{ // close
-		if (close(clientfd) < 0) {
-			panic_errno("Failed to close the socket");
+		// the rest of a rejected request, or a body the handler did not read
+		const int code = requestElements.error.code;
+		const bool unreadInput = code == 413 || code == 414 || code == 431 || requestElements.body.unreceived() > 0;
+
+		if ((unreadInput ? lingeringClose(requestElements.clientfd) : close(requestElements.clientfd)) < 0 &&
+			requestElements.error.code != -1) {
+			requestElements.error.code = -1;
+			requestElements.error.message = "Failed to close the socket: "s + std::strerror(errno);
 		}
 	}
 
+	if (_rateLimiter && !requestElements.client.empty() && requestElements.error.code == 0)
+		_rateLimiter->charge(requestElements.client, requestElements.responseSize);
+
+	// the client already got the stale response
+	const bool revalidate = requestElements.cached.state == response_cache::freshness::STALE;
+	if (revalidate && !requestElements.offload)
+		revalidateCached(requestElements);
+
 	const auto endTime = std::chrono::high_resolution_clock::now();
 
-	const static auto formatSize = [](const size_t bytes) -> std::string {
-		const static size_t kilobyte = 1024;
-		const static size_t megabyte = 1024 * 1024;
-		const static size_t gigabyte = 1024 * 1024 * 1024;
-
-		if (bytes < kilobyte) {
-			return std::to_string(bytes) + "B";
-		} else if (bytes < megabyte) {
-			double sizeInKB = static_cast<double>(bytes) / kilobyte;
-			return std::to_string(sizeInKB) + "KB";
-		} else if (bytes < gigabyte) {
-			double sizeInMB = static_cast<double>(bytes) / megabyte;
-			return std::to_string(sizeInMB) + "MB";
-		} else {
-			double sizeInGB = static_cast<double>(bytes) / gigabyte;
-			return std::to_string(sizeInGB) + "GB";
-		}
-	};
+	// logging is not attributed to the request, it is buffered and written for many requests at once
+	resource_usage &usage = requestElements.usage;
+	usage += accounting::current() - requestElements.mark;
+	accounting::add(usage);
+
+	if (_capture && !requestElements.captured.empty()) {
+		const auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(endTime - requestElements.startTime);
+		const auto arrival = std::chrono::system_clock::now().time_since_epoch() - duration;
 
-	const static auto executionTime = [&startTime, &endTime]() -> std::string {
-		const auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime);
-		if (duration.count() < 1000) {
-			return std::to_string(duration.count()) + "ms"s;
-		} else if (duration.count() < 60000) {
-			auto seconds = std::chrono::duration_cast<std::chrono::seconds>(duration);
-			return std::to_string(seconds.count()) + "s"s;
+		traffic_capture::record_header record = {};
+		record.arrival = std::chrono::duration_cast<std::chrono::nanoseconds>(arrival).count();
+		record.duration = duration.count();
+		record.responseBytes = requestElements.responseSize;
+		record.length = static_cast<uint32_t>(requestElements.captured.length());
+		record.status = requestElements.error.code == -1 ? 0 : static_cast<uint16_t>(requestElements.status);
+		record.flags = requestElements.captureTruncated ? traffic_capture::TRUNCATED : 0;
+		_capture->record(record, requestElements.captured);
+	}
+
+	if (_accessLog) {
+		access_log::entry entry = accessLogEntry(requestElements.headers, requestElements.method, requestElements.url,
+												 endTime - requestElements.startTime);
+		if (requestElements.error.code == -1) {
+			entry.error = requestElements.error.message;
 		} else {
-			auto minutes = std::chrono::duration_cast<std::chrono::minutes>(duration);
-			auto seconds = std::chrono::duration_cast<std::chrono::seconds>(duration - minutes);
-			return std::to_string(seconds.count()) + "min"s;
+			entry.status = requestElements.status;
 		}
-	};
+		entry.requestBytes = requestElements.size;
+		entry.responseBytes = requestElements.responseSize;
+		entry.usage = &usage;
+		_accessLog->append(entry);
+	} else {
+		logRequest(requestElements.headers, requestElements.method, requestElements.url,
+				   requestElements.error.code == -1
+					   ? requestElements.error.message
+					   : std::to_string(requestElements.status) + " "s + formatSize(requestElements.responseSize),
+				   endTime - requestElements.startTime);
+	}
 
-	const static auto responseOrError = [&]() -> std::string {
-		if (error.code == -1)
-			return error.message;
-		return std::to_string(req->response().status()) + " "s + formatSize(req->response().size());
-	};
+	if (revalidate && requestElements.offload) { // the exchange comes back once revalidated, see completeOffloaded
+		exchange *revalidating = current.release();
+		revalidating->revalidating = true;
+		_offloaded++;
+		_handlerPool->submit([this, revalidating] {
+			try {
+				revalidateCached(*revalidating);
+			} catch (const std::exception &e) { // must not end the worker, the stale entry is simply kept
+				::http::warn("Offloaded revalidation failed: ", e.what());
+			}
+			postCompletion(revalidating);
+		});
+		return;
+	}
 
-	::http::log(										   // log message
-		requestElements.getHeader("X-Forwarded-For"), "/", // IP/
-		requestElements.getHeader("Cf-Ipcountry"), " ",	   // COUNTRY
-		"(", requestElements.getPlatform(), ") ",		   // "PLATFORM"
-		requestElements.method, " ",					   // METHOD
-		requestElements.getHeader("Host"), " ",			   // HOST
-		requestElements.url, " ",						   // PATH
-		responseOrError(), " ",							   // RESPONSE (CODE AND SIZE) or ERROR
-		executionTime()									   // EXECUTION TIME
-	);
+	recycle(std::move(current));
+}
+
+void server::revalidateCached(exchange &requestElements) {
+	request req(-1, requestElements.requestMethod, *requestElements.requestUrl, requestElements.headers,
+				requestElements.payload);
+	dispatch(req, requestElements.error.code, requestElements.error.message);
+	_cache->store(requestElements.cached, req.response());
+}
+
+void server::postCompletion(exchange *completed) {
+	{
+		std::lock_guard lock(_completionMutex);
+		_completions.push_back(completed);
+	}
+	if (write(_completionPipe[1], "", 1) < 0 && errno != EAGAIN)
+		::http::warn("Failed to wake up the server: ", std::strerror(errno));
+}
+
+void server::completeOffloaded() {
+	char drained[64];
+	while (read(_completionPipe[0], drained, sizeof(drained)) > 0) {
+	}
+
+	std::vector<exchange *> completed;
+	{
+		std::lock_guard lock(_completionMutex);
+		completed.swap(_completions);
+	}
+
+	for (exchange *exchange : completed) {
+		_offloaded--;
+		if (exchange->revalidating)
+			recycle(std::unique_ptr<server::exchange>(exchange));
+		else
+			finish(std::unique_ptr<server::exchange>(exchange));
+	}
 }
 
-} // namespace http
\ No newline at end of file
+} // namespace http
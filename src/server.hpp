@@ -1,14 +1,28 @@
 #pragma once
 
+#include <chrono>
 #include <functional>
 #include <cstddef>
+#include <csignal>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <vector>
 
 // OS-SPECIFIC INCLUDES TODO: CHANGE WHEN IMPLEMENTING CROSS-PLATFORM SUPPORT
-#include <netinet/ip.h>
+#include <sys/socket.h>
+#include <sys/types.h>
 
 #include "host.hpp"
+#include "listener.hpp"
 #include "request.hpp"
+#include "cache.hpp"
+#include "single_flight.hpp"
+#include "rate_limit.hpp"
+#include "handler_pool.hpp"
+#include "access_log.hpp"
+#include "capture.hpp"
+#include "accounting.hpp"
 
 namespace http {
 
@@ -16,21 +30,175 @@ class server {
   public:
 	using requestCallbackType = std::function<bool(request &)>;
 	using requestErrorCallbackType = std::function<bool(request &, int, const std::string &)>;
+	using offloadCallbackType = std::function<bool(const request &)>;
+	using workerInitCallbackType = std::function<void(unsigned worker)>;
+
+	// Checked while the head arrives, so a connection never buffers more than requestLine + headerBytes (plus one
+	// read); bodies are checked against Content-Length before any of them is read. Once rejected, what the client
+	// still sends is read and dropped for up to 100ms or 1MiB before closing, so the response is not lost to a reset.
+	// HTTP/2 streams get the same limits, their pseudo-headers counting as header bytes, see http2_connection.
+	struct limits {
+		size_t requestLine = 8 * 1024;		// 414 past it
+		size_t headerCount = 100;			// 431 past it
+		size_t headerBytes = 64 * 1024;		// 431 past it, not counting the request line
+		size_t bodySize = 16 * 1024 * 1024; // 413 past it
+	}; // limits
+
+	struct worker_status {
+		unsigned index;
+		pid_t pid; // 0 while waiting to be restarted
+		unsigned restarts;
+		uint64_t requests; // including those of the workers it replaced
+		resource_usage usage;
+	}; // worker_status
 
 	server(requestCallbackType requestListener, requestErrorCallbackType dispatchError);
 
+	// Accept connections on another address or port, before listen
+	void addListener(const listener &listener);
+
+	// Listens on every added listener, returns once the server has been drained (see stopAllInstances)
+	void listen(std::function<void()> successCallback, std::function<void(const std::string &)> errorCallback);
+
+	// Adds a listener on host:port first
 	void listen(const host &host, uint16_t port, std::function<void()> successCallback,
 				std::function<void(const std::string &)> errorCallback);
 
+	// On SIGINT/SIGTERM/SIGQUIT/SIGHUP every instance stops accepting, finishes the request it is serving and returns
+	// from listen; if that takes longer than the drain timeout (exit status 1), or a second signal arrives, the process
+	// exits. Any other signal closes the sockets and exits immediately.
 	static void stopAllInstances(int);
+	static void setDrainTimeout(unsigned seconds);
+
+	// Hot upgrade: a server listening with an upgrade socket hands its listening sockets over (SCM_RIGHTS) to the next
+	// process that calls listen with the same upgrade socket path, then drains. The new process never binds, so there
+	// is always a listener; it has to add the same listeners in the same order.
+	void setUpgradeSocket(const std::string &path);
+
+	// Alternative to the upgrade socket: both processes bind the same port with SO_REUSEPORT. Only applies to the
+	// listener added by listen(host, port, ...), see listener::reusePort.
+	void setReusePort(bool reusePort);
+
+	// Pin the thread calling listen to a CPU before it allocates anything. Its receive buffers, recycled requests and
+	// response buffers are then allocated on the NUMA node of that CPU (first touch) and stay there, being recycled
+	// by the same thread. -1 (default) leaves the thread to the scheduler.
+	void setCpuAffinity(int cpu);
+
+	// Prefork: listen binds the listeners, then forks count worker processes which serve them, each with its own event
+	// loop and no memory shared, while this process supervises them. A worker that crashes or exits is restarted, after
+	// a second if it did not live for one. On SIGINT/SIGTERM/SIGQUIT/SIGHUP (see stopAllInstances) the supervisor
+	// drains the workers and listen returns, in the workers as well.
+	// Threads do not survive fork, so handler pools have to be created and set by init, which runs in each worker
+	// before it serves. With a CPU affinity, worker i is pinned to CPU cpu + i instead of the supervisor.
+	void setWorkers(unsigned count, workerInitCallbackType init = {});
+
+	// In the supervising process, what each worker last reported (once a second while it serves)
+	std::vector<worker_status> workers() const;
+
+	// Serve cacheable requests from cache (not owned, may be shared between servers)
+	void setResponseCache(response_cache &cache);
+
+	// Coalesce identical concurrent requests, only useful if it is shared by servers listening on several threads.
+	// Requests offloaded to a handler pool are never coalesced, see setHandlerPool.
+	void setSingleFlight(single_flight &singleFlight);
+
+	// Answer clients over the limit with 429 before anything else (not owned, may be shared between servers). Clients
+	// are identified by their peer address, or by X-Forwarded-For behind trusted proxies, see rate_limiter::trustProxy.
+	void setRateLimiter(rate_limiter &limiter);
+
+	// Run the handler on pool (not owned, may be shared between servers) for the requests offload returns true for, eg.
+	// by route, so CPU-heavy handlers do not hold up the other connections; the rest still run inline. The listening
+	// thread keeps accepting meanwhile and sends the response once the handler returns. Responses that are streamed
+	// (websocket, SSE, proxy) are written by the pool thread, websockets are only accepted there. HTTP/2 requests
+	// always run inline.
+	void setHandlerPool(handler_pool &pool, offloadCallbackType offload);
+
+	// Log requests as binary records to log (not owned, may be shared between servers) instead of as text to stdout
+	void setAccessLog(access_log &log);
+
+	// Record HTTP/1.1 requests (not owned, may be shared between servers) for http-replay, see traffic_capture
+	void setCapture(traffic_capture &capture);
+
+	// Accept HTTP/2 over cleartext (prior knowledge, or Upgrade: h2c on a request without a body). An HTTP/2 connection
+	// is served on the listening thread, which accepts no other connection meanwhile: until the client closes it or
+	// stays idle for idleTimeoutSeconds, and at most for lifetimeSeconds, after which GOAWAY has the client reconnect
+	// and the open streams get one more idle timeout. The limits apply to every stream.
+	void setHttp2(bool enabled, unsigned idleTimeoutSeconds = 5, unsigned lifetimeSeconds = 10);
+
+	void setLimits(const limits &limits);
 
 	bool stop();
 
   private:
-	int _sockfd;
-	sockaddr_in _serveraddr;
+	struct exchange;
+
+	void handOff();
+	void serve(); // until drained
+	bool supervise(); // returns true in a worker once it has served
+	bool spawn(size_t index); // returns true in the worker
+	void report();
+	void handleRequest(int clientfd, const sockaddr_storage &peer);
+	void finish(std::unique_ptr<exchange> exchange); // sends an offloaded response, closes, logs and recycles
+	void completeOffloaded();
+	void revalidateCached(exchange &requestElements);
+	void postCompletion(exchange *completed); // from the handler pool
+
+	static std::unique_ptr<exchange> takeExchange();
+	static void recycle(std::unique_ptr<exchange> exchange);
+	void dispatch(request &req, int errorCode, const std::string &errorMessage);
+	void dispatchHttp2(request &req, const sockaddr_storage &peer);
+
+	std::vector<listener> _listeners;
+	std::vector<int> _sockfds; // in the order of _listeners
+
+	int _controlfd = -1;
+	std::string _upgradeSocketPath;
+	bool _reusePort = false;
+	int _cpu = -1;
+
+	struct worker {
+		pid_t pid = 0;
+		int reportfd = -1; // read end, hangs up once the worker exits
+		std::chrono::steady_clock::time_point started, restartAt;
+		worker_status status = {};
+		uint64_t retiredRequests = 0; // of the workers it replaced
+		resource_usage retiredUsage;
+	};
+
+	unsigned _workerCount = 0;
+	workerInitCallbackType _workerInit;
+	std::vector<worker> _workers; // in the supervisor
+	mutable std::mutex _workersMutex;
+	int _worker = -1;	  // index of this process, -1 unless it is a worker
+	int _reportfd = -1; // in a worker, to the supervisor
+	std::chrono::steady_clock::time_point _reported;
+	limits _limits;
+	bool _draining = false;
+
+	bool _http2 = false;
+	unsigned _http2IdleTimeout = 5;
+	unsigned _http2Lifetime = 10;
+
+	response_cache *_cache = nullptr;
+	single_flight *_singleFlight = nullptr;
+	rate_limiter *_rateLimiter = nullptr;
+	access_log *_accessLog = nullptr;
+	traffic_capture *_capture = nullptr;
+
+	handler_pool *_handlerPool = nullptr;
+	offloadCallbackType _offload;
+	int _completionPipe[2] = {-1, -1}; // wakes the listening thread once an offloaded handler returns
+	std::mutex _completionMutex;
+	std::vector<exchange *> _completions;
+	size_t _offloaded = 0; // handlers running or queued on the pool
+
+	static thread_local std::vector<std::unique_ptr<exchange>> _spareExchanges;
+
+	static std::unordered_map<server *, std::string> _instances; // the addresses they listen on
 
-	static std::unordered_map<server *, std::pair<host, uint16_t>> _instances;
+	static volatile std::sig_atomic_t _drainRequested;
+	static unsigned _drainTimeout;
+	static int _wakePipe[2];
 
 	const requestCallbackType _requestListener;
 	const requestErrorCallbackType _dispatchError;
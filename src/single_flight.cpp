@@ -0,0 +1,80 @@
+#include "single_flight.hpp"
+
+#include <condition_variable>
+
+#include "cache.hpp"
+
+using namespace std::string_literals;
+
+namespace http {
+
+struct single_flight::call {
+	std::mutex mutex;
+	std::condition_variable done;
+	size_t waiters = 0;
+	bool completed = false;
+	result outcome;
+};
+
+single_flight::single_flight()
+	: single_flight([](method method, const url &url, const request_headers &headers) -> std::string {
+		  // a credentialed request may get a response for its client only
+		  if (method != method::GET || headers.has(header::COOKIE) || headers.has(header::AUTHORIZATION))
+			  return ""s;
+		  return url.href;
+	  }) {
+}
+
+single_flight::single_flight(keyCallbackType key) : _key(key) {
+}
+
+single_flight::ticket single_flight::join(method method, const url &url, const request_headers &headers) {
+	ticket ticket;
+	ticket.key = _key(method, url, headers);
+	if (ticket.key.empty())
+		return ticket;
+
+	std::lock_guard lock(_mutex);
+
+	auto [it, inserted] = _calls.try_emplace(ticket.key);
+	if (inserted) {
+		it->second = std::make_shared<call>();
+		ticket.leader = true;
+	} else {
+		std::lock_guard callLock(it->second->mutex);
+		it->second->waiters++;
+	}
+
+	ticket.flight = it->second;
+	return ticket;
+}
+
+void single_flight::complete(const ticket &ticket, const response &response) {
+	{ // later requests run the handler again
+		std::lock_guard lock(_mutex);
+		_calls.erase(ticket.key);
+	}
+
+	std::lock_guard lock(ticket.flight->mutex);
+
+	// only serialized if someone is waiting for it; a streamed response, or one for its client only (see
+	// response_cache::isShareable), leaves the waiters to run the handler themselves
+	if (ticket.flight->waiters > 0 && response_cache::isShareable(response)) {
+		ticket.flight->outcome.response = std::make_shared<const std::string>(response.head().append(response.content()));
+		ticket.flight->outcome.status = response._status;
+		ticket.flight->outcome.size = response.content().size();
+	}
+
+	ticket.flight->completed = true;
+	ticket.flight->done.notify_all();
+}
+
+single_flight::result single_flight::wait(const ticket &ticket) {
+	std::unique_lock lock(ticket.flight->mutex);
+	ticket.flight->done.wait(lock, [&ticket]() {
+		return ticket.flight->completed;
+	});
+	return ticket.flight->outcome;
+}
+
+} // namespace http
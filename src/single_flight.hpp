@@ -0,0 +1,55 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "method.hpp"
+#include "url.hpp"
+#include "headers.hpp"
+#include "response.hpp"
+
+namespace http {
+
+// Opt-in request coalescing for servers listening on several threads (see server::setSingleFlight).
+// While the handler runs for a request, identical requests (same key) wait for it instead of running the handler
+// themselves, then all get a copy of its serialized response, unless it is meant for its client only (see
+// response_cache::isShareable): the others then run the handler themselves.
+class single_flight {
+  public:
+	// Requests with an empty key are never coalesced
+	using keyCallbackType = std::function<std::string(method, const url &, const request_headers &)>;
+
+	struct call; // shared by the requests of one flight
+
+	struct ticket {
+		std::string key; // empty if the request is not coalesced
+		bool leader = false;
+		std::shared_ptr<call> flight;
+	};
+
+	struct result {
+		std::shared_ptr<const std::string> response; // null if the leader's response was streamed or not shareable
+		int status = 0;
+		size_t size = 0; // of the content
+	};
+
+	single_flight(); // GET requests with the same href, without Cookie or Authorization
+	explicit single_flight(keyCallbackType key);
+
+	ticket join(method method, const url &url, const request_headers &headers);
+
+	// The leader calls complete once its response is ready, the others wait for it
+	void complete(const ticket &ticket, const response &response);
+	result wait(const ticket &ticket);
+
+  private:
+	const keyCallbackType _key;
+
+	std::mutex _mutex;
+	std::unordered_map<std::string, std::shared_ptr<call>> _calls;
+}; // single_flight
+
+} // namespace http
@@ -0,0 +1,265 @@
+#include "sse.hpp"
+
+// OS-SPECIFIC INCLUDES TODO: CHANGE WHEN IMPLEMENTING CROSS-PLATFORM SUPPORT
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include "exception.hpp"
+#include "io.hpp"
+
+using namespace std::string_literals;
+
+namespace http {
+
+sse_hub::sse_hub(size_t queueLimit, overflow_policy policy) : _queueLimit(queueLimit > 0 ? queueLimit : 1), _policy(policy) {
+	if (pipe2(_wakePipe, O_NONBLOCK | O_CLOEXEC) < 0)
+		throw exception(500, "Failed to create the SSE hub wake pipe");
+
+	_writer = std::thread(&sse_hub::run, this);
+}
+
+sse_hub::~sse_hub() {
+	_stopping = true;
+	wake();
+	_writer.join();
+
+	for (auto &[topic, subscribers] : _topics) {
+		for (auto &subscriber : subscribers)
+			close(subscriber->fd);
+	}
+
+	close(_wakePipe[0]);
+	close(_wakePipe[1]);
+}
+
+void sse_hub::subscribe(request &req, const std::string &topic) {
+	response &res = req.response();
+	if (res._clientfd < 0)
+		throw exception(501, "Server-Sent Events are only served over HTTP/1.1");
+
+	const std::string head = "HTTP/1.1 200 OK\r\n"s + std::string(response::dateHeader()) +
+							 "Content-Type: text/event-stream\r\n"
+							 "Cache-Control: no-cache\r\n"
+							 "Connection: keep-alive\r\n\r\n";
+
+	res._sent = true;
+	res._streamed = true;
+	if (!writeAll(res._clientfd, head))
+		return;
+
+	// the server closes its descriptor once the handler returns, the duplicate keeps the connection open
+	const int fd = fcntl(res._clientfd, F_DUPFD_CLOEXEC, 0);
+	if (fd < 0)
+		return;
+	fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+
+	auto added = std::make_shared<subscriber>();
+	added->fd = fd;
+
+	{
+		std::lock_guard lock(_mutex);
+		_topics[topic].push_back(std::move(added));
+		_subscribers++;
+	}
+
+	wake();
+}
+
+size_t sse_hub::publish(const std::string &topic, std::string_view data, std::string_view event, std::string_view id) {
+	std::string encoded;
+	encoded.reserve(data.length() + event.length() + id.length() + 32);
+
+	if (!event.empty()) {
+		encoded += "event: ";
+		encoded += event;
+		encoded += '\n';
+	}
+	if (!id.empty()) {
+		encoded += "id: ";
+		encoded += id;
+		encoded += '\n';
+	}
+
+	size_t start = 0;
+	do {
+		size_t end = data.find('\n', start);
+		if (end == std::string_view::npos)
+			end = data.length();
+
+		encoded += "data: ";
+		encoded += data.substr(start, end - start);
+		encoded += '\n';
+
+		start = end + 1;
+	} while (start < data.length());
+	encoded += '\n';
+
+	const auto buffer = std::make_shared<const std::string>(std::move(encoded));
+
+	size_t queued = 0;
+	{
+		std::lock_guard lock(_mutex);
+
+		const auto it = _topics.find(topic);
+		if (it == _topics.end())
+			return 0;
+
+		for (auto &subscriber : it->second) {
+			if (subscriber->closed)
+				continue;
+
+			if (subscriber->queue.size() >= _queueLimit) {
+				_dropped++;
+
+				if (_policy == overflow_policy::DROP_NEWEST)
+					continue;
+
+				if (_policy == overflow_policy::DISCONNECT) {
+					subscriber->closed = true;
+					continue;
+				}
+
+				// the front may be partially written already
+				if (subscriber->offset > 0) {
+					if (subscriber->queue.size() > 1)
+						subscriber->queue.erase(subscriber->queue.begin() + 1);
+					else
+						continue;
+				} else {
+					subscriber->queue.pop_front();
+				}
+			}
+
+			subscriber->queue.push_back(buffer);
+			queued++;
+		}
+	}
+
+	wake(); // also sweeps subscribers disconnected by the overflow policy
+	return queued;
+}
+
+size_t sse_hub::subscribers() const {
+	std::lock_guard lock(_mutex);
+	return _subscribers;
+}
+
+size_t sse_hub::dropped() const {
+	std::lock_guard lock(_mutex);
+	return _dropped;
+}
+
+void sse_hub::wake() {
+	const char byte = 0;
+	[[maybe_unused]] ssize_t written = write(_wakePipe[1], &byte, 1); // a full pipe already wakes the writer
+}
+
+// Writes as much of the queue as the socket takes without blocking, returns false if the connection is gone
+bool sse_hub::flush(subscriber &subscriber) {
+	while (!subscriber.queue.empty()) {
+		iovec iov[16];
+		int iovcnt = 0;
+
+		for (const auto &buffer : subscriber.queue) {
+			if (iovcnt == 16)
+				break;
+
+			const size_t offset = iovcnt == 0 ? subscriber.offset : 0;
+			iov[iovcnt++] = {const_cast<char *>(buffer->data()) + offset, buffer->length() - offset};
+		}
+
+		ssize_t written = writev(subscriber.fd, iov, iovcnt);
+		if (written < 0) {
+			if (errno == EINTR)
+				continue;
+			return errno == EAGAIN || errno == EWOULDBLOCK;
+		}
+
+		while (written > 0) {
+			const size_t remaining = subscriber.queue.front()->length() - subscriber.offset;
+			if (static_cast<size_t>(written) < remaining) {
+				subscriber.offset += written;
+				break;
+			}
+
+			written -= remaining;
+			subscriber.offset = 0;
+			subscriber.queue.pop_front();
+		}
+	}
+
+	return true;
+}
+
+void sse_hub::run() {
+	std::vector<pollfd> pfds;
+	std::vector<std::shared_ptr<subscriber>> polled;
+
+	while (!_stopping) {
+		pfds.assign(1, {_wakePipe[0], POLLIN, 0});
+		polled.clear();
+
+		{
+			std::lock_guard lock(_mutex);
+
+			for (auto &[topic, subscribers] : _topics) {
+				for (auto &subscriber : subscribers) {
+					pfds.push_back({subscriber->fd, static_cast<short>(POLLIN | (subscriber->queue.empty() ? 0 : POLLOUT)), 0});
+					polled.push_back(subscriber);
+				}
+			}
+		}
+
+		if (poll(pfds.data(), pfds.size(), -1) < 0 && errno != EINTR)
+			break;
+
+		if (pfds[0].revents & POLLIN) {
+			char buffer[64];
+			while (read(_wakePipe[0], buffer, sizeof(buffer)) > 0)
+				;
+		}
+
+		std::lock_guard lock(_mutex);
+
+		for (size_t i = 0; i < polled.size(); i++) {
+			subscriber &subscriber = *polled[i];
+			const short revents = pfds[i + 1].revents;
+
+			if (revents & (POLLIN | POLLERR | POLLHUP)) {
+				// clients never send anything on an event stream, so readable means closed
+				char buffer[256];
+				const ssize_t n = recv(subscriber.fd, buffer, sizeof(buffer), 0);
+				if (n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK))
+					subscriber.closed = true;
+			}
+
+			if (!subscriber.closed && !subscriber.queue.empty() && !flush(subscriber))
+				subscriber.closed = true;
+		}
+
+		// closed subscribers may also come from publish, so sweep every topic
+		for (auto it = _topics.begin(); it != _topics.end();) {
+			auto &subscribers = it->second;
+			for (size_t i = 0; i < subscribers.size();) {
+				if (subscribers[i]->closed) {
+					close(subscribers[i]->fd);
+					subscribers[i] = std::move(subscribers.back());
+					subscribers.pop_back();
+					_subscribers--;
+				} else {
+					i++;
+				}
+			}
+
+			if (subscribers.empty())
+				it = _topics.erase(it);
+			else
+				++it;
+		}
+	}
+}
+
+} // namespace http
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "request.hpp"
+
+namespace http {
+
+// Server-Sent Events fan-out. A handler subscribes its connection to a topic and returns immediately; the hub keeps
+// the connection and writes every event published to the topic from its own thread. Each event is encoded once into a
+// shared buffer which is queued, not copied, for every subscriber.
+class sse_hub {
+  public:
+	// What happens to an event published to a subscriber whose queue is full
+	enum class overflow_policy {
+		DROP_OLDEST, // the oldest event not yet being written is dropped
+		DROP_NEWEST, // the new event is dropped
+		DISCONNECT,	 // the subscriber is disconnected
+	}; // overflow_policy
+
+	explicit sse_hub(size_t queueLimit = 64, overflow_policy policy = overflow_policy::DROP_OLDEST);
+	~sse_hub(); // disconnects all subscribers
+
+	sse_hub(const sse_hub &) = delete;
+	sse_hub &operator=(const sse_hub &) = delete;
+
+	// Sends the event stream head and takes the connection over, throws http::exception for HTTP/2 requests
+	void subscribe(request &req, const std::string &topic);
+
+	// Returns the number of subscribers the event was queued for
+	size_t publish(const std::string &topic, std::string_view data, std::string_view event = {},
+				   std::string_view id = {});
+
+	size_t subscribers() const;
+	size_t dropped() const; // events dropped or subscribers disconnected by the overflow policy
+
+  private:
+	struct subscriber {
+		int fd;
+		std::deque<std::shared_ptr<const std::string>> queue;
+		size_t offset = 0; // into queue.front()
+		bool closed = false;
+	};
+
+	void run();
+	void wake();
+	bool flush(subscriber &subscriber);
+
+	const size_t _queueLimit;
+	const overflow_policy _policy;
+
+	mutable std::mutex _mutex;
+	std::unordered_map<std::string, std::vector<std::shared_ptr<subscriber>>> _topics;
+	size_t _subscribers = 0;
+	size_t _dropped = 0;
+
+	int _wakePipe[2] = {-1, -1};
+	std::atomic<bool> _stopping = false;
+	std::thread _writer;
+}; // sse_hub
+
+} // namespace http
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <array>
+#include <string_view>
+#include <utility>
+
+namespace http {
+
+constexpr std::pair<int, std::string_view> statusLines[] = {
+	{100, "HTTP/1.1 100 Continue\r\n"},
+	{101, "HTTP/1.1 101 Switching Protocols\r\n"},
+	{102, "HTTP/1.1 102 Processing\r\n"},
+	{103, "HTTP/1.1 103 Early Hints\r\n"},
+	{110, "HTTP/1.1 110 Response is Stale\r\n"},
+	{111, "HTTP/1.1 111 Revalidation Failed\r\n"},
+	{112, "HTTP/1.1 112 Disconnected Operation\r\n"},
+	{113, "HTTP/1.1 113 Heuristic Expiration\r\n"},
+	{199, "HTTP/1.1 199 Miscellaneous Warning\r\n"},
+	{200, "HTTP/1.1 200 OK\r\n"},
+	{201, "HTTP/1.1 201 Created\r\n"},
+	{202, "HTTP/1.1 202 Accepted\r\n"},
+	{203, "HTTP/1.1 203 Non-Authoritative Information\r\n"},
+	{204, "HTTP/1.1 204 No Content\r\n"},
+	{205, "HTTP/1.1 205 Reset Content\r\n"},
+	{206, "HTTP/1.1 206 Partial Content\r\n"},
+	{207, "HTTP/1.1 207 Multi-Status\r\n"},
+	{208, "HTTP/1.1 208 Already Reported\r\n"},
+	{214, "HTTP/1.1 214 Transformation Applied\r\n"},
+	{226, "HTTP/1.1 226 IM Used\r\n"},
+	{299, "HTTP/1.1 299 Miscellaneous Persistent Warning\r\n"},
+	{300, "HTTP/1.1 300 Multiple Choices\r\n"},
+	{301, "HTTP/1.1 301 Moved Permanently\r\n"},
+	{302, "HTTP/1.1 302 Found\r\n"},
+	{303, "HTTP/1.1 303 See Other\r\n"},
+	{304, "HTTP/1.1 304 Not Modified\r\n"},
+	{305, "HTTP/1.1 305 Use Proxy\r\n"},
+	{306, "HTTP/1.1 306 Switch Proxy\r\n"},
+	{307, "HTTP/1.1 307 Temporary Redirect\r\n"},
+	{308, "HTTP/1.1 308 Permanent Redirect\r\n"},
+	{400, "HTTP/1.1 400 Bad Request\r\n"},
+	{401, "HTTP/1.1 401 Unauthorized\r\n"},
+	{402, "HTTP/1.1 402 Payment Required\r\n"},
+	{403, "HTTP/1.1 403 Forbidden\r\n"},
+	{404, "HTTP/1.1 404 Not Found\r\n"},
+	{405, "HTTP/1.1 405 Method Not Allowed\r\n"},
+	{406, "HTTP/1.1 406 Not Acceptable\r\n"},
+	{407, "HTTP/1.1 407 Proxy Authentication Required\r\n"},
+	{408, "HTTP/1.1 408 Request Timeout\r\n"},
+	{409, "HTTP/1.1 409 Conflict\r\n"},
+	{410, "HTTP/1.1 410 Gone\r\n"},
+	{411, "HTTP/1.1 411 Length Required\r\n"},
+	{412, "HTTP/1.1 412 Precondition Failed\r\n"},
+	{413, "HTTP/1.1 413 Payload Too Large\r\n"},
+	{414, "HTTP/1.1 414 URI Too Long\r\n"},
+	{415, "HTTP/1.1 415 Unsupported Media Type\r\n"},
+	{416, "HTTP/1.1 416 Range Not Satisfiable\r\n"},
+	{417, "HTTP/1.1 417 Expectation Failed\r\n"},
+	{418, "HTTP/1.1 418 I'm a teapot\r\n"},
+	{419, "HTTP/1.1 419 Page Expired\r\n"},
+	{420, "HTTP/1.1 420 Method Failure\r\n"},
+	{421, "HTTP/1.1 421 Misdirected Request\r\n"},
+	{422, "HTTP/1.1 422 Unprocessable Entity\r\n"},
+	{423, "HTTP/1.1 423 Locked\r\n"},
+	{424, "HTTP/1.1 424 Failed Dependency\r\n"},
+	{425, "HTTP/1.1 425 Too Early\r\n"},
+	{426, "HTTP/1.1 426 Upgrade Required\r\n"},
+	{428, "HTTP/1.1 428 Precondition Required\r\n"},
+	{429, "HTTP/1.1 429 Too Many Requests\r\n"},
+	{430, "HTTP/1.1 430 Request Header Fields Too Large\r\n"},
+	{431, "HTTP/1.1 431 Request Header Fields Too Large\r\n"},
+	{440, "HTTP/1.1 440 Login Time-out\r\n"},
+	{444, "HTTP/1.1 444 No Response\r\n"},
+	{449, "HTTP/1.1 449 Retry With\r\n"},
+	{450, "HTTP/1.1 450 Blocked by Windows Parental Controls\r\n"},
+	{451, "HTTP/1.1 451 Unavailable For Legal Reasons\r\n"},
+	{494, "HTTP/1.1 494 Request header too large\r\n"},
+	{495, "HTTP/1.1 495 SSL Certificate Error\r\n"},
+	{496, "HTTP/1.1 496 SSL Certificate Required\r\n"},
+	{497, "HTTP/1.1 497 HTTP Request Sent to HTTPS Port\r\n"},
+	{498, "HTTP/1.1 498 Invalid Token\r\n"},
+	{499, "HTTP/1.1 499 Token Required\r\n"},
+	{500, "HTTP/1.1 500 Internal Server Error\r\n"},
+	{501, "HTTP/1.1 501 Not Implemented\r\n"},
+	{502, "HTTP/1.1 502 Bad Gateway\r\n"},
+	{503, "HTTP/1.1 503 Service Unavailable\r\n"},
+	{504, "HTTP/1.1 504 Gateway Timeout\r\n"},
+	{505, "HTTP/1.1 505 HTTP Version Not Supported\r\n"},
+	{506, "HTTP/1.1 506 Variant Also Negotiates\r\n"},
+	{507, "HTTP/1.1 507 Insufficient Storage\r\n"},
+	{508, "HTTP/1.1 508 Loop Detected\r\n"},
+	{509, "HTTP/1.1 509 Bandwidth Limit Exceeded\r\n"},
+	{510, "HTTP/1.1 510 Not Extended\r\n"},
+	{511, "HTTP/1.1 511 Network Authentication Required\r\n"},
+	{520, "HTTP/1.1 520 Web Server Returned an Unknown Error\r\n"},
+	{521, "HTTP/1.1 521 Web Server Is Down\r\n"},
+	{522, "HTTP/1.1 522 Connection Timed Out\r\n"},
+	{523, "HTTP/1.1 523 Origin Is Unreachable\r\n"},
+	{524, "HTTP/1.1 524 A Timeout Occurred\r\n"},
+	{525, "HTTP/1.1 525 SSL Handshake Failed\r\n"},
+	{526, "HTTP/1.1 526 Invalid SSL Certificate\r\n"},
+	{527, "HTTP/1.1 527 Railgun Error\r\n"},
+	{529, "HTTP/1.1 529 Site is overloaded\r\n"},
+	{530, "HTTP/1.1 530 Site is frozen\r\n"},
+	{561, "HTTP/1.1 561 Unauthorized\r\n"},
+	{599, "HTTP/1.1 599 Network Connect Timeout Error\r\n"},
+};
+
+constexpr std::array<std::string_view, 600> statusLineTable = [] {
+	std::array<std::string_view, 600> table = {};
+	for (const auto &[code, line] : statusLines)
+		table[code] = line;
+	return table;
+}();
+
+// eg. "HTTP/1.1 200 OK\r\n", empty if the code is unknown
+constexpr std::string_view statusLine(int code) {
+	return (code >= 0 && code < static_cast<int>(statusLineTable.size())) ? statusLineTable[code] : std::string_view();
+}
+
+// eg. "200 OK", empty if the code is unknown
+constexpr std::string_view statusToString(int code) {
+	const std::string_view line = statusLine(code);
+	constexpr size_t prefix = std::string_view("HTTP/1.1 ").length(), suffix = std::string_view("\r\n").length();
+	return line.empty() ? line : line.substr(prefix, line.length() - prefix - suffix);
+}
+
+} // namespace http
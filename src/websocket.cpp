@@ -0,0 +1,411 @@
+#include "websocket.hpp"
+
+#include <cstring>
+
+// OS-SPECIFIC INCLUDES TODO: CHANGE WHEN IMPLEMENTING CROSS-PLATFORM SUPPORT
+#include <sys/socket.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "exception.hpp"
+#include "io.hpp"
+
+using namespace std::string_literals;
+
+namespace http {
+
+static std::string sha1(std::string_view input) {
+	uint32_t h[5] = {0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0};
+
+	std::string data(input);
+	const uint64_t bitLength = static_cast<uint64_t>(input.length()) * 8;
+	data += '\x80';
+	while (data.length() % 64 != 56)
+		data += '\0';
+	for (int shift = 56; shift >= 0; shift -= 8)
+		data += static_cast<char>(bitLength >> shift);
+
+	const auto rotl = [](uint32_t value, int bits) {
+		return (value << bits) | (value >> (32 - bits));
+	};
+
+	for (size_t chunk = 0; chunk < data.length(); chunk += 64) {
+		uint32_t w[80];
+		for (int i = 0; i < 16; i++) {
+			const auto *bytes = reinterpret_cast<const unsigned char *>(data.data() + chunk + i * 4);
+			w[i] = (bytes[0] << 24) | (bytes[1] << 16) | (bytes[2] << 8) | bytes[3];
+		}
+		for (int i = 16; i < 80; i++)
+			w[i] = rotl(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+
+		uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+
+		for (int i = 0; i < 80; i++) {
+			uint32_t f, k;
+			if (i < 20) {
+				f = (b & c) | (~b & d);
+				k = 0x5A827999;
+			} else if (i < 40) {
+				f = b ^ c ^ d;
+				k = 0x6ED9EBA1;
+			} else if (i < 60) {
+				f = (b & c) | (b & d) | (c & d);
+				k = 0x8F1BBCDC;
+			} else {
+				f = b ^ c ^ d;
+				k = 0xCA62C1D6;
+			}
+
+			const uint32_t temp = rotl(a, 5) + f + e + k + w[i];
+			e = d;
+			d = c;
+			c = rotl(b, 30);
+			b = a;
+			a = temp;
+		}
+
+		h[0] += a;
+		h[1] += b;
+		h[2] += c;
+		h[3] += d;
+		h[4] += e;
+	}
+
+	std::string digest;
+	for (const uint32_t word : h) {
+		for (int shift = 24; shift >= 0; shift -= 8)
+			digest += static_cast<char>(word >> shift);
+	}
+	return digest;
+}
+
+static std::string base64Encode(std::string_view input) {
+	static constexpr char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+	std::string output;
+	size_t i = 0;
+
+	for (; i + 2 < input.length(); i += 3) {
+		const uint32_t triple = (static_cast<unsigned char>(input[i]) << 16) |
+								(static_cast<unsigned char>(input[i + 1]) << 8) | static_cast<unsigned char>(input[i + 2]);
+		output += alphabet[(triple >> 18) & 63];
+		output += alphabet[(triple >> 12) & 63];
+		output += alphabet[(triple >> 6) & 63];
+		output += alphabet[triple & 63];
+	}
+
+	if (i + 1 == input.length()) {
+		const uint32_t triple = static_cast<unsigned char>(input[i]) << 16;
+		output += alphabet[(triple >> 18) & 63];
+		output += alphabet[(triple >> 12) & 63];
+		output += "==";
+	} else if (i + 2 == input.length()) {
+		const uint32_t triple = (static_cast<unsigned char>(input[i]) << 16) | (static_cast<unsigned char>(input[i + 1]) << 8);
+		output += alphabet[(triple >> 18) & 63];
+		output += alphabet[(triple >> 12) & 63];
+		output += alphabet[(triple >> 6) & 63];
+		output += '=';
+	}
+
+	return output;
+}
+
+// XORs data with the 4-byte masking key, 16 bytes at a time where SSE2 is available, 8 bytes at a time otherwise.
+// key holds the key bytes in the order they appear on the wire.
+static void unmask(char *data, size_t length, const unsigned char key[4]) {
+	size_t i = 0;
+
+	uint32_t key32;
+	std::memcpy(&key32, key, 4);
+	const uint64_t key64 = (static_cast<uint64_t>(key32) << 32) | key32; // byte order is irrelevant, both halves match
+
+#if defined(__SSE2__)
+	const __m128i key128 = _mm_set1_epi32(static_cast<int>(key32));
+	for (; i + 16 <= length; i += 16) {
+		__m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(data + i), _mm_xor_si128(block, key128));
+	}
+#endif
+
+	for (; i + 8 <= length; i += 8) {
+		uint64_t block;
+		std::memcpy(&block, data + i, 8);
+		block ^= key64;
+		std::memcpy(data + i, &block, 8);
+	}
+
+	for (; i < length; i++) // i is a multiple of 4 when entering, so the key stays aligned with the offset
+		data[i] ^= key[i % 4];
+}
+
+static bool containsToken(std::string_view list, std::string_view token) {
+	size_t start = 0;
+	while (start <= list.length()) {
+		size_t end = list.find(',', start);
+		if (end == std::string_view::npos)
+			end = list.length();
+
+		std::string_view item = list.substr(start, end - start);
+		while (!item.empty() && (item.front() == ' ' || item.front() == '\t'))
+			item.remove_prefix(1);
+		while (!item.empty() && (item.back() == ' ' || item.back() == '\t'))
+			item.remove_suffix(1);
+
+		if (equalsIgnoreCase(item, token))
+			return true;
+
+		start = end + 1;
+	}
+	return false;
+}
+
+bool websocket::isUpgrade(const request &req) {
+	return req.method == method::GET && containsToken(req.getHeader(header::UPGRADE), "websocket") &&
+		   containsToken(req.getHeader(header::CONNECTION), "upgrade");
+}
+
+websocket::websocket(request &req) : _clientfd(req.response()._clientfd) {
+	if (!isUpgrade(req) || _clientfd < 0)
+		throw exception(400, "Not a WebSocket upgrade request");
+
+	if (!req.isOffloaded())
+		throw exception(503, "WebSocket upgrades are only accepted by offloaded handlers");
+
+	if (req.getHeader("Sec-WebSocket-Version") != "13")
+		throw exception(426, "Only WebSocket version 13 is supported");
+
+	const std::string_view key = req.getHeader("Sec-WebSocket-Key");
+	if (key.empty())
+		throw exception(400, "Missing Sec-WebSocket-Key");
+
+	const std::string accept = base64Encode(sha1(std::string(key) + "258EAFA5-E914-47DA-95CA-C5AB0DC85B11"s));
+
+	const std::string handshake = "HTTP/1.1 101 Switching Protocols\r\n"
+								  "Upgrade: websocket\r\n"
+								  "Connection: Upgrade\r\n"
+								  "Sec-WebSocket-Accept: "s +
+								  accept + "\r\n\r\n"s;
+
+	req.response()._status = 101;
+	req.response()._sent = true; // the connection belongs to the websocket now
+	req.response()._streamed = true;
+	if (!writeAll(_clientfd, handshake))
+		_closed = true;
+}
+
+websocket::~websocket() {
+	if (!_closeSent)
+		close(1001); // going away
+}
+
+bool websocket::fill(size_t length) {
+	// a frame may always be pending, the consumed ones are dropped regardless
+	if (_inputPos == _input.length()) {
+		_input.clear();
+		_inputPos = 0;
+	} else if (_inputPos > 65536) {
+		_input.erase(0, _inputPos);
+		_inputPos = 0;
+	}
+
+	while (_input.length() - _inputPos < length) {
+		char buffer[16384];
+		const ssize_t bytesread = recv(_clientfd, buffer, sizeof(buffer), 0);
+		if (bytesread <= 0)
+			return false;
+		_input.append(buffer, bytesread);
+	}
+
+	return true;
+}
+
+bool websocket::receive(message &message) {
+	bool inMessage = false;
+	message.data.clear();
+
+	while (!_closed) {
+		if (!fill(2)) {
+			_closed = true;
+			break;
+		}
+
+		const unsigned char first = _input[_inputPos], second = _input[_inputPos + 1];
+		const bool fin = first & 0x80;
+		const opcode type = static_cast<opcode>(first & 0x0f);
+		const bool masked = second & 0x80;
+		uint64_t length = second & 0x7f;
+
+		size_t headerLength = 2;
+		if (length == 126) {
+			headerLength += 2;
+		} else if (length == 127) {
+			headerLength += 8;
+		}
+		headerLength += 4; // masking key
+
+		if ((first & 0x70) || !masked) { // no extensions were negotiated, and clients must mask
+			fail(1002);
+			break;
+		}
+
+		if (!fill(headerLength)) {
+			_closed = true;
+			break;
+		}
+
+		const auto *header = reinterpret_cast<const unsigned char *>(_input.data() + _inputPos);
+		if (length == 126) {
+			length = (header[2] << 8) | header[3];
+		} else if (length == 127) {
+			if (header[2] & 0x80) { // the most significant bit must be 0
+				fail(1002);
+				break;
+			}
+			length = 0;
+			for (int i = 2; i < 10; i++)
+				length = (length << 8) | header[i];
+		}
+
+		const bool control = static_cast<uint8_t>(type) & 0x8;
+		if (control && (!fin || length > 125)) {
+			fail(1002);
+			break;
+		}
+
+		if (length > _maxMessageSize - message.data.length()) { // cannot overflow, unlike the sum
+			fail(1009); // message too big
+			break;
+		}
+
+		if (!fill(headerLength + length)) {
+			_closed = true;
+			break;
+		}
+
+		unsigned char key[4];
+		std::memcpy(key, _input.data() + _inputPos + headerLength - 4, 4);
+
+		char *payload = _input.data() + _inputPos + headerLength;
+		unmask(payload, length, key);
+		_inputPos += headerLength + length;
+
+		switch (type) {
+			case opcode::PING:
+				sendFrame(opcode::PONG, true, std::string_view(payload, length));
+				break;
+			case opcode::PONG:
+				break;
+			case opcode::CLOSE: {
+				uint16_t code = 1000;
+				if (length >= 2)
+					code = (static_cast<unsigned char>(payload[0]) << 8) | static_cast<unsigned char>(payload[1]);
+				if (!_closeSent)
+					close(code);
+				_closed = true;
+				break;
+			}
+			case opcode::TEXT:
+			case opcode::BINARY:
+				if (inMessage) {
+					fail(1002);
+					break;
+				}
+				message.type = type;
+				message.data.append(payload, length);
+				if (fin)
+					return true;
+				inMessage = true;
+				break;
+			case opcode::CONTINUATION:
+				if (!inMessage) {
+					fail(1002);
+					break;
+				}
+				message.data.append(payload, length);
+				if (fin)
+					return true;
+				break;
+			default:
+				fail(1002);
+				break;
+		}
+	}
+
+	return false;
+}
+
+bool websocket::send(std::string_view data, opcode type) {
+	if (_closeSent)
+		return false;
+
+	size_t offset = 0;
+	do {
+		const size_t length = std::min(_maxFrameSize, data.length() - offset);
+		const bool fin = offset + length == data.length();
+
+		if (!sendFrame(offset == 0 ? type : opcode::CONTINUATION, fin, data.substr(offset, length)))
+			return false;
+
+		offset += length;
+	} while (offset < data.length());
+
+	return true;
+}
+
+void websocket::close(uint16_t code, std::string_view reason) {
+	if (_closeSent)
+		return;
+
+	std::string payload;
+	payload += static_cast<char>(code >> 8);
+	payload += static_cast<char>(code);
+	payload += reason.substr(0, 123);
+
+	sendFrame(opcode::CLOSE, true, payload);
+	_closeSent = true;
+}
+
+void websocket::setMaxMessageSize(size_t size) {
+	_maxMessageSize = size;
+}
+
+void websocket::setMaxFrameSize(size_t size) {
+	_maxFrameSize = size > 0 ? size : 1;
+}
+
+bool websocket::sendFrame(opcode type, bool fin, std::string_view payload) {
+	unsigned char header[10];
+	size_t headerLength = 2;
+
+	header[0] = (fin ? 0x80 : 0x00) | static_cast<uint8_t>(type);
+	if (payload.length() < 126) {
+		header[1] = payload.length();
+	} else if (payload.length() <= 0xffff) {
+		header[1] = 126;
+		header[2] = payload.length() >> 8;
+		header[3] = payload.length();
+		headerLength = 4;
+	} else {
+		header[1] = 127;
+		for (int i = 0; i < 8; i++)
+			header[2 + i] = static_cast<uint64_t>(payload.length()) >> (56 - 8 * i);
+		headerLength = 10;
+	}
+
+	iovec iov[2] = {{header, headerLength}, {const_cast<char *>(payload.data()), payload.length()}};
+	if (!writeAll(_clientfd, iov, 2)) {
+		_closed = true;
+		_closeSent = true; // nothing can be sent anymore
+		return false;
+	}
+	return true;
+}
+
+void websocket::fail(uint16_t code) {
+	close(code);
+	_closed = true;
+}
+
+} // namespace http
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "request.hpp"
+
+namespace http {
+
+// WebSocket (RFC 6455) on an upgraded HTTP/1.1 request. The handler keeps the connection, and its thread, for as long
+// as it keeps receiving. The thread accepting connections would accept no other one meanwhile, so upgrades are only
+// accepted by handlers offloaded to a handler pool, each open websocket holding one of its threads:
+//
+//	server.setHandlerPool(pool, [](const http::request &req) {
+//		return http::websocket::isUpgrade(req);
+//	});
+//
+//	if (http::websocket::isUpgrade(req)) {
+//		http::websocket ws(req);
+//		http::websocket::message message;
+//		while (ws.receive(message))
+//			ws.send(message.data, message.type);
+//		return true;
+//	}
+class websocket {
+  public:
+	enum class opcode : uint8_t {
+		CONTINUATION = 0x0,
+		TEXT = 0x1,
+		BINARY = 0x2,
+		CLOSE = 0x8,
+		PING = 0x9,
+		PONG = 0xA,
+	}; // opcode
+
+	struct message {
+		opcode type; // TEXT or BINARY
+		std::string data;
+	};
+
+	static bool isUpgrade(const request &req);
+
+	// Answers the request with 101 Switching Protocols, throws http::exception if it is not a WebSocket upgrade, or
+	// exception(503) if the handler is not offloaded (see request::isOffloaded)
+	explicit websocket(request &req);
+	~websocket();
+
+	// Blocks until a whole (possibly fragmented) message arrived; pings are answered meanwhile.
+	// Returns false once the connection is closed.
+	bool receive(message &message);
+
+	// Messages longer than the maximum frame size are sent fragmented
+	bool send(std::string_view data, opcode type = opcode::TEXT);
+
+	void close(uint16_t code = 1000, std::string_view reason = {});
+
+	void setMaxMessageSize(size_t size); // larger incoming messages close the connection with 1009, default 16MiB
+	void setMaxFrameSize(size_t size);	 // of outgoing frames, default 64KiB
+
+  private:
+	bool fill(size_t length);
+	bool sendFrame(opcode type, bool fin, std::string_view payload);
+	void fail(uint16_t code);
+
+	const int _clientfd;
+
+	std::string _input;
+	size_t _inputPos = 0;
+
+	size_t _maxMessageSize = 16 << 20;
+	size_t _maxFrameSize = 64 << 10;
+
+	bool _closeSent = false;
+	bool _closed = false;
+}; // websocket
+
+} // namespace http
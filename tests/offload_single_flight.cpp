@@ -0,0 +1,102 @@
+// Two identical concurrent requests to an offloaded route must both be answered: with the request coalescing of
+// single_flight, the second one used to wait on the listening thread for the first, which only the same thread could
+// complete, hanging the server
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>
+
+// OS-SPECIFIC INCLUDES TODO: CHANGE WHEN IMPLEMENTING CROSS-PLATFORM SUPPORT
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "http.hpp"
+
+using namespace std::string_literals;
+
+static uint16_t freePort() {
+	const int sockfd = socket(AF_INET, SOCK_STREAM, 0);
+	sockaddr_in addr = {};
+	addr.sin_family = AF_INET;
+	addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	socklen_t size = sizeof(addr);
+	bind(sockfd, (sockaddr *)&addr, sizeof(addr));
+	getsockname(sockfd, (sockaddr *)&addr, &size);
+	close(sockfd);
+	return ntohs(addr.sin_port);
+}
+
+// The response, empty if none arrived within 5 seconds
+static std::string get(uint16_t port, const char *path) {
+	const int sockfd = socket(AF_INET, SOCK_STREAM, 0);
+	const timeval timeout = {5, 0};
+	setsockopt(sockfd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+	sockaddr_in addr = {};
+	addr.sin_family = AF_INET;
+	addr.sin_port = htons(port);
+	addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+	std::string response;
+	if (connect(sockfd, (sockaddr *)&addr, sizeof(addr)) == 0) {
+		const std::string request = "GET "s + path + " HTTP/1.1\r\nHost: localhost\r\n\r\n";
+		if (write(sockfd, request.data(), request.length()) == static_cast<ssize_t>(request.length())) {
+			char buffer[4096];
+			ssize_t got;
+			while ((got = read(sockfd, buffer, sizeof(buffer))) > 0)
+				response.append(buffer, got);
+		}
+	}
+	close(sockfd);
+	return response;
+}
+
+int main() {
+	http::handler_pool pool(2);
+	http::single_flight singleFlight;
+
+	http::server server(
+		[](http::request &req) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(300));
+			req.response().setContentString("slow");
+			return req.response().send();
+		},
+		[](http::request &req, int code, const std::string &error) {
+			req.response().setStatus(code);
+			req.response().setContentString(error);
+			return req.response().send();
+		});
+	server.setHandlerPool(pool, [](const http::request &req) {
+		return req.url.pathname == "/slow";
+	});
+	server.setSingleFlight(singleFlight);
+
+	const uint16_t port = freePort();
+	std::thread([&server, port] {
+		server.listen(
+			http::host::local, port,
+			[] {
+			},
+			[](const std::string &error) {
+				std::fprintf(stderr, "Failed to listen: %s\n", error.c_str());
+				std::_Exit(1);
+			});
+	}).detach();
+	std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+	std::string first, second;
+	std::thread client([&first, port] { first = get(port, "/slow"); });
+	std::this_thread::sleep_for(std::chrono::milliseconds(50)); // the first one leads
+	second = get(port, "/slow");
+	client.join();
+
+	const bool answered =
+		first.find("\r\n\r\nslow") != std::string::npos && second.find("\r\n\r\nslow") != std::string::npos;
+	std::printf("%s\n", answered ? "ok" : "FAILED: an identical concurrent request was not answered");
+	std::fflush(stdout);
+	std::_Exit(answered ? 0 : 1); // the server thread never returns
+}
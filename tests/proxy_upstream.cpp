@@ -0,0 +1,210 @@
+// The proxy against loopback stand-in backends: requests reuse pooled keep-alive connections, X-Forwarded-* headers
+// are rewritten, and an upstream that stops answering is marked unhealthy, its requests going to the others
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// OS-SPECIFIC INCLUDES TODO: CHANGE WHEN IMPLEMENTING CROSS-PLATFORM SUPPORT
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "http.hpp"
+
+using namespace std::string_literals;
+
+static uint16_t freePort() {
+	const int sockfd = socket(AF_INET, SOCK_STREAM, 0);
+	sockaddr_in addr = {};
+	addr.sin_family = AF_INET;
+	addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	socklen_t size = sizeof(addr);
+	bind(sockfd, (sockaddr *)&addr, sizeof(addr));
+	getsockname(sockfd, (sockaddr *)&addr, &size);
+	close(sockfd);
+	return ntohs(addr.sin_port);
+}
+
+// Answers every request with keep-alive, echoing the X-Forwarded-* headers it received. Health checks are not counted.
+class backend {
+  public:
+	explicit backend(uint16_t port) {
+		_sockfd = socket(AF_INET, SOCK_STREAM, 0);
+		const int one = 1;
+		setsockopt(_sockfd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+		sockaddr_in addr = {};
+		addr.sin_family = AF_INET;
+		addr.sin_port = htons(port);
+		addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+		if (bind(_sockfd, (sockaddr *)&addr, sizeof(addr)) < 0 || ::listen(_sockfd, 16) < 0) {
+			std::perror("Failed to start a backend");
+			std::_Exit(1);
+		}
+
+		std::thread([this] {
+			int clientfd;
+			while ((clientfd = accept(_sockfd, nullptr, nullptr)) >= 0) {
+				std::lock_guard lock(_mutex);
+				_clients.push_back(clientfd);
+				std::thread(&backend::serve, this, clientfd).detach();
+			}
+		}).detach();
+	}
+
+	// Stops accepting and drops the open connections, like a crashed upstream
+	void stop() {
+		shutdown(_sockfd, SHUT_RDWR);
+		std::lock_guard lock(_mutex);
+		for (const int clientfd : _clients)
+			shutdown(clientfd, SHUT_RDWR);
+	}
+
+	std::atomic<int> requests{0};
+	std::atomic<int> connections{0}; // that carried requests
+
+  private:
+	void serve(int clientfd) {
+		std::string input;
+		bool counted = false;
+		char buffer[4096];
+		ssize_t got;
+
+		while ((got = read(clientfd, buffer, sizeof(buffer))) > 0) {
+			input.append(buffer, got);
+
+			size_t headEnd;
+			while ((headEnd = input.find("\r\n\r\n")) != std::string::npos) {
+				const std::string head = input.substr(0, headEnd + 2);
+				input.erase(0, headEnd + 4);
+
+				std::string body;
+				if (head.compare(0, 12, "GET /health ") != 0) {
+					requests++;
+					if (!counted)
+						connections++;
+					counted = true;
+
+					for (size_t pos = head.find("\r\n") + 2; pos < head.length(); pos = head.find("\r\n", pos) + 2) {
+						const std::string line = head.substr(pos, head.find("\r\n", pos) - pos);
+						if (line.compare(0, 12, "X-Forwarded-") == 0)
+							body += line + "\n";
+					}
+				}
+
+				const std::string response =
+					"HTTP/1.1 200 OK\r\nContent-Length: "s + std::to_string(body.length()) + "\r\n\r\n"s + body;
+				if (write(clientfd, response.data(), response.length()) != static_cast<ssize_t>(response.length()))
+					break;
+			}
+		}
+		close(clientfd);
+	}
+
+	int _sockfd;
+	std::mutex _mutex;
+	std::vector<int> _clients;
+}; // backend
+
+// The response, empty if none arrived within 5 seconds
+static std::string get(uint16_t port, const std::string &path, const std::string &headers = {}) {
+	const int sockfd = socket(AF_INET, SOCK_STREAM, 0);
+	const timeval timeout = {5, 0};
+	setsockopt(sockfd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+	sockaddr_in addr = {};
+	addr.sin_family = AF_INET;
+	addr.sin_port = htons(port);
+	addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+	std::string response;
+	if (connect(sockfd, (sockaddr *)&addr, sizeof(addr)) == 0) {
+		const std::string request = "GET "s + path + " HTTP/1.1\r\n"s + headers + "\r\n"s;
+		if (write(sockfd, request.data(), request.length()) == static_cast<ssize_t>(request.length())) {
+			char buffer[4096];
+			ssize_t got;
+			while ((got = read(sockfd, buffer, sizeof(buffer))) > 0)
+				response.append(buffer, got);
+		}
+	}
+	close(sockfd);
+	return response;
+}
+
+static bool check(bool passed, const char *what) {
+	if (!passed)
+		std::printf("FAILED: %s\n", what);
+	return passed;
+}
+
+int main() {
+	const uint16_t livePort = freePort(), flakyPort = freePort(), port = freePort();
+	backend live(livePort);
+	auto flaky = std::make_unique<backend>(flakyPort);
+
+	http::proxy backends;
+	backends.addUpstream("127.0.0.1", livePort);
+	backends.addUpstream("127.0.0.1", flakyPort);
+	backends.setHealthCheck("/health", 60); // only the first check runs during the test
+
+	http::server server(
+		[&backends](http::request &req) {
+			return backends.handle(req);
+		},
+		[](http::request &req, int code, const std::string &error) {
+			req.response().setStatus(code);
+			req.response().setContentString(error);
+			return req.response().send();
+		});
+
+	std::thread([&server, port] {
+		server.listen(
+			http::host::local, port,
+			[] {
+			},
+			[](const std::string &error) {
+				std::fprintf(stderr, "Failed to listen: %s\n", error.c_str());
+				std::_Exit(1);
+			});
+	}).detach();
+	std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+	bool passed = true;
+
+	// round robin: two requests for each upstream, over one connection each
+	for (int i = 0; i < 4; i++)
+		passed &= check(get(port, "/item", "Host: localhost\r\n").find("200 OK") != std::string::npos,
+						"a proxied request was not answered");
+	passed &= check(live.requests == 2 && flaky->requests == 2, "the requests were not balanced");
+	passed &= check(live.connections == 1 && flaky->connections == 1, "keep-alive connections were not reused");
+
+	// the client's X-Forwarded-For is extended with its address, Host and the protocol are forwarded
+	const std::string forwarded = get(port, "/item", "Host: example.test\r\nX-Forwarded-For: 203.0.113.7\r\n");
+	passed &= check(forwarded.find("X-Forwarded-For: 203.0.113.7, 127.0.0.1\n") != std::string::npos &&
+						forwarded.find("X-Forwarded-Host: example.test\n") != std::string::npos &&
+						forwarded.find("X-Forwarded-Proto: http\n") != std::string::npos,
+					"the X-Forwarded-* headers were not rewritten");
+
+	// once it failed a request, the flaky upstream gets no more of them, even after it came back
+	flaky->stop();
+	for (int i = 0; i < 2; i++)
+		passed &= check(get(port, "/item", "Host: localhost\r\n").find("200 OK") != std::string::npos,
+						"a request was not retried on the healthy upstream");
+	flaky = std::make_unique<backend>(flakyPort);
+	const int before = live.requests;
+	for (int i = 0; i < 4; i++)
+		get(port, "/item", "Host: localhost\r\n");
+	passed &= check(flaky->requests == 0 && live.requests == before + 4, "the dead upstream was not marked unhealthy");
+
+	if (passed)
+		std::printf("ok\n");
+	std::fflush(stdout);
+	std::_Exit(passed ? 0 : 1); // the server and backend threads never return
+}
@@ -0,0 +1,116 @@
+// A 64-bit frame length with its most significant bit set must close the connection with 1002: added to the length of
+// the message received so far, such a length used to wrap around the size check, and the frame was unmasked far past
+// the end of the input
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>
+
+// OS-SPECIFIC INCLUDES TODO: CHANGE WHEN IMPLEMENTING CROSS-PLATFORM SUPPORT
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "http.hpp"
+
+using namespace std::string_literals;
+
+static uint16_t freePort() {
+	const int sockfd = socket(AF_INET, SOCK_STREAM, 0);
+	sockaddr_in addr = {};
+	addr.sin_family = AF_INET;
+	addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	socklen_t size = sizeof(addr);
+	bind(sockfd, (sockaddr *)&addr, sizeof(addr));
+	getsockname(sockfd, (sockaddr *)&addr, &size);
+	close(sockfd);
+	return ntohs(addr.sin_port);
+}
+
+// Sends request, then once a response head arrived, frames (if any), and returns what arrives until the server
+// closes, empty if nothing arrived within 5 seconds
+static std::string roundTrip(uint16_t port, const std::string &request, std::string frames = {}) {
+	const int sockfd = socket(AF_INET, SOCK_STREAM, 0);
+	const timeval timeout = {5, 0};
+	setsockopt(sockfd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+	sockaddr_in addr = {};
+	addr.sin_family = AF_INET;
+	addr.sin_port = htons(port);
+	addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+	std::string response;
+	if (connect(sockfd, (sockaddr *)&addr, sizeof(addr)) == 0 &&
+		write(sockfd, request.data(), request.length()) == static_cast<ssize_t>(request.length())) {
+		char buffer[4096];
+		ssize_t got;
+		while ((got = read(sockfd, buffer, sizeof(buffer))) > 0) {
+			response.append(buffer, got);
+			if (!frames.empty() && response.find("\r\n\r\n") != std::string::npos) {
+				if (write(sockfd, frames.data(), frames.length()) != static_cast<ssize_t>(frames.length()))
+					break;
+				frames.clear();
+			}
+		}
+	}
+	close(sockfd);
+	return response;
+}
+
+int main() {
+	http::handler_pool pool(2);
+
+	http::server server(
+		[](http::request &req) {
+			if (!http::websocket::isUpgrade(req)) {
+				req.response().setContentString("alive");
+				return req.response().send();
+			}
+
+			http::websocket ws(req);
+			http::websocket::message message;
+			while (ws.receive(message))
+				ws.send(message.data, message.type);
+			return true;
+		},
+		[](http::request &req, int code, const std::string &error) {
+			req.response().setStatus(code);
+			req.response().setContentString(error);
+			return req.response().send();
+		});
+	server.setHandlerPool(pool, [](const http::request &req) {
+		return http::websocket::isUpgrade(req);
+	});
+
+	const uint16_t port = freePort();
+	std::thread([&server, port] {
+		server.listen(
+			http::host::local, port,
+			[] {
+			},
+			[](const std::string &error) {
+				std::fprintf(stderr, "Failed to listen: %s\n", error.c_str());
+				std::_Exit(1);
+			});
+	}).detach();
+	std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+	const std::string handshake = "GET /ws HTTP/1.1\r\nHost: localhost\r\nConnection: Upgrade\r\nUpgrade: websocket\r\n"
+								  "Sec-WebSocket-Version: 13\r\nSec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\n\r\n";
+	// a masked, unfinished 5 byte text frame, then a continuation announcing 2^64 - 3 bytes
+	const std::string fragment = "\x01\x85\0\0\0\0hello"s;
+	const std::string continuation = "\x80\xff\xff\xff\xff\xff\xff\xff\xff\xfd\0\0\0\0abc"s;
+
+	const std::string response = roundTrip(port, handshake, fragment + continuation);
+	const bool rejected = response.find("101 Switching Protocols") != std::string::npos &&
+						  response.find("\x88\x02\x03\xea"s) != std::string::npos; // close, 1002
+	const bool alive = roundTrip(port, "GET / HTTP/1.1\r\nHost: localhost\r\n\r\n").find("alive") != std::string::npos;
+
+	const bool passed = rejected && alive;
+	std::printf("%s\n", passed ? "ok" : "FAILED: an oversized 64-bit frame length was not rejected with 1002");
+	std::fflush(stdout);
+	std::_Exit(passed ? 0 : 1); // the server thread never returns
+}
@@ -0,0 +1,237 @@
+// Packs static assets into a C++ translation unit defining an http::asset_bundle (see bundle.hpp), with their content
+// types, ETags, gzip variants and serialized heads, so the server never reads them from the filesystem
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <zlib.h>
+
+#include "bundle.hpp"
+#include "response.hpp"
+
+namespace fs = std::filesystem;
+
+struct asset {
+	std::string path; // as requested
+	fs::path file;
+	http::content_type type = http::content_type::APPLICATION_OCTET_STREAM;
+	std::string content, gzip;
+};
+
+static std::string etagOf(std::string_view content, std::string_view suffix) {
+	uint64_t hash = 14695981039346656037ull; // FNV-1a
+	for (const char c : content) {
+		hash ^= static_cast<unsigned char>(c);
+		hash *= 1099511628211ull;
+	}
+
+	char etag[32];
+	std::snprintf(etag, sizeof(etag), "\"%016llx", static_cast<unsigned long long>(hash));
+	return etag + std::string(suffix) + "\"";
+}
+
+// Empty unless it saves at least a tenth
+static std::string compress(const std::string &content) {
+	z_stream stream = {};
+	if (deflateInit2(&stream, Z_BEST_COMPRESSION, Z_DEFLATED, 15 + 16, 9, Z_DEFAULT_STRATEGY) != Z_OK) // gzip wrapper
+		return {};
+
+	std::string gzip(deflateBound(&stream, content.length()), '\0');
+	stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(content.data()));
+	stream.avail_in = static_cast<uInt>(content.length());
+	stream.next_out = reinterpret_cast<Bytef *>(gzip.data());
+	stream.avail_out = static_cast<uInt>(gzip.length());
+
+	const bool done = deflate(&stream, Z_FINISH) == Z_STREAM_END;
+	gzip.resize(stream.total_out);
+	deflateEnd(&stream);
+
+	return done && gzip.length() <= content.length() - content.length() / 10 ? gzip : std::string();
+}
+
+// As a string literal, split over lines; octal escapes never take more than three digits, unlike hex ones
+static void writeLiteral(std::ostream &out, std::string_view bytes) {
+	out << (bytes.length() > 64 ? "\n\t\"" : "\"");
+	size_t column = 0;
+	for (const char c : bytes) {
+		if (column >= 100) {
+			out << "\"\n\t\"";
+			column = 0;
+		}
+
+		const unsigned char byte = static_cast<unsigned char>(c);
+		if (byte >= 0x20 && byte < 0x7f && c != '"' && c != '\\' && c != '?') {
+			out << c;
+			column++;
+		} else {
+			char escaped[8];
+			std::snprintf(escaped, sizeof(escaped), "\\%03o", byte);
+			out << escaped;
+			column += 4;
+		}
+	}
+	out << "\"";
+}
+
+static void writeView(std::ostream &out, std::string_view bytes) {
+	if (bytes.empty()) {
+		out << "{}";
+		return;
+	}
+	out << "{";
+	writeLiteral(out, bytes);
+	out << ", " << bytes.length() << "}";
+}
+
+static void usage(const char *program, FILE *out) {
+	std::fprintf(out,
+				 "Usage: %s --name NAME [--prefix /PATH] [-o FILE] PATH...\n"
+				 "  --name NAME      the http::asset_bundle to define\n"
+				 "  --prefix /PATH   requested under /PATH (default /)\n"
+				 "  -o FILE          write the translation unit to FILE instead of stdout\n"
+				 "A file is requested by its name, the files of a directory by their path within it.\n",
+				 program);
+}
+
+int main(int argc, char const *argv[]) {
+	std::string name;
+	std::string prefix = "/";
+	const char *output = nullptr;
+	std::vector<fs::path> inputs;
+
+	for (int i = 1; i < argc; i++) {
+		const std::string_view arg = argv[i];
+		const bool hasValue = i + 1 < argc;
+
+		if (arg == "--name" && hasValue) {
+			name = argv[++i];
+		} else if (arg == "--prefix" && hasValue) {
+			prefix = argv[++i];
+			if (prefix.empty() || prefix.back() != '/')
+				prefix += '/';
+		} else if (arg == "-o" && hasValue) {
+			output = argv[++i];
+		} else if (arg == "-h" || arg == "--help") {
+			usage(argv[0], stdout);
+			return 0;
+		} else if (arg.substr(0, 1) == "-") {
+			usage(argv[0], stderr);
+			return 2;
+		} else {
+			inputs.push_back(argv[i]);
+		}
+	}
+
+	if (name.empty() || inputs.empty() || prefix.front() != '/') {
+		usage(argv[0], stderr);
+		return 2;
+	}
+
+	std::cout.rdbuf(std::cerr.rdbuf()); // what http::getContentType logs, stdout may be the translation unit
+
+	std::vector<asset> assets;
+	const auto add = [&assets](std::string path, const fs::path &file) {
+		asset &added = assets.emplace_back();
+		added.path = std::move(path);
+		added.file = file;
+	};
+
+	for (const fs::path &input : inputs) {
+		std::error_code error;
+		if (fs::is_directory(input, error)) {
+			for (const auto &entry : fs::recursive_directory_iterator(input, error)) {
+				if (entry.is_regular_file())
+					add(prefix + entry.path().lexically_relative(input).generic_string(), entry.path());
+			}
+		} else if (fs::is_regular_file(input, error)) {
+			add(prefix + input.filename().string(), input);
+		} else {
+			std::fprintf(stderr, "%s: not a file or directory\n", input.c_str());
+			return 1;
+		}
+		if (error) {
+			std::fprintf(stderr, "%s: %s\n", input.c_str(), error.message().c_str());
+			return 1;
+		}
+	}
+
+	if (assets.empty()) {
+		std::fprintf(stderr, "Nothing to bundle\n");
+		return 1;
+	}
+
+	std::sort(assets.begin(), assets.end(), [](const asset &a, const asset &b) { return a.path < b.path; });
+	for (size_t i = 1; i < assets.size(); i++) {
+		if (assets[i].path == assets[i - 1].path) {
+			std::fprintf(stderr, "%s: bundled twice\n", assets[i].path.c_str());
+			return 1;
+		}
+	}
+
+	for (asset &asset : assets) {
+		std::ifstream file(asset.file, std::ios::binary);
+		asset.content.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+		if (file.bad()) {
+			std::fprintf(stderr, "%s: %s\n", asset.file.c_str(), std::strerror(errno));
+			return 1;
+		}
+
+		asset.type = http::getContentType(asset.file);
+		asset.gzip = compress(asset.content);
+	}
+
+	std::ostringstream out;
+	out << "// Generated by http-bundle, do not edit\n\n#include <iterator>\n\n#include \"bundle.hpp\"\n\nnamespace {\n\n"
+		<< "constexpr http::bundled_asset bundledAssets[] = {\n";
+
+	for (const asset &asset : assets) {
+		const bool varies = !asset.gzip.empty();
+		const std::string etag = etagOf(asset.content, "");
+		const std::string gzipEtag = varies ? etagOf(asset.content, "-gzip") : std::string();
+
+		out << "\t{";
+		writeLiteral(out, asset.path);
+		out << ",\n\tstatic_cast<http::content_type>(" << static_cast<int>(asset.type) << "), // "
+			<< http::contentTypeToString(asset.type) << "\n\t";
+		writeView(out, etag);
+		out << ", ";
+		writeView(out, asset.content);
+		out << ", ";
+		writeView(out, http::asset_bundle::serializeFields(asset.type, etag, asset.content, false, varies));
+		out << ",\n\t";
+		writeView(out, gzipEtag);
+		out << ", ";
+		writeView(out, asset.gzip);
+		out << ", ";
+		writeView(out,
+				  varies ? http::asset_bundle::serializeFields(asset.type, gzipEtag, asset.gzip, true, true) : "");
+		out << "},\n";
+	}
+
+	out << "};\n\n} // namespace\n\n"
+		<< "extern const http::asset_bundle " << name << ";\n"
+		<< "const http::asset_bundle " << name << "(bundledAssets, std::size(bundledAssets));\n";
+
+	if (!output) {
+		std::fwrite(out.str().data(), 1, out.str().length(), stdout);
+		return 0;
+	}
+
+	std::ofstream file(output, std::ios::binary | std::ios::trunc);
+	file << out.str();
+	if (!file) {
+		std::fprintf(stderr, "%s: %s\n", output, std::strerror(errno));
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,280 @@
+// Renders binary access logs (see http::access_log) as text or as JSON lines
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// OS-SPECIFIC INCLUDES TODO: CHANGE WHEN IMPLEMENTING CROSS-PLATFORM SUPPORT
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "access_log.hpp"
+
+using http::access_log;
+
+static std::string formatTime(uint64_t nanoseconds) {
+	const std::time_t seconds = nanoseconds / 1000000000;
+	std::tm tm;
+	gmtime_r(&seconds, &tm);
+
+	char buffer[64];
+	const size_t length = std::strftime(buffer, sizeof(buffer), "%Y-%m-%dT%H:%M:%S", &tm);
+	std::snprintf(buffer + length, sizeof(buffer) - length, ".%09luZ",
+				  static_cast<unsigned long>(nanoseconds % 1000000000));
+	return buffer;
+}
+
+static void writeJsonString(std::string &out, std::string_view string) {
+	out += '"';
+	for (const char c : string) {
+		switch (c) {
+		case '"':
+			out += "\\\"";
+			break;
+		case '\\':
+			out += "\\\\";
+			break;
+		case '\n':
+			out += "\\n";
+			break;
+		case '\r':
+			out += "\\r";
+			break;
+		case '\t':
+			out += "\\t";
+			break;
+		default:
+			if (static_cast<unsigned char>(c) < 0x20) {
+				char escaped[8];
+				std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+				out += escaped;
+			} else {
+				out += c;
+			}
+		}
+	}
+	out += '"';
+}
+
+struct decoder {
+	bool json = false;
+
+	uint64_t pid = 0;
+	std::vector<std::string_view> strings; // of the current block, by id
+
+	std::string_view string(uint32_t id) const {
+		return id < strings.size() ? strings[id] : std::string_view();
+	}
+
+	void text(const access_log::request_slot &request, const access_log::usage_slot *usage, std::string &out) const {
+		const auto field = [this](uint32_t id) {
+			const std::string_view value = string(id);
+			return value.empty() ? std::string_view("_") : value;
+		};
+
+		out += formatTime(request.start);
+		out += " [" + std::to_string(pid) + "] ";
+		out.append(field(request.client)).append("/").append(field(request.country)).append(" ");
+		out.append(field(request.method)).append(" ");
+		out.append(field(request.host)).append(" ");
+		out.append(field(request.target)).append(" ");
+		if (request.error != 0) {
+			out.append(string(request.error));
+		} else {
+			out += std::to_string(request.status) + " " + std::to_string(request.responseBytes) + "B";
+		}
+		out += " " + std::to_string(request.requestBytes) + "B ";
+		out += std::to_string(request.duration / 1000) + "us \"";
+		out.append(field(request.userAgent)).append("\"");
+		if (usage) {
+			out += " alloc=" + std::to_string(usage->allocations) + "/" + std::to_string(usage->allocatedBytes) + "B";
+			out += " recv=" + std::to_string(usage->recvCalls) + "/" + std::to_string(usage->recvBytes) + "B";
+			out += " write=" + std::to_string(usage->writeCalls) + "/" + std::to_string(usage->writeBytes) + "B";
+			out += " copied=" + std::to_string(usage->copiedBytes) + "B";
+		}
+		out += '\n';
+	}
+
+	void jsonLine(const access_log::request_slot &request, const access_log::usage_slot *usage, std::string &out) const {
+		const auto member = [&](const char *name, uint32_t id) {
+			out += ",\"";
+			out += name;
+			out += "\":";
+			if (id == 0) {
+				out += "null";
+			} else {
+				writeJsonString(out, string(id));
+			}
+		};
+
+		out += "{\"time\":\"" + formatTime(request.start) + "\"";
+		out += ",\"start_ns\":" + std::to_string(request.start);
+		out += ",\"duration_ns\":" + std::to_string(request.duration);
+		out += ",\"pid\":" + std::to_string(pid);
+		member("method", request.method);
+		member("host", request.host);
+		member("target", request.target);
+		out += ",\"status\":" + (request.status == 0 ? std::string("null") : std::to_string(request.status));
+		out += ",\"request_bytes\":" + std::to_string(request.requestBytes);
+		out += ",\"response_bytes\":" + std::to_string(request.responseBytes);
+		member("client", request.client);
+		member("country", request.country);
+		member("user_agent", request.userAgent);
+		member("error", request.error);
+		if (usage) {
+			out += ",\"allocations\":" + std::to_string(usage->allocations);
+			out += ",\"allocated_bytes\":" + std::to_string(usage->allocatedBytes);
+			out += ",\"recv_calls\":" + std::to_string(usage->recvCalls);
+			out += ",\"recv_bytes\":" + std::to_string(usage->recvBytes);
+			out += ",\"write_calls\":" + std::to_string(usage->writeCalls);
+			out += ",\"write_bytes\":" + std::to_string(usage->writeBytes);
+			out += ",\"copied_bytes\":" + std::to_string(usage->copiedBytes);
+		}
+		out += "}\n";
+	}
+
+	// A request is rendered once the next slot shows whether its usage follows
+	std::optional<access_log::request_slot> pending;
+
+	void render(const access_log::usage_slot *usage, std::string &out) {
+		if (!pending)
+			return;
+		json ? jsonLine(*pending, usage, out) : text(*pending, usage, out);
+		pending.reset();
+	}
+
+	// Returns false if the log is corrupt or truncated
+	bool decode(std::string_view data, const char *name) {
+		std::string out;
+
+		size_t offset = 0;
+		while (offset + access_log::slotSize <= data.length()) {
+			const char *slot = data.data() + offset;
+
+			if (static_cast<access_log::slot_type>(slot[0]) != access_log::slot_type::USAGE)
+				render(nullptr, out); // before a block redefines the strings it refers to
+
+			switch (static_cast<access_log::slot_type>(slot[0])) {
+			case access_log::slot_type::BLOCK: {
+				access_log::block_slot block;
+				std::memcpy(&block, slot, sizeof(block));
+				if (std::memcmp(block.magic, access_log::magic, sizeof(access_log::magic)) != 0) {
+					std::fprintf(stderr, "%s: not an access log at offset %zu\n", name, offset);
+					return false;
+				}
+
+				pid = block.pid;
+				strings.assign(1, std::string_view());
+				offset += access_log::slotSize;
+				break;
+			}
+			case access_log::slot_type::STRING: {
+				access_log::string_slot definition;
+				std::memcpy(&definition, slot, offsetof(access_log::string_slot, data));
+
+				const size_t slots = access_log::stringSlots(definition.length);
+				if (offset + slots * access_log::slotSize > data.length()) {
+					std::fprintf(stderr, "%s: truncated at offset %zu\n", name, offset);
+					return false;
+				}
+
+				if (definition.id >= strings.size())
+					strings.resize(definition.id + 1);
+				strings[definition.id] = data.substr(offset + offsetof(access_log::string_slot, data), definition.length);
+				offset += slots * access_log::slotSize;
+				break;
+			}
+			case access_log::slot_type::REQUEST: {
+				pending.emplace();
+				std::memcpy(&*pending, slot, sizeof(access_log::request_slot));
+				offset += access_log::slotSize;
+				break;
+			}
+			case access_log::slot_type::USAGE: {
+				access_log::usage_slot usage;
+				std::memcpy(&usage, slot, sizeof(usage));
+				render(&usage, out);
+				offset += access_log::slotSize;
+				break;
+			}
+			default:
+				std::fprintf(stderr, "%s: unknown slot type %d at offset %zu\n", name, slot[0], offset);
+				return false;
+			}
+
+			if (out.length() >= 64 * 1024) {
+				std::fwrite(out.data(), 1, out.length(), stdout);
+				out.clear();
+			}
+		}
+		render(nullptr, out);
+		std::fwrite(out.data(), 1, out.length(), stdout);
+
+		if (offset != data.length()) {
+			std::fprintf(stderr, "%s: truncated at offset %zu\n", name, offset);
+			return false;
+		}
+		return true;
+	}
+}; // decoder
+
+int main(int argc, char const *argv[]) {
+	decoder decoder;
+	std::vector<const char *> files;
+
+	for (int i = 1; i < argc; i++) {
+		const std::string_view arg = argv[i];
+		if (arg == "--json") {
+			decoder.json = true;
+		} else if (arg == "-h" || arg == "--help") {
+			std::printf("Usage: %s [--json] FILE...\n", argv[0]);
+			return 0;
+		} else {
+			files.push_back(argv[i]);
+		}
+	}
+
+	if (files.empty()) {
+		std::fprintf(stderr, "Usage: %s [--json] FILE...\n", argv[0]);
+		return 2;
+	}
+
+	bool ok = true;
+	for (const char *file : files) {
+		const int fd = open(file, O_RDONLY | O_CLOEXEC);
+		struct stat status;
+		if (fd < 0 || fstat(fd, &status) < 0) {
+			std::fprintf(stderr, "%s: %s\n", file, std::strerror(errno));
+			ok = false;
+			if (fd >= 0)
+				close(fd);
+			continue;
+		}
+
+		if (status.st_size == 0) {
+			close(fd);
+			continue;
+		}
+
+		void *mapped = mmap(nullptr, status.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		close(fd);
+		if (mapped == MAP_FAILED) {
+			std::fprintf(stderr, "%s: %s\n", file, std::strerror(errno));
+			ok = false;
+			continue;
+		}
+
+		ok = decoder.decode(std::string_view(static_cast<const char *>(mapped), status.st_size), file) && ok;
+		munmap(mapped, status.st_size);
+	}
+
+	return ok ? 0 : 1;
+}
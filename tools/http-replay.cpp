@@ -0,0 +1,335 @@
+// Replays a traffic capture (see http::traffic_capture) against a server and reports latencies per endpoint: the
+// durations the server measured when the traffic was captured, next to the latencies the replay measures as a client.
+// These include connecting and reading the whole response, so they are not comparable with each other, only with the
+// client latencies of other replays.
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+// OS-SPECIFIC INCLUDES TODO: CHANGE WHEN IMPLEMENTING CROSS-PLATFORM SUPPORT
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "capture.hpp"
+
+using http::traffic_capture;
+
+struct captured_request {
+	uint64_t arrival;  // nanoseconds since the epoch
+	uint64_t duration; // nanoseconds, as originally answered
+	int status;
+	std::string_view bytes; // into the mapped capture
+	std::string endpoint;	// method and path, without the query
+};
+
+struct replayed_request {
+	uint64_t latency = 0; // nanoseconds from connecting until the server closed the connection
+	uint64_t lag = 0;	  // nanoseconds the request was sent behind schedule
+	int status = 0;		  // 0 if the request failed
+	size_t responseBytes = 0;
+};
+
+static std::string endpointOf(std::string_view request) {
+	std::string_view line = request.substr(0, request.find("\r\n"));
+
+	const size_t methodEnd = line.find(' ');
+	if (methodEnd == std::string_view::npos)
+		return "_";
+	std::string_view target = line.substr(methodEnd + 1);
+	target = target.substr(0, target.find(' '));
+	target = target.substr(0, target.find('?'));
+
+	return std::string(line.substr(0, methodEnd)) + " " + std::string(target);
+}
+
+// Returns false if the capture is corrupt, the requests are appended to requests
+static bool load(const char *file, std::vector<captured_request> &requests, size_t &truncated) {
+	const int fd = open(file, O_RDONLY | O_CLOEXEC);
+	struct stat status;
+	if (fd < 0 || fstat(fd, &status) < 0) {
+		std::fprintf(stderr, "%s: %s\n", file, std::strerror(errno));
+		if (fd >= 0)
+			close(fd);
+		return false;
+	}
+
+	if (status.st_size == 0) {
+		close(fd);
+		return true;
+	}
+
+	// never unmapped, the requests view into it until the end
+	void *mapped = mmap(nullptr, status.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (mapped == MAP_FAILED) {
+		std::fprintf(stderr, "%s: %s\n", file, std::strerror(errno));
+		return false;
+	}
+
+	const std::string_view data(static_cast<const char *>(mapped), status.st_size);
+	const std::string_view magic(traffic_capture::magic, sizeof(traffic_capture::magic));
+	if (data.substr(0, magic.length()) != magic) {
+		std::fprintf(stderr, "%s: not a traffic capture\n", file);
+		return false;
+	}
+
+	size_t offset = 0;
+	while (offset < data.length()) {
+		if (data.substr(offset, magic.length()) == magic) { // processes that created the file at the same time
+			offset += magic.length();
+			continue;
+		}
+
+		traffic_capture::record_header header;
+		if (offset + sizeof(header) > data.length()) {
+			std::fprintf(stderr, "%s: truncated at offset %zu\n", file, offset);
+			return false;
+		}
+		std::memcpy(&header, data.data() + offset, sizeof(header));
+		offset += sizeof(header);
+
+		if (offset + header.length > data.length()) {
+			std::fprintf(stderr, "%s: truncated at offset %zu\n", file, offset);
+			return false;
+		}
+		const std::string_view bytes = data.substr(offset, header.length);
+		offset += header.length;
+
+		if (header.flags & traffic_capture::TRUNCATED) { // the server would wait for the rest of the body
+			truncated++;
+			continue;
+		}
+
+		requests.push_back({header.arrival, header.duration, header.status, bytes, endpointOf(bytes)});
+	}
+
+	return true;
+}
+
+static replayed_request replay(const captured_request &request, const addrinfo &server) {
+	replayed_request result;
+	const auto start = std::chrono::steady_clock::now();
+
+	const int fd = socket(server.ai_family, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	if (fd < 0)
+		return result;
+
+	int one = 1;
+	setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+	bool ok = connect(fd, server.ai_addr, server.ai_addrlen) == 0;
+
+	for (size_t sent = 0; ok && sent < request.bytes.length();) {
+		const ssize_t n = send(fd, request.bytes.data() + sent, request.bytes.length() - sent, MSG_NOSIGNAL);
+		if (n <= 0) {
+			ok = false;
+			break;
+		}
+		sent += n;
+	}
+
+	// the server closes the connection once it has answered
+	char buffer[16 * 1024];
+	std::string statusLine;
+	while (ok) {
+		const ssize_t n = recv(fd, buffer, sizeof(buffer), 0);
+		if (n < 0)
+			ok = false;
+		if (n <= 0)
+			break;
+
+		if (statusLine.length() < 12)
+			statusLine.append(buffer, std::min<size_t>(n, 12 - statusLine.length()));
+		result.responseBytes += n;
+	}
+	close(fd);
+
+	result.latency = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start)
+						 .count();
+
+	// "HTTP/1.1 200"
+	if (ok && statusLine.length() == 12 && statusLine.compare(0, 5, "HTTP/") == 0)
+		result.status = std::atoi(statusLine.c_str() + 9);
+	return result;
+}
+
+static double percentile(std::vector<uint64_t> values, double p) {
+	if (values.empty())
+		return 0;
+	const size_t index = std::min(values.size() - 1, static_cast<size_t>(p * values.size()));
+	std::nth_element(values.begin(), values.begin() + index, values.end());
+	return values[index] / 1e6; // milliseconds
+}
+
+static void usage(const char *program, FILE *out) {
+	std::fprintf(out,
+				 "Usage: %s [--speed N|max] [--connections N] [--host HOST] [--port PORT] FILE...\n"
+				 "  --speed N        replay N times as fast as captured (default 1), max sends without pauses\n"
+				 "  --connections N  requests in flight at most (default 16)\n"
+				 "  --host, --port   the server to replay against (default 127.0.0.1:8080)\n",
+				 program);
+}
+
+int main(int argc, char const *argv[]) {
+	double speed = 1; // 0 for as fast as possible
+	size_t connections = 16;
+	std::string host = "127.0.0.1";
+	std::string port = "8080";
+	std::vector<const char *> files;
+
+	for (int i = 1; i < argc; i++) {
+		const std::string_view arg = argv[i];
+		const bool hasValue = i + 1 < argc;
+
+		if (arg == "--speed" && hasValue) {
+			const std::string_view value = argv[++i];
+			speed = value == "max" ? 0 : std::atof(argv[i]);
+			if (value != "max" && speed <= 0) {
+				usage(argv[0], stderr);
+				return 2;
+			}
+		} else if (arg == "--connections" && hasValue) {
+			connections = std::max(1, std::atoi(argv[++i]));
+		} else if (arg == "--host" && hasValue) {
+			host = argv[++i];
+		} else if (arg == "--port" && hasValue) {
+			port = argv[++i];
+		} else if (arg == "-h" || arg == "--help") {
+			usage(argv[0], stdout);
+			return 0;
+		} else if (arg.substr(0, 2) == "--") {
+			usage(argv[0], stderr);
+			return 2;
+		} else {
+			files.push_back(argv[i]);
+		}
+	}
+
+	if (files.empty()) {
+		usage(argv[0], stderr);
+		return 2;
+	}
+
+	std::vector<captured_request> requests;
+	size_t truncated = 0;
+	for (const char *file : files) {
+		if (!load(file, requests, truncated))
+			return 1;
+	}
+
+	if (requests.empty()) {
+		std::fprintf(stderr, "Nothing to replay\n");
+		return 1;
+	}
+
+	std::stable_sort(requests.begin(), requests.end(),
+					 [](const captured_request &a, const captured_request &b) { return a.arrival < b.arrival; });
+
+	addrinfo hints = {};
+	hints.ai_family = AF_UNSPEC;
+	hints.ai_socktype = SOCK_STREAM;
+	addrinfo *server;
+	if (const int status = getaddrinfo(host.c_str(), port.c_str(), &hints, &server); status != 0) {
+		std::fprintf(stderr, "%s: %s\n", host.c_str(), gai_strerror(status));
+		return 1;
+	}
+
+	std::printf("Replaying %zu requests (%zu with truncated bodies skipped) against %s:%s at %s, %zu connections\n",
+				requests.size(), truncated, host.c_str(), port.c_str(),
+				speed == 0 ? "max speed" : (std::to_string(speed) + "x").c_str(), connections);
+
+	std::vector<replayed_request> results(requests.size());
+	std::atomic<size_t> next = 0;
+
+	const auto start = std::chrono::steady_clock::now();
+	const uint64_t firstArrival = requests.front().arrival;
+
+	std::vector<std::thread> workers;
+	for (size_t i = 0; i < std::min(connections, requests.size()); i++) {
+		workers.emplace_back([&] {
+			for (size_t index; (index = next.fetch_add(1)) < requests.size();) {
+				const captured_request &request = requests[index];
+
+				uint64_t lag = 0;
+				if (speed > 0) {
+					const auto due = start + std::chrono::nanoseconds(
+												 static_cast<uint64_t>((request.arrival - firstArrival) / speed));
+					const auto now = std::chrono::steady_clock::now();
+					if (now < due) {
+						std::this_thread::sleep_until(due);
+					} else {
+						lag = std::chrono::duration_cast<std::chrono::nanoseconds>(now - due).count();
+					}
+				}
+
+				results[index] = replay(request, *server);
+				results[index].lag = lag;
+			}
+		});
+	}
+	for (std::thread &worker : workers)
+		worker.join();
+
+	const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	freeaddrinfo(server);
+
+	struct endpoint_stats {
+		std::vector<uint64_t> original, replayed;
+		size_t failed = 0, statusChanged = 0;
+	};
+	std::map<std::string, endpoint_stats> endpoints;
+
+	uint64_t maxLag = 0;
+	for (size_t i = 0; i < requests.size(); i++) {
+		endpoint_stats &stats = endpoints[requests[i].endpoint];
+		stats.original.push_back(requests[i].duration);
+		if (results[i].status == 0) {
+			stats.failed++;
+			continue;
+		}
+		stats.replayed.push_back(results[i].latency);
+		if (results[i].status != requests[i].status)
+			stats.statusChanged++;
+		maxLag = std::max(maxLag, results[i].lag);
+	}
+
+	std::vector<std::pair<std::string, endpoint_stats *>> sorted;
+	for (auto &[endpoint, stats] : endpoints)
+		sorted.emplace_back(endpoint, &stats);
+	std::stable_sort(sorted.begin(), sorted.end(),
+					 [](const auto &a, const auto &b) { return a.second->original.size() > b.second->original.size(); });
+
+	// the captured durations are measured by the server, the replayed latencies by the client, including connecting:
+	// they are not comparable, hence no difference
+	std::printf("\n%-40s %7s %14s %14s %14s %14s %7s %7s\n", "endpoint", "count", "server p50 ms", "server p99 ms",
+				"client p50 ms", "client p99 ms", "failed", "changed");
+	for (const auto &[endpoint, stats] : sorted) {
+		std::printf("%-40.40s %7zu %14.3f %14.3f %14.3f %14.3f %7zu %7zu\n", endpoint.c_str(), stats->original.size(),
+					percentile(stats->original, 0.5), percentile(stats->original, 0.99),
+					percentile(stats->replayed, 0.5), percentile(stats->replayed, 0.99), stats->failed,
+					stats->statusChanged);
+	}
+	std::printf("\nserver: as captured, measured by the server; client: as replayed, from connecting to the last byte\n");
+
+	const double captured = (requests.back().arrival - firstArrival) / 1e9;
+	std::printf("\nCaptured over %.3fs (%.1f req/s), replayed in %.3fs (%.1f req/s), at most %.3fms behind schedule\n",
+				captured, captured > 0 ? requests.size() / captured : 0.0, elapsed, requests.size() / elapsed,
+				maxLag / 1e6);
+
+	return 0;
+}